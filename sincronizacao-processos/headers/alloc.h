@@ -0,0 +1,87 @@
+#ifndef ALLOC_H
+#define ALLOC_H
+
+#include <stdint.h>
+#include "disk.h"
+#include "extent.h"
+
+#define BUDDY_MAX_ORDER 16 // Maior bloco do buddy: 2^16 blocos
+
+// Políticas de alocação de blocos
+typedef enum {
+    ALLOC_FIRST_FIT = 0,  // Primeiro trecho livre a partir do início
+    ALLOC_NEXT_FIT,       // Primeiro trecho livre a partir da última alocação
+    ALLOC_BEST_FIT,       // Menor trecho livre que comporta o pedido
+    ALLOC_BUDDY,          // Blocos em potências de 2 (buddy system)
+    ALLOC_POLICY_COUNT
+} AllocPolicy;
+
+typedef struct Allocator Allocator;
+
+// Operações de uma política
+typedef struct {
+    const char *name;
+    void (*init)(Allocator *a);
+    // Escolhe count blocos consecutivos livres (não marca no bitmap)
+    uint32_t (*find)(Allocator *a, uint32_t count);
+    // Avisa que o bloco mudou de estado no bitmap
+    void (*update)(Allocator *a, uint32_t block_num, int used);
+    void (*destroy)(Allocator *a);
+} AllocOps;
+
+// Estado do buddy system: listas livres por ordem, encadeadas por índice de bloco
+typedef struct {
+    uint32_t heads[BUDDY_MAX_ORDER + 1];
+    uint32_t *next;
+    uint32_t *prev;
+    uint8_t *order;      // ordem + 1 se o bloco inicia um trecho livre, 0 caso contrário
+} BuddyState;
+
+struct Allocator {
+    Disk *disk;
+    AllocPolicy policy;
+    const AllocOps *ops;
+    uint8_t *bitmap;       // Cópia em memória do bitmap de blocos
+    uint32_t first;        // Primeiro bloco de dados
+    uint32_t last;         // Fim do disco (exclusivo)
+    uint32_t cursor;       // Posição do next-fit
+    ExtentTree extents;    // Trechos livres, sincronizados com o bitmap
+    BuddyState buddy;
+};
+
+// Associa um alocador com a política dada ao disco (lê o bitmap uma vez)
+int alloc_attach(Disk *disk, AllocPolicy policy);
+// Remove o alocador do disco
+void alloc_detach(Disk *disk);
+
+// Avisa o alocador que um bloco mudou de estado no bitmap (chamado por bitmap_set)
+void alloc_block_changed(Allocator *a, uint32_t block_num, int used);
+
+// Idem para um trecho inteiro que mudou de estado (todos os blocos mudaram)
+void alloc_range_changed(Allocator *a, uint32_t start, uint32_t count, int used);
+
+// Reserva de min a max blocos consecutivos, começando em goal se possível
+// (goal 0 = sem preferência); fora do goal, o trecho é o que a política
+// escolher. Marca os blocos no bitmap e devolve o primeiro; *got recebe
+// quantos foram reservados. (uint32_t)-1 se não houver min seguidos.
+uint32_t alloc_extent(Disk *disk, uint32_t min, uint32_t goal, uint32_t max, uint32_t *got);
+
+// Libera count blocos a partir de start
+void alloc_release_extent(Disk *disk, uint32_t start, uint32_t count);
+
+// Nome da política / política a partir do nome (-1 se desconhecida)
+const char *alloc_policy_name(AllocPolicy policy);
+int alloc_policy_from_name(const char *name);
+
+// Trechos livres no bitmap e o maior deles (medida de fragmentação)
+void alloc_free_extents(Disk *disk, uint32_t *count, uint32_t *largest);
+
+// Reproduz um trace de criação/remoção em cada política e mostra latência
+// de alocação e fragmentação resultante
+int alloc_benchmark(uint32_t block_size, uint32_t ops, unsigned int seed);
+
+// Formata discos esparsos cada vez maiores (16MB até max_size) e mostra que
+// o custo de alocar blocos/i-nodes e de buscar um i-node não cresce com o disco
+int alloc_scale_benchmark(uint32_t block_size, uint64_t max_size, uint32_t ops, unsigned int seed);
+
+#endif
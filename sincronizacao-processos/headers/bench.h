@@ -0,0 +1,8 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+// Executa os benchmarks com as opções de linha de comando (-f csv|json, -o arquivo,
+// -n operacoes, -b tamanho_bloco, -s semente). Retorna o código de saída
+int bench_main(int argc, char **argv);
+
+#endif
@@ -9,10 +9,22 @@ void bitmap_init(Disk *disk, Superblock *sb);
 // Marca um bloco como usado (1) ou livre (0)
 void bitmap_set(Disk *disk, uint32_t block_num, int used);
 
+// Marca count blocos consecutivos a partir de start (uma escrita no bitmap)
+void bitmap_set_range(Disk *disk, uint32_t start, uint32_t count, int used);
+
 // Verifica se um bloco está livre (0) ou usado (1)
 int bitmap_get(Disk *disk, uint32_t block_num);
 
 // Encontra e retorna o número do primeiro bloco livre
 uint32_t bitmap_find_free_block(Disk *disk);
 
+// Encontra count blocos livres consecutivos e retorna o primeiro
+uint32_t bitmap_find_free_run(Disk *disk, uint32_t count);
+
+// Marca um i-node como usado (1) ou livre (0) no bitmap de i-nodes
+void inode_bitmap_set(Disk *disk, uint32_t inode_num, int used);
+
+// Verifica se um i-node está livre (0) ou usado (1)
+int inode_bitmap_get(Disk *disk, uint32_t inode_num);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,11 @@
+#ifndef CLI_H
+#define CLI_H
+
+#define CLI_DEFAULT_IMAGE "fs.img"        // Imagem de mkfs, mount e fsck
+#define CLI_SCRIPT_IMAGE "fs_script.bin"  // Imagem criada por run (a mesma do modo script)
+
+// Interpreta a linha de comando: fs_simulator mkfs|mount|run|bench|fsck [opções].
+// Retorna o código de saída do processo
+int cli_main(int argc, char **argv);
+
+#endif
@@ -0,0 +1,52 @@
+#ifndef COMMAND_H
+#define COMMAND_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include "disk.h"
+#include "workload.h"
+
+#define CMD_MAX_ARGS 8        // Nome do comando + até 7 argumentos
+#define CMD_MAX_LINE 1024
+
+// Quanto cada linha executada escreve na saída padrão
+typedef enum {
+    CMD_OUTPUT_NORMAL,  // Eco "[EXECUTANDO] linha" e mensagens de cada comando
+    CMD_OUTPUT_QUIET,   // Sem eco; mensagens e relatórios dos comandos
+    CMD_OUTPUT_BATCH,   // Saída dos comandos descartada; falhas vão para stderr com o número da linha
+    CMD_OUTPUT_COUNT
+} CmdOutput;
+
+// Estado de uma sessão de comandos (modo script, mount ou interativo)
+typedef struct {
+    Disk *disk;
+    uint32_t cwd;               // Diretório atual (cd)
+    WorkloadConfig workload;    // Parâmetros do comando workload
+    CmdOutput output;
+    int saved_stdout;           // stdout original enquanto CMD_OUTPUT_BATCH estiver ativo (-1 se não)
+    uint64_t lines;             // Linhas lidas (inclui vazias e comentários)
+    uint64_t commands;          // Comandos executados
+    uint64_t errors;            // Comandos que falharam, desconhecidos ou com sintaxe errada
+    uint64_t start_ns;
+} CmdSession;
+
+// Inicia uma sessão no root do disco
+void command_session_init(CmdSession *s, Disk *disk, CmdOutput output);
+// Termina a sessão: restaura a saída padrão e encerra um trace em andamento
+void command_session_end(CmdSession *s);
+// Troca o modo de saída da sessão
+void command_set_output(CmdSession *s, CmdOutput output);
+
+// Executa uma linha (modificada no lugar). Retorna 0, -1 se o comando falhar
+// ou 1 se a linha for vazia ou comentário
+int command_exec_line(CmdSession *s, char *line);
+// Executa todas as linhas de um arquivo já aberto
+void command_exec_file(CmdSession *s, FILE *in);
+
+const char *command_output_name(CmdOutput output);
+// Retorna o modo pelo nome ou -1
+int command_output_from_name(const char *name);
+// Exibe linhas, comandos, falhas e vazão da sessão
+void command_print_report(const CmdSession *s);
+
+#endif
@@ -0,0 +1,33 @@
+#ifndef DEFRAG_H
+#define DEFRAG_H
+
+#include <stdint.h>
+#include "disk.h"
+#include "inode.h"
+
+// Resultado de uma desfragmentação
+typedef struct {
+    uint32_t inodes_scanned;     // I-nodes (arquivos e diretórios) analisados
+    uint32_t fragmented_before;  // Com mais de um trecho contíguo antes
+    uint32_t fragmented_after;   // Com mais de um trecho contíguo depois
+    uint32_t relocated;          // I-nodes movidos para um trecho contíguo
+    uint32_t dirs_compacted;     // Diretórios com entradas removidas compactadas
+    uint32_t blocks_freed;       // Blocos de diretório liberados pela compactação
+} DefragReport;
+
+// Número de trechos contíguos (runs) no mapa de blocos do i-node
+uint32_t defrag_count_runs(Inode *inode);
+
+// Move os blocos do i-node para um trecho contíguo livre (0 = movido ou já
+// contíguo, -1 = sem espaço contíguo)
+int defrag_relocate(Disk *disk, uint32_t inode_num);
+
+// Remove as entradas apagadas de um diretório e libera os blocos que sobrarem.
+// Retorna o número de entradas removidas (-1 em caso de erro)
+int defrag_compact_dir(Disk *disk, uint32_t dir_inode_num, uint32_t *blocks_freed);
+
+// Compacta os diretórios e realoca os max_files i-nodes mais fragmentados
+// (0 = todos)
+int defrag_run(Disk *disk, uint32_t max_files, DefragReport *report);
+
+#endif
@@ -3,17 +3,71 @@
 
 #include <stdint.h>  // Para uint32_t
 #include "disk.h"    // Para Disk
+#include "inode.h"   // Para Inode
 
 #define MAX_NAME_LEN 28   // 28 caracteres + terminador \0
 #define DIR_ENTRY_SIZE 32 // Tamanho fixo (4 bytes inode + 28 bytes nome)
 #define MAX_BLOCKS_PER_INODE 10
 
+// Consultas de file_seek (equivalentes a SEEK_DATA/SEEK_HOLE do lseek)
+#define FILE_SEEK_DATA 0 // Próximo byte que pertence a um bloco com dados
+#define FILE_SEEK_HOLE 1 // Próximo byte dentro de um buraco (ou o fim do arquivo)
+
 // Estrutura que representa uma entrada de diretório
 typedef struct {
     uint32_t inode_num;   // Número do i-node associado
     char name[MAX_NAME_LEN]; // Nome do arquivo/diretório
 } DirEntry;
 
+// Uso de espaço contado por uma entrada no diretório pai
+typedef struct {
+    int64_t bytes;
+    int64_t blocks;
+    int64_t files;
+} DirUsage;
+
+#define DIR_ITER_PLUS 1 // Carrega também os i-nodes das entradas (readdir "plus")
+
+// Iterador de entradas de diretório. Os blocos do diretório são lidos inteiros,
+// em lote, e as entradas removidas (nome vazio) são puladas
+typedef struct {
+    Disk *disk;
+    Inode *dir;                // Referência ao i-node do diretório
+    uint32_t dir_num;          // Número do i-node do diretório
+    uint32_t num_entries;      // Entradas cobertas pelo tamanho do diretório
+    uint32_t next;             // Próxima posição a examinar
+    uint32_t pos;              // Posição da última entrada devolvida
+    uint32_t bad;              // Entradas em blocos não alocados ou ilegíveis
+    int flags;
+    DirEntry *entries;         // Blocos do diretório, em ordem
+    uint8_t valid[MAX_BLOCKS_PER_INODE]; // Bloco alocado e lido por inteiro
+    uint32_t plus_block;       // Bloco cujos i-nodes estão em inodes
+    Inode *inodes;             // I-nodes das entradas desse bloco (modo plus)
+} DirIter;
+
+// Abre o diretório para iteração (flags: 0 ou DIR_ITER_PLUS).
+// Retorna 0 ou -1 se o i-node não for um diretório
+int dir_iter_open(Disk *disk, uint32_t dir_inode_num, int flags, DirIter *it);
+// Próxima entrada (nome sempre terminado em \0) ou NULL no fim. No modo plus,
+// *inode aponta para uma cópia do i-node da entrada, válida até o próximo bloco
+DirEntry *dir_iter_next(DirIter *it, Inode **inode);
+// Regrava no disco a última entrada devolvida (depois de alterá-la)
+int dir_iter_update(DirIter *it);
+// Libera o iterador
+void dir_iter_close(DirIter *it);
+// Procura no diretório a entrada do i-node child_inode_num e copia o nome.
+// Retorna 0 ou -1 se não existir
+int dir_find_entry(Disk *disk, uint32_t dir_inode_num, uint32_t child_inode_num, char name[MAX_NAME_LEN]);
+// Procura no diretório a entrada com esse nome.
+// Retorna o i-node ou (uint32_t)-1 se não existir
+uint32_t dir_lookup(Disk *disk, uint32_t dir_inode_num, const char *name);
+
+// Uso de um i-node: o próprio arquivo ou, num diretório, a subárvore inteira
+void dir_usage_of(const Inode *inode, DirUsage *usage);
+// Soma (sign 1) ou subtrai (sign -1) usage nos contadores do diretório e de
+// todos os seus ancestrais, até a raiz
+void dir_usage_add(Disk *disk, uint32_t dir_inode_num, const DirUsage *usage, int sign);
+
 // Cria um novo diretório
 int dir_create(Disk *disk, uint32_t parent_inode_num, const char *name);
 
@@ -24,8 +78,32 @@ int dir_add_entry(Disk *disk, uint32_t dir_inode_num, uint32_t child_inode_num,
 
 int file_create(Disk *disk, uint32_t parent_inode_num, const char *host_filename, const char *fs_filename);
 
+// Cria o arquivo fs_filename no diretório com o conteúdo de data (até 10 blocos).
+// Retorna o i-node criado ou (uint32_t)-1 em caso de erro
+uint32_t file_create_data(Disk *disk, uint32_t parent_inode_num, const char *fs_filename,
+                          const uint8_t *data, uint32_t len);
+
 int file_read(Disk *disk, uint32_t inode_num);
 
+// Grava len bytes de data no arquivo a partir de offset (até 10 blocos no
+// total), reservando blocos para os buracos atingidos. O uso acumulado de
+// parent_inode_num é atualizado. Retorna 0 ou -1
+int file_write_data(Disk *disk, uint32_t parent_inode_num, uint32_t inode_num, uint32_t offset,
+                    const uint8_t *data, uint32_t len);
+// Muda o tamanho do arquivo: reduzir libera os blocos após o fim, aumentar
+// cria um buraco. Retorna 0 ou -1
+int file_truncate(Disk *disk, uint32_t parent_inode_num, uint32_t inode_num, uint32_t size);
+
+// Lê o arquivo inteiro em buffer (MAX_BLOCKS_PER_INODE blocos, como os de
+// disk_buf_get), sem exibir nada. Buracos viram zeros.
+// Retorna quantos bytes foram lidos ou -1 se não for um arquivo regular
+int file_read_data(Disk *disk, uint32_t inode_num, uint8_t *buffer);
+
+// Procura, a partir de offset, o próximo trecho de dados ou buraco do arquivo.
+// Retorna a posição encontrada ou (uint32_t)-1 se offset estiver após o fim
+// ou se não houver mais dados (FILE_SEEK_DATA)
+uint32_t file_seek(Disk *disk, uint32_t inode_num, uint32_t offset, int whence);
+
 int dir_list_detailed(Disk *disk, uint32_t inode_num) ;
 
 int dir_list_dirs(Disk *disk, uint32_t inode_num);
@@ -42,8 +120,14 @@ uint32_t dir_find_parent_recursive(Disk *disk, uint32_t current_inode_num, uint3
 
 int dir_remove_entry(Disk *disk, uint32_t dir_inode_num, uint32_t target_inode_num);
 
+// Remove a entrada do arquivo; blocos e i-node só são liberados quando não
+// sobra nenhum link
 int file_delete(Disk *disk, uint32_t parent_inode_num, uint32_t file_inode_num) ;
 
+// Cria no diretório a entrada name para um arquivo existente (hard link): o
+// arquivo passa a ter mais um link e os blocos não são copiados. Retorna 0 ou -1
+int file_link(Disk *disk, uint32_t dir_inode_num, uint32_t inode_num, const char *name);
+
 
 
 
@@ -2,21 +2,54 @@
 #define DISK_H
 
 #include <stdint.h>
+#include <sys/types.h>
 
 #define DISK_SIZE_MIN (1 * 1024 * 1024)   // 1MB mínimo
-#define DISK_SIZE_MAX (100 * 1024 * 1024) // 100MB máximo
+#define DISK_SIZE_MAX (4ULL << 40)        // 4TB máximo (imagem esparsa)
 #define BLOCK_SIZE_DEFAULT 4096           // 4KB por bloco
+#define DISK_SECTOR_SIZE 512              // Alinhamento mínimo de blocos e de E/S direta
+#define DISK_DIRECT_ALIGN 4096            // Alinhamento dos buffers do pool (página)
+#define DISK_BUF_BLOCKS 16                // Blocos por buffer do pool (cabe um arquivo inteiro)
+#define DISK_BUF_POOL_MAX 16              // Buffers livres guardados para reuso
+
+struct Superblock; // Definido em superblock.h
+struct Allocator;  // Definido em alloc.h
+struct DiskIo;     // Definido em diskio.c
+struct DiskBufPool; // Definido em disk.c
+struct ICache;     // Definido em icache.c
+struct Snapshots;  // Definido em snapshot.c
 
 typedef struct {
     char *filename;      // Nome do arquivo que simula o disco
     int fd;             // Descritor do arquivo (Unix)
-    uint32_t size;      // Tamanho total do disco (bytes)
+    uint64_t size;      // Tamanho total do disco (bytes)
     uint32_t block_size;// Tamanho do bloco (bytes)
+    struct Superblock *sb; // Superbloco em memória (layout do disco)
+    struct Allocator *alloc; // Política de alocação de blocos (NULL = varre o bitmap no disco)
+    struct DiskIo *io;  // Motor de E/S em lote (NULL = pread/pwrite síncrono)
+    int direct_fd;      // Descritor com O_DIRECT para dados de arquivo (-1 = desligado)
+    struct DiskBufPool *bufs; // Buffers alinhados reaproveitados
+    struct ICache *icache; // I-nodes em memória (criado no primeiro inode_load)
+    struct Snapshots *snap; // Snapshots em memória (carregados no primeiro uso)
+    int sb_dirty;       // Contadores do superbloco mudaram e ainda não foram gravados
 } Disk;
 
 // Cria/abre um disco virtual
-Disk *disk_create(const char *filename, uint32_t size, uint32_t block_size);
+// (o número de blocos precisa caber em 32 bits)
+Disk *disk_create(const char *filename, uint64_t size, uint32_t block_size);
+// Posição em bytes do início de um bloco (64 bits)
+off_t disk_block_offset(Disk *disk, uint32_t block_num);
+// Zera len bytes a partir de offset liberando o espaço no host (imagem esparsa)
+int disk_zero(Disk *disk, off_t offset, uint64_t len);
+// Liga/desliga o modo direto: os dados de arquivo passam a ir por um segundo
+// descritor aberto com O_DIRECT (sem o cache de páginas do host). Metadados
+// continuam pelo descritor normal. Retorna 0 ou -1 se o host não suportar
+int disk_set_direct(Disk *disk, int enable);
+// Pega um buffer alinhado a DISK_DIRECT_ALIGN com DISK_BUF_BLOCKS blocos
+uint8_t *disk_buf_get(Disk *disk);
+// Devolve um buffer ao pool
+void disk_buf_put(Disk *disk, uint8_t *buffer);
 // Libera o disco da memória
 void disk_free(Disk *disk);
 
-#endif
\ No newline at end of file
+#endif
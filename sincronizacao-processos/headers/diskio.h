@@ -0,0 +1,52 @@
+#ifndef DISKIO_H
+#define DISKIO_H
+
+#include <stdint.h>
+#include <sys/types.h>
+#include "disk.h"
+
+#define DISK_IO_DEPTH_DEFAULT 64 // Pedidos em voo ao mesmo tempo
+#define DISK_IO_POOL_THREADS 4   // Threads do motor de pool
+
+// Motores de E/S do disco
+typedef enum {
+    DISK_IO_SYNC = 0,   // pread/pwrite em sequência
+    DISK_IO_THREADS,    // Pool de threads fazendo pread/pwrite
+    DISK_IO_URING,      // io_uring (cai para o pool se o kernel não suportar)
+    DISK_IO_ENGINE_COUNT
+} DiskIoEngine;
+
+#define DISK_IO_READ 0
+#define DISK_IO_WRITE 1
+
+// Pedido de E/S. result recebe os bytes transferidos ou -errno
+typedef struct {
+    int op;
+    void *buf;
+    uint32_t len;
+    off_t offset;
+    ssize_t result;
+    int direct;     // Vai pelo descritor com O_DIRECT (decidido em disk_io_submit)
+} DiskIoReq;
+
+// Liga o motor de E/S com a profundidade de fila dada (0 = padrão).
+// Retorna o motor efetivamente em uso
+DiskIoEngine disk_io_init(Disk *disk, DiskIoEngine engine, uint32_t depth);
+// Desliga o motor (o disco volta a fazer E/S síncrona)
+void disk_io_shutdown(Disk *disk);
+// Motor em uso
+DiskIoEngine disk_io_engine(Disk *disk);
+
+// Nome do motor / motor a partir do nome (-1 se desconhecido)
+const char *disk_io_engine_name(DiskIoEngine engine);
+int disk_io_engine_from_name(const char *name);
+
+// Enfileira um pedido; nada é executado até disk_io_wait (sem motor, executa na hora).
+// Só a thread que ligou o motor enfileira: nas outras o pedido também é
+// executado na hora. Com o modo direto ligado, pedidos alinhados a setores usam O_DIRECT
+void disk_io_submit(Disk *disk, DiskIoReq *req);
+// Envia os pedidos enfileirados em lote e espera todos terminarem.
+// Retorna quantos falharam (result diferente de len)
+int disk_io_wait(Disk *disk);
+
+#endif
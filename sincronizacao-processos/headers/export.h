@@ -0,0 +1,30 @@
+#ifndef EXPORT_H
+#define EXPORT_H
+
+#include <stdint.h>
+#include "disk.h"
+
+#define EXPORT_THREADS 4 // Threads que copiam arquivos para o host
+
+// Resultado de uma exportação
+typedef struct {
+    uint32_t files;        // Arquivos exportados
+    uint32_t dirs;         // Diretórios criados no host
+    uint32_t failed;       // Arquivos que não puderam ser gravados
+    uint32_t holes;        // Blocos que ficaram como buracos no host
+    uint32_t fallbacks;    // Arquivos copiados com pread/pwrite (sem copy_file_range)
+    uint64_t bytes;        // Bytes de dados copiados
+    int threads;           // Threads usadas
+    double elapsed_ms;     // Tempo total
+} ExportReport;
+
+// Recria no host, dentro de host_dir, a subárvore do diretório dir_inode_num.
+// Os arquivos são copiados por uma fila de trabalho paralela, um trecho
+// contíguo por vez (copy_file_range a partir da imagem), pulando buracos.
+// Retorna 0 ou -1 em caso de erro
+int export_tree(Disk *disk, uint32_t dir_inode_num, const char *host_dir, ExportReport *report);
+
+// Exibe o relatório de uma exportação
+void export_print_report(const ExportReport *report);
+
+#endif
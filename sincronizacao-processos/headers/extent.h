@@ -0,0 +1,53 @@
+#ifndef EXTENT_H
+#define EXTENT_H
+
+#include <stdint.h>
+
+// Nó de árvore AVL representando um trecho livre [start, start + len)
+typedef struct ExtentNode {
+    uint32_t start;
+    uint32_t len;
+    uint32_t max_len;      // Maior len da subárvore (first-fit em O(log n))
+    int height;
+    struct ExtentNode *left;
+    struct ExtentNode *right;
+} ExtentNode;
+
+// Trechos livres indexados duas vezes: por posição (para juntar vizinhos)
+// e por (tamanho, posição) (para best-fit)
+typedef struct {
+    ExtentNode *by_offset;
+    ExtentNode *by_length;
+    uint32_t count;        // Número de trechos livres
+    uint32_t free_blocks;  // Soma dos tamanhos
+} ExtentTree;
+
+void extent_tree_init(ExtentTree *tree);
+void extent_tree_destroy(ExtentTree *tree);
+
+// Monta a árvore a partir de um bitmap (bit 0 = livre) no intervalo [first, last)
+void extent_tree_build(ExtentTree *tree, const uint8_t *bitmap, uint32_t first, uint32_t last);
+
+// Devolve [start, start + len) ao espaço livre, juntando com os vizinhos
+void extent_tree_insert(ExtentTree *tree, uint32_t start, uint32_t len);
+
+// Retira [start, start + len) do espaço livre (o intervalo precisa estar livre)
+void extent_tree_remove(ExtentTree *tree, uint32_t start, uint32_t len);
+
+// Menor trecho com pelo menos count blocos (0 = achou, -1 = não há)
+int extent_tree_best_fit(ExtentTree *tree, uint32_t count, uint32_t *start, uint32_t *len);
+
+// Trecho de menor posição com início >= from e pelo menos count blocos
+// (0 = achou, -1 = não há)
+int extent_tree_first_fit(ExtentTree *tree, uint32_t from, uint32_t count, uint32_t *start, uint32_t *len);
+
+// Trecho livre que contém block (0 = achou, -1 = bloco não está livre)
+int extent_tree_find(ExtentTree *tree, uint32_t block, uint32_t *start, uint32_t *len);
+
+// Maior trecho livre (0 se a árvore estiver vazia)
+uint32_t extent_tree_largest(ExtentTree *tree);
+
+// Percorre os trechos livres em ordem de posição
+void extent_tree_walk(ExtentTree *tree, void (*fn)(uint32_t start, uint32_t len, void *arg), void *arg);
+
+#endif
@@ -0,0 +1,38 @@
+#ifndef FSCK_H
+#define FSCK_H
+
+#include <stdint.h>
+#include "disk.h"
+
+#define FSCK_MAX_THREADS 8          // Máximo de threads na varredura da tabela de i-nodes
+#define FSCK_LOST_FOUND "lost+found" // Diretório onde órfãos são reanexados
+
+// Resultado de uma verificação
+typedef struct {
+    uint32_t inodes_used;        // I-nodes em uso na tabela
+    uint32_t orphan_inodes;      // Arquivos sem nenhuma entrada de diretório
+    uint32_t unreachable_dirs;   // Diretórios que não são alcançáveis a partir do root
+    uint32_t double_alloc;       // Blocos referenciados por mais de um i-node
+    uint32_t invalid_blocks;     // Ponteiros para blocos fora da área de dados
+    uint32_t unmarked_blocks;    // Blocos em uso mas livres no bitmap
+    uint32_t leaked_blocks;      // Blocos marcados no bitmap sem nenhum dono
+    uint32_t dangling_entries;   // Entradas de diretório apontando para i-node livre/inválido
+    uint32_t bad_dot_entries;    // Entradas "." ou ".." incorretas
+    uint32_t inode_bitmap_errors; // I-nodes cujo bit no bitmap não confere com o mode
+    uint32_t bad_counters;       // Contadores de livres do superbloco incorretos
+    uint32_t bad_usage;          // Diretórios com uso acumulado ou pai incorretos
+    uint32_t bad_links;          // I-nodes cujo nlink não confere com as entradas
+    uint32_t repaired;           // Problemas corrigidos (modo reparo)
+    int threads;                 // Threads usadas na varredura
+    double elapsed_ms;           // Tempo total da verificação
+} FsckReport;
+
+// Verifica a consistência do sistema de arquivos. Com repair != 0 corrige
+// os problemas encontrados. num_threads <= 0 usa o número de CPUs.
+// Retorna o número de problemas encontrados ou -1 em caso de erro.
+int fsck_run(Disk *disk, int repair, int num_threads, FsckReport *report);
+
+// Exibe o relatório de uma verificação
+void fsck_print_report(const FsckReport *report);
+
+#endif
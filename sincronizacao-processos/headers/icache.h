@@ -0,0 +1,47 @@
+#ifndef ICACHE_H
+#define ICACHE_H
+
+#include <stdint.h>
+#include "disk.h"
+#include "inode.h"
+
+#define ICACHE_SLAB_OBJECTS 256  // I-nodes em memória por slab
+#define ICACHE_BUCKETS 4096      // Baldes da tabela hash (potência de 2)
+#define ICACHE_MAX_UNUSED 65536  // I-nodes sem referência mantidos em cache (padrão)
+
+// Contadores do cache de i-nodes
+typedef struct {
+    uint64_t hits;          // inode_load atendido pelo cache
+    uint64_t misses;        // inode_load que leu o disco
+    uint64_t evictions;     // I-nodes sem referência descartados
+    uint32_t cached;        // I-nodes na tabela hash
+    uint32_t in_use;        // Objetos fora da lista livre (cache ou anônimos)
+    uint32_t slabs;         // Slabs alocados (cada um é um único malloc)
+    uint32_t slab_free;     // Objetos livres nos slabs
+} ICacheStats;
+
+// Pega um objeto do slab (zerado, uma referência, fora do cache)
+Inode *icache_alloc(void);
+// Devolve uma referência. Objetos anônimos voltam ao slab; os do cache
+// ficam na lista LRU até serem reaproveitados
+void icache_put(Inode *inode);
+
+// I-node inode_num já em memória (ganha uma referência) ou NULL
+Inode *icache_lookup(Disk *disk, uint32_t inode_num);
+// Coloca no cache um objeto de icache_alloc recém-lido do disco. Se outra
+// thread inseriu antes, devolve o objeto já existente e libera o novo
+Inode *icache_insert(Disk *disk, uint32_t inode_num, Inode *inode);
+// Copia para o objeto em cache o que foi gravado no disco (se houver)
+void icache_update(Disk *disk, uint32_t inode_num, const Inode *inode);
+// Esquece o i-node (ele foi regravado no disco por fora de inode_save)
+void icache_invalidate(Disk *disk, uint32_t inode_num);
+// Altera quantos i-nodes sem referência ficam em cache (vale para os próximos
+// inode_put; 0 descarta cada i-node assim que a última referência é devolvida)
+void icache_set_limit(uint32_t max);
+// Esquece todos os i-nodes do disco e libera o cache
+void icache_destroy(Disk *disk);
+
+// Contadores do cache do disco
+void icache_stats(Disk *disk, ICacheStats *stats);
+
+#endif
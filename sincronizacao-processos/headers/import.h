@@ -0,0 +1,32 @@
+#ifndef IMPORT_H
+#define IMPORT_H
+
+#include <stdint.h>
+#include "disk.h"
+
+#define IMPORT_READERS 4         // Threads que leem os arquivos do host
+#define IMPORT_QUEUE_DEPTH 64    // Arquivos lidos à frente do gravador
+#define IMPORT_BATCH_BLOCKS 256  // Blocos consecutivos acumulados por escrita na imagem
+
+// Resultado de uma importação
+typedef struct {
+    uint32_t files;       // Arquivos importados
+    uint32_t dirs;        // Diretórios criados
+    uint32_t skipped;     // Entradas ignoradas (nome longo, arquivo grande, tipo especial...)
+    uint64_t bytes;       // Bytes de dados lidos do host
+    uint32_t blocks;      // Blocos de dados e de diretório gravados
+    uint32_t holes;       // Blocos zerados que ficaram como buracos
+    uint32_t writes;      // Escritas de dados feitas na imagem
+    double elapsed_ms;    // Tempo total
+} ImportReport;
+
+// Copia o conteúdo de host_dir (recursivamente) para o diretório dir_inode_num.
+// O espaço é calculado antes e reservado em trechos contíguos; a leitura dos
+// arquivos do host roda em threads separadas da gravação na imagem.
+// Retorna 0 ou -1 em caso de erro (nada é alterado se faltar espaço)
+int import_tree(Disk *disk, const char *host_dir, uint32_t dir_inode_num, ImportReport *report);
+
+// Exibe o relatório de uma importação
+void import_print_report(const ImportReport *report);
+
+#endif
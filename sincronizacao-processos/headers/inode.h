@@ -12,22 +12,54 @@ typedef struct {
     uint32_t mode;              // Tipo (arquivo/diretório) e permissões
     uint32_t uid;               // Dono
     uint32_t size;              // Tamanho em bytes
+    uint32_t nlink;             // Entradas de diretório que apontam para o i-node
+                                // (0 em imagens antigas vale como 1)
     time_t created_at;          // Timestamp de criação
     time_t modified_at;         // Timestamp de modificação
     uint32_t blocks[DIRECT_BLOCKS]; // Blocos diretos
     uint32_t indirect_block;    // Bloco indireto
+    // Diretórios: uso acumulado da subárvore, mantido a cada operação
+    uint32_t parent;            // I-node do pai (a raiz aponta para si mesma); num
+                                // arquivo com vários links, o diretório que conta o uso
+    uint32_t tree_files;        // Arquivos na subárvore
+    uint64_t tree_bytes;        // Bytes da subárvore, incluindo o próprio diretório
+    uint64_t tree_blocks;       // Blocos da subárvore, incluindo os do próprio diretório
 } Inode;
 
+// Zera a tabela de i-nodes (todos livres)
+void inode_table_init(Disk *disk);
 // Cria um novo i-node vazio
 Inode *inode_create(uint32_t mode);
 // Salva i-node no disco
 void inode_save(Disk *disk, uint32_t inode_num, Inode *inode);
-// Carrega i-node do disco
+// Carrega i-node do disco ou do cache
+// (o objeto é compartilhado pelo cache de i-nodes: devolva com inode_put)
 Inode *inode_load(Disk *disk, uint32_t inode_num);
+// Devolve um i-node obtido com inode_load ou inode_create
+void inode_put(Inode *inode);
+// Carrega count i-nodes em out com um único lote de leituras (motor de E/S).
+// Retorna 0 ou -1 se alguma leitura falhar (o i-node fica zerado)
+int inode_load_many(Disk *disk, const uint32_t *inode_nums, uint32_t count, Inode *out);
 
-uint32_t inode_alloc();
+// Reserva um i-node livre no bitmap ((uint32_t)-1 se não houver)
+uint32_t inode_alloc(Disk *disk);
+
+// Reserva count i-nodes de uma vez (uma leitura e uma escrita do bitmap).
+// Retorna 0 ou -1 se não houver i-nodes livres suficientes
+int inode_alloc_many(Disk *disk, uint32_t count, uint32_t *inode_nums);
 
 void inode_reset_counter();
 
 void inode_free(Disk *disk, uint32_t inode_num);
+
+// Reserva count blocos para inode->blocks[first_index..] em trechos contíguos
+int inode_alloc_blocks(Disk *disk, Inode *inode, uint32_t first_index, uint32_t count);
+
+// Grava len bytes nos blocos do i-node, uma escrita por trecho contíguo
+// (blocos 0 são buracos e os bytes correspondentes são ignorados)
+int inode_write_blocks(Disk *disk, Inode *inode, uint32_t first_index, uint32_t count, const uint8_t *data, uint32_t len);
+
+// Grava len bytes a partir do bloco 0 reservando só os blocos que não são
+// inteiramente zero; os demais ficam como buracos (ponteiro 0)
+int inode_write_sparse(Disk *disk, Inode *inode, const uint8_t *data, uint32_t len);
 #endif
\ No newline at end of file
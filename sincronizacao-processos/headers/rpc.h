@@ -0,0 +1,91 @@
+#ifndef RPC_H
+#define RPC_H
+
+#include <stdint.h>
+
+// Protocolo binário do modo servidor (socket Unix, ordem de bytes da máquina).
+// Cada pedido é um RpcRequest seguido de len bytes; cada resposta, um
+// RpcResponse seguido de len bytes. Um cliente pode enviar vários pedidos sem
+// esperar as respostas: elas voltam na mesma ordem, com o mesmo id
+
+#define RPC_SOCKET_DEFAULT "fs.sock"
+#define RPC_MAX_PAYLOAD (64 * 1024)     // Maior corpo de pedido ou resposta
+
+typedef enum {
+    RPC_LOOKUP = 1,     // dir + nome -> inode
+    RPC_CREATE,         // dir, corpo = nome (count bytes) + conteúdo inicial -> inode;
+                        // flags RPC_CREATE_DIR cria um diretório
+    RPC_READ,           // inode, offset, count (0 = até o fim) -> bytes
+    RPC_WRITE,          // dir (pai), inode, offset + dados
+    RPC_READDIR,        // dir, offset = índice inicial, count = máximo (0 = o que couber) -> RpcDirent...
+    RPC_STAT,           // inode -> RpcStat
+    RPC_OP_COUNT
+} RpcOp;
+
+#define RPC_CREATE_DIR 1
+
+typedef enum {
+    RPC_OK = 0,
+    RPC_ENOENT,         // Nome ou i-node inexistente
+    RPC_EEXIST,         // CREATE: o nome já existe no diretório
+    RPC_ENOTDIR,
+    RPC_EISDIR,
+    RPC_EINVAL,         // Nome vazio ou longo demais, offset além do limite de 10 blocos
+    RPC_ENOSPC,
+    RPC_EIO,
+    RPC_EBADOP,         // Operação desconhecida
+    RPC_STATUS_COUNT
+} RpcStatus;
+
+typedef struct {
+    uint32_t len;       // Bytes após o cabeçalho (nome ou dados)
+    uint32_t id;        // Escolhido pelo cliente e devolvido na resposta
+    uint8_t op;
+    uint8_t flags;
+    uint16_t reserved;
+    uint32_t dir;
+    uint32_t inode;
+    uint32_t offset;
+    uint32_t count;
+} RpcRequest;
+
+typedef struct {
+    uint32_t len;       // Bytes após o cabeçalho
+    uint32_t id;
+    uint8_t op;
+    uint8_t status;     // RpcStatus
+    uint16_t reserved;
+    uint32_t inode;     // LOOKUP/CREATE: i-node; READDIR: índice para continuar (0 = fim)
+} RpcResponse;
+
+// Corpo da resposta de STAT
+typedef struct {
+    uint32_t inode;
+    uint32_t mode;
+    uint32_t size;
+    uint32_t blocks;    // Blocos alocados (sem os buracos)
+    int64_t created_at;
+    int64_t modified_at;
+} RpcStat;
+
+// READDIR devolve uma sequência de: uint32_t inode, uint8_t name_len, name (sem \0)
+#define RPC_DIRENT_HEADER 5
+
+const char *rpc_op_name(RpcOp op);
+const char *rpc_status_name(RpcStatus status);
+
+/* ====================== */
+/* Cliente                */
+/* ====================== */
+
+// Conecta ao servidor. Retorna o descritor ou -1
+int rpc_connect(const char *path);
+// Envia um pedido (req->len bytes de payload). Retorna 0 ou -1
+int rpc_send(int fd, const RpcRequest *req, const void *payload);
+// Recebe a próxima resposta; até cap bytes do corpo vão para payload e o
+// restante é descartado. Retorna 0 ou -1 se a conexão cair
+int rpc_recv(int fd, RpcResponse *resp, void *payload, uint32_t cap);
+// Pedido e resposta em seguida
+int rpc_call(int fd, const RpcRequest *req, const void *payload, RpcResponse *resp, void *out, uint32_t cap);
+
+#endif
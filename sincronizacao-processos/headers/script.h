@@ -1,8 +1,30 @@
 #ifndef SCRIPT_H
 #define SCRIPT_H
+#include <stdio.h>
 #include "dir.h"
 #include "disk.h"
+#include "superblock.h"
+#include "command.h"
+
+// Parâmetros de execução de um arquivo de script (0 ou -1 = valor do script ou padrão)
+typedef struct {
+    const char *image;      // Imagem criada para o script
+    uint32_t block_size;    // 0 = primeira linha do script
+    uint64_t disk_mb;       // 0 = primeira linha do script (ou 10 MB)
+    int engine;             // Motor de E/S (-1 = io_uring)
+    int policy;             // Política de alocação (-1 = first-fit)
+    CmdOutput output;       // Modo de saída dos comandos
+} ScriptOptions;
+
 void modo_script(const char *filename);
+// Cria a imagem do script conforme opts e executa os comandos. Retorna 0 ou -1
+int script_execute(const char *filename, const ScriptOptions *opts);
+// Executa os comandos de script num disco já montado. header_lines = linhas
+// já lidas de script (para numerar as falhas do modo batch)
+void script_run(Disk *disk, FILE *script, CmdOutput output, uint64_t header_lines);
+// Formata uma imagem nova e cria o root (sb precisa viver enquanto o disco estiver aberto).
+// Retorna NULL em caso de erro
+Disk *script_format(const char *image, uint64_t disk_size, uint32_t block_size, int policy, Superblock *sb);
 int dir_create_root(Disk *disk);
 
 
@@ -10,4 +32,4 @@ int dir_create_root(Disk *disk);
 void print_directory_tree(Disk *disk, uint32_t dir_inode, int depth);
 
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,30 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+#include <stdint.h>
+#include "disk.h"
+#include "rpc.h"
+
+#define SERVER_MAX_EVENTS 64
+#define SERVER_OUT_HIGH (4 * RPC_MAX_PAYLOAD)   // Respostas pendentes antes de parar de ler a conexão
+
+// Contadores de uma execução do servidor
+typedef struct {
+    uint32_t connections;
+    uint32_t protocol_errors;              // Conexões fechadas por cabeçalho inválido
+    uint64_t requests[RPC_OP_COUNT];
+    uint64_t errors[RPC_OP_COUNT];         // Respostas com status diferente de RPC_OK
+    uint64_t bytes_in;
+    uint64_t bytes_out;
+    uint32_t max_pipeline;                 // Maior número de pedidos tratados de uma vez numa conexão
+    double elapsed_ms;
+} ServerReport;
+
+// Serve o disco montado no socket Unix path até receber SIGINT ou SIGTERM.
+// Todos os clientes compartilham o cache de i-nodes e o alocador.
+// Retorna 0 ou -1 se o socket não puder ser criado
+int server_run(Disk *disk, const char *path, ServerReport *report);
+// Exibe o relatório de uma execução
+void server_print_report(const ServerReport *report);
+
+#endif
@@ -0,0 +1,77 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <stdint.h>
+#include <time.h>
+#include <sys/types.h>
+#include "disk.h"
+#include "inode.h"
+
+// Snapshots da imagem inteira por cópia na escrita (copy-on-write).
+//
+// Criar um snapshot não copia nada: grava um registro e dois mapas zerados,
+// um para a tabela de i-nodes e outro para o bitmap de blocos (uma entrada
+// por bloco). Na primeira escrita num desses blocos depois do snapshot, o
+// conteúdo antigo é copiado para um bloco novo e o mapa aponta para a cópia.
+// Blocos de dados em uso no momento do snapshot ficam retidos: o sistema vivo
+// grava num bloco novo (inode->blocks passa a apontar para ele) e, ao liberar
+// um bloco retido, ele continua marcado no bitmap até o snapshot ser removido.
+// Assim cada snapshot só ocupa os blocos alterados depois dele.
+
+#define SNAPSHOT_MAX 16                 // Registros na tabela (cabe num bloco de 512 bytes)
+
+// Registro de um snapshot na tabela (bloco sb->snapshot_table)
+typedef struct {
+    uint32_t id;            // 0 = posição livre
+    uint32_t itable_map;    // Primeiro bloco do mapa da tabela de i-nodes
+    uint32_t bitmap_map;    // Primeiro bloco do mapa do bitmap de blocos
+    uint32_t free_blocks;   // Contadores do superbloco no momento do snapshot
+    uint32_t free_inodes;
+    uint32_t reserved;
+    int64_t created_at;
+} SnapshotRecord;
+
+// Ocupação de um snapshot
+typedef struct {
+    uint32_t id;
+    time_t created_at;
+    uint32_t copies;        // Blocos de metadados copiados desde o snapshot
+    uint32_t map_blocks;    // Blocos dos dois mapas
+} SnapshotInfo;
+
+// Congela o estado atual da imagem. Retorna o número do snapshot ou
+// (uint32_t)-1 se a tabela estiver cheia ou faltar espaço para os mapas
+uint32_t snapshot_create(Disk *disk);
+// Remove o snapshot e libera os blocos que só ele retinha. Retorna 0 ou -1
+int snapshot_delete(Disk *disk, uint32_t id);
+// Preenche até max registros, do mais antigo ao mais novo. Retorna quantos.
+// *retained recebe os blocos marcados no bitmap que só os snapshots usam
+int snapshot_list(Disk *disk, SnapshotInfo *out, uint32_t max, uint32_t *retained);
+
+// Abre o snapshot id da imagem só para leitura: i-nodes vêm do estado
+// congelado e o descritor não permite escrita. Retorna NULL se não existir
+Disk *snapshot_open(const char *filename, uint32_t id);
+// Número do snapshot se o disco foi aberto por snapshot_open, 0 caso contrário
+uint32_t snapshot_read_only(Disk *disk);
+// Posição na visão do snapshot de um byte da tabela de i-nodes (a própria
+// posição se o disco não for um snapshot)
+off_t snapshot_view_offset(Disk *disk, off_t offset);
+
+// Chamado antes de gravar count blocos a partir de block: blocos da tabela
+// de i-nodes ou do bitmap ainda não copiados para o snapshot mais novo são
+// copiados agora. Retorna 0 ou -1 se não houver espaço para a cópia
+int snapshot_cow_meta(Disk *disk, uint32_t block, uint32_t count);
+// 1 se algum snapshot retém o bloco (bitmap_set não o libera)
+int snapshot_holds(Disk *disk, uint32_t block_num);
+// Antes de gravar em inode->blocks[index]: se o bloco é retido por um
+// snapshot, troca-o por um bloco novo (com o conteúdo antigo se keep).
+// Retorna 1 se o ponteiro mudou (o chamador grava o i-node), 0 ou -1
+int snapshot_cow_block(Disk *disk, Inode *inode, uint32_t index, int keep);
+
+// Marca em owned[b] (um byte por bloco) os blocos que pertencem aos
+// snapshots: retidos, cópias, mapas e a tabela (usado pelo fsck)
+void snapshot_mark_blocks(Disk *disk, uint8_t *owned);
+// Libera o estado em memória (chamado por disk_free)
+void snapshot_detach(Disk *disk);
+
+#endif
@@ -0,0 +1,123 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <stdint.h>
+#include <sys/types.h>
+#include "disk.h"
+
+#define STATS_SUB_BITS 4                          // 16 faixas por potência de 2 (erro < 6,25%)
+#define STATS_BUCKETS (64 << STATS_SUB_BITS)      // Cobre qualquer valor de 64 bits
+#define STATS_JSON_FILE "fs_stats.json"           // Gravado ao sair dos modos script e interativo
+
+// Operações públicas instrumentadas de bitmap.c, inode.c e dir.c
+typedef enum {
+    STATS_OP_NONE,              // E/S fora de qualquer operação (ex.: threads do motor de E/S)
+    STATS_BITMAP_SET,
+    STATS_BITMAP_SET_RANGE,
+    STATS_BITMAP_GET,
+    STATS_BITMAP_FIND_FREE_BLOCK,
+    STATS_BITMAP_FIND_FREE_RUN,
+    STATS_INODE_BITMAP_SET,
+    STATS_INODE_BITMAP_GET,
+    STATS_INODE_SAVE,
+    STATS_INODE_LOAD,
+    STATS_INODE_LOAD_MANY,
+    STATS_INODE_ALLOC,
+    STATS_INODE_ALLOC_MANY,
+    STATS_INODE_FREE,
+    STATS_INODE_ALLOC_BLOCKS,
+    STATS_INODE_WRITE_BLOCKS,
+    STATS_INODE_WRITE_SPARSE,
+    STATS_DIR_CREATE,
+    STATS_DIR_ADD_ENTRY,
+    STATS_DIR_USAGE_ADD,
+    STATS_DIR_ITER_OPEN,
+    STATS_DIR_ITER_NEXT,
+    STATS_DIR_ITER_UPDATE,
+    STATS_DIR_FIND_ENTRY,
+    STATS_DIR_LOOKUP,
+    STATS_DIR_LIST,
+    STATS_DIR_LIST_DETAILED,
+    STATS_DIR_LIST_DIRS,
+    STATS_DIR_RENAME_ENTRY,
+    STATS_DIR_REMOVE_ENTRY,
+    STATS_DIR_FIND_PARENT,
+    STATS_FILE_CREATE,
+    STATS_FILE_CREATE_DATA,
+    STATS_FILE_READ,
+    STATS_FILE_READ_DATA,
+    STATS_FILE_WRITE_DATA,
+    STATS_FILE_TRUNCATE,
+    STATS_FILE_SEEK,
+    STATS_FILE_DELETE,
+    STATS_FILE_LINK,
+    STATS_SNAPSHOT_CREATE,
+    STATS_SNAPSHOT_DELETE,
+    STATS_SNAPSHOT_COW,
+    STATS_OP_COUNT
+} StatsOp;
+
+// Tipos de syscall contados
+typedef enum {
+    STATS_SYS_READ,     // read e pread
+    STATS_SYS_WRITE,    // write e pwrite
+    STATS_SYS_SEEK,     // lseek
+    STATS_SYS_URING,    // io_uring_enter
+    STATS_SYS_OTHER,    // fallocate, fdatasync
+    STATS_SYS_COUNT
+} StatsSyscall;
+
+// Contadores de uma operação. O tempo é inclusivo (operações aninhadas contam
+// nas duas); syscalls e bytes vão só para a operação mais interna em andamento
+typedef struct {
+    uint64_t count;
+    uint64_t total_ns;
+    uint64_t min_ns;
+    uint64_t max_ns;
+    uint64_t syscalls;
+    uint64_t bytes_read;
+    uint64_t bytes_written;
+    uint64_t hist[STATS_BUCKETS]; // Histograma log-linear (estilo HDR) das latências
+} StatsOpCounters;
+
+// Medição em andamento (criada por STATS_SCOPE)
+typedef struct {
+    StatsOp op;
+    StatsOp prev;   // Operação externa, restaurada no fim
+    uint64_t start; // 0 = contadores desligados
+} StatsScope;
+
+StatsScope stats_scope_begin(StatsOp op);
+void stats_scope_end(StatsScope *scope);
+
+// Mede a operação do início da declaração até a saída do bloco (qualquer return)
+#define STATS_SCOPE(op) \
+    StatsScope stats_scope_ __attribute__((cleanup(stats_scope_end))) = stats_scope_begin(op)
+
+// Syscalls de E/S contadas na operação em andamento
+ssize_t stats_read(int fd, void *buf, size_t len);
+ssize_t stats_write(int fd, const void *buf, size_t len);
+ssize_t stats_pread(int fd, void *buf, size_t len, off_t offset);
+ssize_t stats_pwrite(int fd, const void *buf, size_t len, off_t offset);
+off_t stats_lseek(int fd, off_t offset, int whence);
+// Conta uma syscall feita diretamente (io_uring_enter, fallocate, ...)
+void stats_syscall(StatsSyscall kind);
+// Conta bytes transferidos sem read/write (conclusões do io_uring)
+void stats_bytes(int write, uint64_t bytes);
+
+// Liga/desliga a medição de tempo (os contadores de E/S continuam)
+void stats_enable(int enable);
+// Zera todos os contadores
+void stats_reset(void);
+// Cópia dos contadores de uma operação
+void stats_get(StatsOp op, StatsOpCounters *out);
+// Latência (ns) abaixo da qual estão p (0 a 1) das chamadas
+uint64_t stats_percentile(const StatsOpCounters *c, double p);
+const char *stats_op_name(StatsOp op);
+
+// Exibe a tabela por operação, as syscalls e o cache de i-nodes do disco
+void stats_print(Disk *disk);
+// Grava tudo em JSON, com os histogramas. Retorna 0 ou -1
+int stats_write_json(Disk *disk, const char *path);
+
+#endif
@@ -3,22 +3,52 @@
 
 #include "disk.h"
 
-typedef struct {
+#define BYTES_PER_INODE 4096 // Um i-node para cada 4KB de disco
+#define INODE_COUNT_MAX (1u << 22) // Limite da tabela de i-nodes (512MB) em discos grandes
+
+typedef struct Superblock {
     uint32_t magic;         // Número mágico (identificação)
-    uint32_t disk_size;     // Tamanho total
+    uint64_t disk_size;     // Tamanho total (bytes)
     uint32_t block_size;    // Tamanho do bloco
     uint32_t inode_count;   // Número total de inodes
     uint32_t free_blocks;   // Blocos livres
     uint32_t free_inodes;       // I-nodes livres
-    uint32_t inode_start; 
+    uint32_t inode_start;       // Bloco onde inicia a tabela de i-nodes
     uint32_t bitmap_start_block;
     uint32_t free_blocks_bitmap_start; // Bloco onde inicia o bitmap
     uint32_t free_blocks_count;       // Blocos livres totais
+    uint32_t data_start_block;  // Primeiro bloco de dados (após os metadados)
+    uint32_t inode_bitmap_start; // Bloco onde inicia o bitmap de i-nodes
+    uint32_t alloc_policy;      // Política de alocação de blocos (AllocPolicy)
+    uint32_t snapshot_table;    // Bloco da tabela de snapshots (0 = nunca criada)
+    uint32_t snapshot_count;    // Snapshots ativos
+    uint32_t snapshot_next_id;  // Número do próximo snapshot
 } Superblock;
 
+// Estatísticas de ocupação (equivalente ao statfs)
+typedef struct {
+    uint32_t block_size;    // Tamanho do bloco
+    uint32_t total_blocks;  // Blocos do disco
+    uint32_t data_blocks;   // Blocos disponíveis para dados
+    uint32_t free_blocks;   // Blocos livres
+    uint32_t total_inodes;  // I-nodes na tabela
+    uint32_t free_inodes;   // I-nodes livres
+} FsStat;
+
 // Escreve o superbloco no disco
 void superblock_init(Disk *disk, Superblock *sb);
 // Lê o superbloco do disco
 Superblock *superblock_load(Disk *disk);
+// Abre uma imagem já formatada (tamanho e bloco vêm do superbloco).
+// Retorna NULL se o arquivo não existir ou não for uma imagem válida
+Disk *superblock_open(const char *filename);
+// Grava o superbloco em memória de volta no disco
+void superblock_sync(Disk *disk);
+// Marca os contadores como alterados; a gravação fica para superblock_flush
+void superblock_mark_dirty(Disk *disk);
+// Grava o superbloco se houver mudanças pendentes (fim de cada comando e disk_free)
+void superblock_flush(Disk *disk);
+// Preenche as estatísticas de ocupação a partir dos contadores (O(1))
+void superblock_statfs(Disk *disk, FsStat *st);
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,88 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+#include "disk.h"
+
+#define TRACE_MAGIC 0x52545346      // "FSTR"
+#define TRACE_VERSION 1
+#define TRACE_DEFAULT_FILE "fs_trace.bin"
+
+// Operações gravadas (uma por comando dos modos script e interativo)
+typedef enum {
+    TRACE_MKDIR,    // a = pai, nome -> result = novo diretório
+    TRACE_CREATE,   // a = pai, b = blocos-buraco (bit i = bloco i), c = tamanho, nome -> result
+    TRACE_COPY,     // a = diretório destino, b = arquivo de origem, nome -> result
+    TRACE_READ,     // b = arquivo
+    TRACE_LIST,     // a = diretório
+    TRACE_DELETE,   // a = pai, b = arquivo
+    TRACE_RMDIR,    // a = pai, b = diretório
+    TRACE_RENAME,   // a = pai, b = entrada, nome
+    TRACE_MOVE,     // a = origem, b = arquivo, c = destino
+    TRACE_LINK,     // a = diretório, b = arquivo, nome
+    TRACE_WRITE,    // a = diretório, b = arquivo, c = offset, result = bytes gravados
+    TRACE_TRUNCATE, // a = diretório, b = arquivo, c = novo tamanho
+    TRACE_OP_COUNT
+} TraceOp;
+
+// Cabeçalho do arquivo de trace
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t reserved;
+    uint32_t block_size;    // Bloco do disco onde o trace foi gravado
+    uint32_t reserved2;
+} TraceHeader;
+
+// Registro de tamanho fixo, seguido de name_len bytes do nome (sem \0)
+typedef struct {
+    uint8_t op;
+    uint8_t ok;             // A operação deu certo quando foi gravada
+    uint8_t name_len;
+    uint8_t reserved;
+    uint32_t a, b, c;
+    uint32_t result;        // I-node criado (MKDIR, CREATE, COPY); bytes (WRITE)
+    uint32_t latency_ns;    // Limitado a UINT32_MAX (~4,3 s)
+    uint64_t timestamp_ns;  // Início da operação, desde trace_start
+} TraceRecord;
+
+// Resultado de uma reprodução
+typedef struct {
+    uint32_t records;
+    uint32_t ops[TRACE_OP_COUNT];
+    uint32_t errors[TRACE_OP_COUNT];     // Falharam na reprodução
+    uint32_t divergent;                  // Resultado diferente do gravado (ok/falha)
+    uint64_t recorded_ns[TRACE_OP_COUNT]; // Latência somada na gravação
+    uint64_t replay_ns[TRACE_OP_COUNT];   // Latência somada na reprodução
+    double trace_ms;                     // Duração da gravação
+    double elapsed_ms;                   // Duração da reprodução
+} TraceReport;
+
+// Começa a gravar em path (sobrescreve). Retorna 0 ou -1
+int trace_start(const char *path, uint32_t block_size);
+// Termina a gravação (nada acontece se não houver uma em andamento)
+void trace_stop(void);
+// Há uma gravação em andamento
+int trace_active(void);
+
+// Marca o início de uma operação (0 se não houver gravação)
+uint64_t trace_begin(void);
+// Grava a operação iniciada em start
+void trace_end(uint64_t start, TraceOp op, uint32_t a, uint32_t b, uint32_t c,
+               const char *name, uint32_t result, int ok);
+// Grava MKDIR, CREATE ou COPY: o i-node criado é procurado pelo nome em dir
+// (CREATE também guarda o tamanho e os buracos do arquivo criado)
+void trace_end_create(Disk *disk, uint64_t start, TraceOp op, uint32_t dir, uint32_t source,
+                      const char *name, int ok);
+
+// Reproduz o trace no disco. O root gravado (i-node 0) vira root_inode e os
+// i-nodes criados pelo trace são mapeados para os criados na reprodução; os
+// demais são usados como estão. paced = 1 respeita os intervalos gravados,
+// 0 executa o mais rápido possível. Retorna 0 ou -1 se o arquivo for inválido
+int trace_replay(Disk *disk, const char *path, uint32_t root_inode, int paced, TraceReport *report);
+
+const char *trace_op_name(TraceOp op);
+// Exibe o relatório de uma reprodução
+void trace_print_report(const TraceReport *report);
+
+#endif
@@ -0,0 +1,48 @@
+#ifndef WALK_H
+#define WALK_H
+
+#include <stdint.h>
+#include "disk.h"
+#include "inode.h"
+
+#define WALK_MAX_THREADS 16 // Limite de threads da caminhada paralela
+
+// Entrada visitada pela caminhada
+typedef struct {
+    uint32_t inode_num;
+    const char *name;      // Nome na entrada do pai ("/" na raiz)
+    const char *path;      // Caminho a partir da raiz da caminhada ("/a/b")
+    const Inode *inode;
+    uint32_t depth;        // 0 na raiz
+    int is_dir;
+    uint64_t total_bytes;  // Tamanho da subárvore (o próprio tamanho em arquivos)
+    uint64_t total_blocks; // Blocos alocados na subárvore
+    uint32_t files;        // Arquivos na subárvore
+    uint32_t dirs;         // Subdiretórios na subárvore (sem contar o próprio)
+} WalkEntry;
+
+// Chamada para cada entrada; arg é o ponteiro passado a walk_tree
+typedef void (*WalkFn)(const WalkEntry *entry, void *arg);
+
+// Resultado de uma caminhada
+typedef struct {
+    uint32_t dirs;         // Diretórios lidos
+    uint32_t files;        // Arquivos encontrados
+    uint32_t steals;       // Diretórios roubados da fila de outra thread
+    int threads;           // Threads usadas
+    double elapsed_ms;     // Tempo total
+} WalkReport;
+
+// Percorre a subárvore de root_inode_num sem limite de profundidade. Os
+// diretórios são lidos em paralelo (uma fila por thread, com roubo de trabalho)
+// e depois pre (antes dos filhos) e post (depois deles) são chamadas em
+// profundidade, na ordem das entradas: a saída não depende do número de threads.
+// Os totais da subárvore já estão prontos em pre. num_threads <= 0 usa uma por CPU.
+// Retorna 0 ou -1 se root_inode_num não for um diretório
+int walk_tree(Disk *disk, uint32_t root_inode_num, int num_threads,
+              WalkFn pre, WalkFn post, void *arg, WalkReport *report);
+
+// Exibe o resumo de uma caminhada
+void walk_print_report(const WalkReport *report);
+
+#endif
@@ -0,0 +1,83 @@
+#ifndef WORKLOAD_H
+#define WORKLOAD_H
+
+#include <stdint.h>
+#include "disk.h"
+
+// Personalidades de carga (no estilo do filebench)
+typedef enum {
+    WORKLOAD_FILESERVER,   // Arquivos médios: cria, lê, apaga, stat e renomeia
+    WORKLOAD_MAILSERVER,   // Muitos arquivos pequenos em poucos diretórios grandes
+    WORKLOAD_LARGESEQ,     // Poucos arquivos do tamanho máximo, lidos e regravados inteiros
+    WORKLOAD_METASTORM,    // Só metadados: arquivos vazios, mkdir, lookup, list e rename
+    WORKLOAD_COUNT
+} WorkloadType;
+
+// Distribuição dos tamanhos de arquivo
+typedef enum {
+    WORKLOAD_SIZE_FIXED,   // Sempre size_mean
+    WORKLOAD_SIZE_UNIFORM, // Uniforme entre 0 e 2 * size_mean
+    WORKLOAD_SIZE_EXP,     // Exponencial com média size_mean
+    WORKLOAD_SIZE_COUNT
+} WorkloadSizeDist;
+
+// Operações sorteadas pela carga
+typedef enum {
+    WORKLOAD_OP_CREATE,
+    WORKLOAD_OP_READ,
+    WORKLOAD_OP_DELETE,
+    WORKLOAD_OP_STAT,
+    WORKLOAD_OP_RENAME,
+    WORKLOAD_OP_LOOKUP,
+    WORKLOAD_OP_LIST,
+    WORKLOAD_OP_MKDIR,
+    WORKLOAD_OP_COUNT
+} WorkloadOp;
+
+// Parâmetros de uma carga (workload_defaults preenche os da personalidade)
+typedef struct {
+    WorkloadType type;
+    uint32_t ops;                   // Operações sorteadas depois da preparação
+    uint32_t seed;
+    uint32_t fanout;                // Subdiretórios por diretório
+    uint32_t depth;                 // Níveis de diretórios (as folhas recebem os arquivos)
+    uint32_t files;                 // Arquivos criados na preparação
+    WorkloadSizeDist size_dist;
+    uint32_t size_mean;             // Bytes (limitado a 10 blocos por arquivo)
+    uint32_t mix[WORKLOAD_OP_COUNT]; // Peso de cada operação
+} WorkloadConfig;
+
+// Resultado de uma execução
+typedef struct {
+    uint32_t ops[WORKLOAD_OP_COUNT];    // Operações executadas, por tipo
+    uint32_t errors[WORKLOAD_OP_COUNT]; // Operações que falharam, por tipo
+    uint32_t dirs;                      // Diretórios criados na preparação
+    uint32_t files;                     // Arquivos vivos no fim
+    uint64_t bytes_written;
+    uint64_t bytes_read;
+    double setup_ms;                    // Preparação (árvore e arquivos iniciais)
+    double elapsed_ms;                  // Fase sorteada
+} WorkloadReport;
+
+// Preenche cfg com os valores padrão da personalidade
+void workload_defaults(WorkloadType type, WorkloadConfig *cfg);
+
+// Altera um parâmetro pelo nome (fanout, depth, files, size_dist, size_mean,
+// ou o peso de uma operação: create, read, delete, ...). Retorna 0 ou -1
+int workload_set(WorkloadConfig *cfg, const char *param, const char *value);
+
+// Cria a árvore e os arquivos iniciais dentro de dir_inode_num e executa cfg->ops
+// operações sorteadas com a mesma API do modo script. A mesma semente gera a
+// mesma sequência. Retorna 0 ou -1 se a preparação falhar
+int workload_run(Disk *disk, uint32_t dir_inode_num, const WorkloadConfig *cfg, WorkloadReport *report);
+
+const char *workload_type_name(WorkloadType type);
+// Retorna a personalidade com esse nome ou -1
+int workload_type_from_name(const char *name);
+
+// Exibe os parâmetros de uma carga
+void workload_print_config(const WorkloadConfig *cfg);
+// Exibe o relatório de uma execução
+void workload_print_report(const WorkloadReport *report);
+
+#endif
@@ -0,0 +1,510 @@
+// Benchmark do sistema de arquivos (make bench): operações de metadados,
+// vazão de dados e latência de alocação para cada tamanho de bloco aceito.
+// Os resultados saem em CSV ou JSON para comparar versões.
+#include "disk.h"
+#include "superblock.h"
+#include "inode.h"
+#include "bitmap.h"
+#include "dir.h"
+#include "alloc.h"
+#include "diskio.h"
+#include "script.h"
+#include "bench.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+
+#define BENCH_DISK_FILE "fs_bench.bin"
+#define BENCH_PAYLOAD_FILE "fs_bench_payload.bin"
+#define BENCH_DISK_MB 64
+#define BENCH_OPS_DEFAULT 2000
+#define BENCH_FILES_PER_DIR 100   // Cabe no menor diretório (10 blocos de 512 bytes)
+#define BENCH_PAYLOAD_SIZE 1000   // Bytes de cada arquivo criado nos testes de metadados
+#define BENCH_FILL_PERCENT 80     // Ocupação da imagem fragmentada antes da medição
+
+static const uint32_t block_sizes[] = {512, 1024, 2048, 4096, 8192};
+#define BENCH_BLOCK_SIZES (sizeof(block_sizes) / sizeof(block_sizes[0]))
+
+// Resultado de um teste
+typedef struct {
+    uint32_t block_size;
+    const char *name;
+    const char *image;     // "vazia" ou "fragmentada"
+    uint32_t ops;
+    uint32_t errors;
+    double seconds;
+    uint64_t bytes;        // Só nos testes de dados
+    double avg_ns;
+    uint64_t p50_ns;
+    uint64_t p99_ns;
+    uint64_t max_ns;
+} BenchResult;
+
+typedef struct {
+    BenchResult *items;
+    uint32_t count;
+    uint32_t capacity;
+} BenchResults;
+
+// Imagem aberta para um teste
+typedef struct {
+    Disk *disk;
+    Superblock sb;
+} BenchImage;
+
+// Latências de um teste, uma por operação
+typedef struct {
+    uint64_t *ns;
+    uint32_t count;
+    uint32_t errors;       // Operações que falharam (contam no tempo)
+    uint64_t total;
+} BenchTimer;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static void timer_init(BenchTimer *t, uint32_t ops) {
+    t->ns = malloc((ops ? ops : 1) * sizeof(uint64_t));
+    t->count = 0;
+    t->errors = 0;
+    t->total = 0;
+}
+
+static void timer_add(BenchTimer *t, uint64_t ns, int failed) {
+    t->ns[t->count++] = ns;
+    t->total += ns;
+    if (failed) t->errors++;
+}
+
+// Percentil pelo posto mais próximo (vetor já ordenado)
+static uint64_t percentile(const uint64_t *sorted, uint32_t count, uint32_t pct) {
+    uint32_t rank = (uint32_t)(((uint64_t)count * pct + 99) / 100);
+    return sorted[rank ? rank - 1 : 0];
+}
+
+static int compare_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+// Fecha o teste: ordena as latências e guarda o resultado
+static void timer_finish(BenchTimer *t, BenchResults *results, uint32_t block_size,
+                         const char *name, const char *image, uint64_t bytes) {
+    if (results->count == results->capacity) {
+        results->capacity = results->capacity ? results->capacity * 2 : 32;
+        results->items = realloc(results->items, results->capacity * sizeof(BenchResult));
+    }
+    BenchResult *r = &results->items[results->count++];
+    memset(r, 0, sizeof(BenchResult));
+    r->block_size = block_size;
+    r->name = name;
+    r->image = image;
+    r->ops = t->count;
+    r->errors = t->errors;
+    r->seconds = t->total / 1e9;
+    r->bytes = bytes;
+    if (t->count > 0) {
+        qsort(t->ns, t->count, sizeof(uint64_t), compare_u64);
+        r->avg_ns = (double)t->total / t->count;
+        r->p50_ns = percentile(t->ns, t->count, 50);
+        r->p99_ns = percentile(t->ns, t->count, 99);
+        r->max_ns = t->ns[t->count - 1];
+    }
+    free(t->ns);
+    t->ns = NULL;
+}
+
+// Formata uma imagem nova, como o modo script
+static int image_open(BenchImage *img, uint32_t block_size) {
+    img->disk = disk_create(BENCH_DISK_FILE, (uint64_t)BENCH_DISK_MB * 1024 * 1024, block_size);
+    if (!img->disk) return -1;
+    superblock_init(img->disk, &img->sb);
+    alloc_attach(img->disk, ALLOC_FIRST_FIT);
+    disk_io_init(img->disk, DISK_IO_URING, DISK_IO_DEPTH_DEFAULT);
+    inode_reset_counter();
+    bitmap_set(img->disk, 0, 1);
+    bitmap_set(img->disk, 1, 1);
+    if (dir_create_root(img->disk) != 0) {
+        disk_free(img->disk);
+        return -1;
+    }
+    return 0;
+}
+
+static void image_close(BenchImage *img) {
+    disk_free(img->disk);
+    unlink(BENCH_DISK_FILE);
+}
+
+/* ====================== */
+/* Metadados              */
+/* ====================== */
+
+// create, lookup, list, rename e delete de ops arquivos pequenos, em
+// diretórios de BENCH_FILES_PER_DIR entradas
+static int bench_metadata(uint32_t block_size, uint32_t ops, unsigned int seed, BenchResults *results) {
+    BenchImage img;
+    if (image_open(&img, block_size) != 0) return -1;
+    Disk *disk = img.disk;
+
+    uint32_t num_dirs = (ops + BENCH_FILES_PER_DIR - 1) / BENCH_FILES_PER_DIR;
+    uint32_t *dirs = malloc((num_dirs ? num_dirs : 1) * sizeof(uint32_t));
+    uint32_t *files = malloc((ops ? ops : 1) * sizeof(uint32_t));
+    uint32_t *order = malloc((ops ? ops : 1) * sizeof(uint32_t));
+    char name[MAX_NAME_LEN];
+    for (uint32_t d = 0; d < num_dirs; d++) {
+        snprintf(name, sizeof(name), "d%04u", d);
+        dir_create(disk, 0, name);
+        dirs[d] = dir_lookup(disk, 0, name);
+    }
+
+    // Ordem aleatória para lookup/rename/delete (Fisher-Yates)
+    for (uint32_t i = 0; i < ops; i++) order[i] = i;
+    for (uint32_t i = ops; i > 1; i--) {
+        uint32_t j = rand_r(&seed) % i;
+        uint32_t tmp = order[i - 1];
+        order[i - 1] = order[j];
+        order[j] = tmp;
+    }
+
+    BenchTimer t;
+    timer_init(&t, ops);
+    for (uint32_t i = 0; i < ops; i++) {
+        snprintf(name, sizeof(name), "f%05u", i);
+        uint64_t t0 = now_ns();
+        int failed = file_create(disk, dirs[i / BENCH_FILES_PER_DIR], BENCH_PAYLOAD_FILE, name) != 0;
+        timer_add(&t, now_ns() - t0, failed);
+    }
+    timer_finish(&t, results, block_size, "create", "vazia", 0);
+
+    timer_init(&t, ops);
+    for (uint32_t k = 0; k < ops; k++) {
+        uint32_t i = order[k];
+        snprintf(name, sizeof(name), "f%05u", i);
+        uint64_t t0 = now_ns();
+        files[i] = dir_lookup(disk, dirs[i / BENCH_FILES_PER_DIR], name);
+        timer_add(&t, now_ns() - t0, files[i] == (uint32_t)-1);
+    }
+    timer_finish(&t, results, block_size, "lookup", "vazia", 0);
+
+    // Uma operação = listar um diretório inteiro
+    timer_init(&t, num_dirs);
+    for (uint32_t d = 0; d < num_dirs; d++) {
+        uint64_t t0 = now_ns();
+        DirIter it;
+        int failed = dir_iter_open(disk, dirs[d], 0, &it) != 0;
+        if (!failed) {
+            while (dir_iter_next(&it, NULL)) {}
+            dir_iter_close(&it);
+        }
+        timer_add(&t, now_ns() - t0, failed);
+    }
+    timer_finish(&t, results, block_size, "list", "vazia", 0);
+
+    timer_init(&t, ops);
+    for (uint32_t k = 0; k < ops; k++) {
+        uint32_t i = order[k];
+        snprintf(name, sizeof(name), "r%05u", i);
+        uint64_t t0 = now_ns();
+        int failed = dir_rename_entry(disk, dirs[i / BENCH_FILES_PER_DIR], files[i], name) != 0;
+        timer_add(&t, now_ns() - t0, failed);
+    }
+    timer_finish(&t, results, block_size, "rename", "vazia", 0);
+
+    timer_init(&t, ops);
+    for (uint32_t k = 0; k < ops; k++) {
+        uint32_t i = order[k];
+        uint64_t t0 = now_ns();
+        int failed = file_delete(disk, dirs[i / BENCH_FILES_PER_DIR], files[i]) != 0;
+        timer_add(&t, now_ns() - t0, failed);
+    }
+    timer_finish(&t, results, block_size, "delete", "vazia", 0);
+
+    free(order);
+    free(files);
+    free(dirs);
+    image_close(&img);
+    return 0;
+}
+
+/* ====================== */
+/* Dados                  */
+/* ====================== */
+
+// Arquivo de MAX_BLOCKS_PER_INODE blocos usado nos testes de dados
+typedef struct {
+    uint32_t inode_num;
+    Inode inode;
+} BenchFile;
+
+// Lê ou grava count blocos do arquivo a partir de first, em um lote.
+// Retorna 0 ou -1 se algum pedido falhar
+static int file_io(Disk *disk, BenchFile *f, int op, uint32_t first, uint32_t count, uint8_t *buf) {
+    DiskIoReq reqs[MAX_BLOCKS_PER_INODE];
+    for (uint32_t i = 0; i < count; i++) {
+        reqs[i] = (DiskIoReq){op, buf + (size_t)i * disk->block_size, disk->block_size,
+                              disk_block_offset(disk, f->inode.blocks[first + i]), 0, 0};
+        disk_io_submit(disk, &reqs[i]);
+    }
+    disk_io_wait(disk);
+    for (uint32_t i = 0; i < count; i++) {
+        if (reqs[i].result != (ssize_t)reqs[i].len) return -1;
+    }
+    return 0;
+}
+
+// Escrita e leitura sequenciais (arquivo inteiro) e aleatórias (um bloco)
+static int bench_data(uint32_t block_size, uint32_t ops, unsigned int seed, BenchResults *results) {
+    BenchImage img;
+    if (image_open(&img, block_size) != 0) return -1;
+    Disk *disk = img.disk;
+
+    // Metade da imagem em arquivos cheios
+    uint32_t file_bytes = MAX_BLOCKS_PER_INODE * block_size;
+    uint32_t num_files = (uint32_t)((uint64_t)BENCH_DISK_MB * 1024 * 1024 / 2 / file_bytes);
+    if (num_files > ops) num_files = ops;
+    if (num_files == 0) num_files = 1;
+    BenchFile *files = calloc(num_files, sizeof(BenchFile));
+    uint8_t *buf = disk_buf_get(disk);
+    for (uint32_t i = 0; i < file_bytes; i++) buf[i] = (uint8_t)(i * 31 + 7);
+
+    BenchTimer t;
+    timer_init(&t, num_files);
+    uint32_t created = 0;
+    for (uint32_t i = 0; i < num_files; i++) {
+        BenchFile *f = &files[i];
+        f->inode_num = inode_alloc(disk);
+        if (f->inode_num == (uint32_t)-1) break;
+        memset(&f->inode, 0, sizeof(Inode));
+        f->inode.mode = 0100644;
+        f->inode.size = file_bytes;
+        if (inode_alloc_blocks(disk, &f->inode, 0, MAX_BLOCKS_PER_INODE) != 0) {
+            inode_bitmap_set(disk, f->inode_num, 0);
+            break;
+        }
+        uint64_t t0 = now_ns();
+        int failed = inode_write_blocks(disk, &f->inode, 0, MAX_BLOCKS_PER_INODE, buf, file_bytes) != 0;
+        timer_add(&t, now_ns() - t0, failed);
+        inode_save(disk, f->inode_num, &f->inode);
+        created++;
+    }
+    timer_finish(&t, results, block_size, "seq_write", "vazia", (uint64_t)created * file_bytes);
+
+    timer_init(&t, created);
+    for (uint32_t i = 0; i < created; i++) {
+        uint64_t t0 = now_ns();
+        int failed = file_io(disk, &files[i], DISK_IO_READ, 0, MAX_BLOCKS_PER_INODE, buf) != 0;
+        timer_add(&t, now_ns() - t0, failed);
+    }
+    timer_finish(&t, results, block_size, "seq_read", "vazia", (uint64_t)created * file_bytes);
+
+    if (created > 0) {
+        timer_init(&t, ops);
+        for (uint32_t k = 0; k < ops; k++) {
+            BenchFile *f = &files[rand_r(&seed) % created];
+            uint32_t b = rand_r(&seed) % MAX_BLOCKS_PER_INODE;
+            uint64_t t0 = now_ns();
+            int failed = file_io(disk, f, DISK_IO_WRITE, b, 1, buf) != 0;
+            timer_add(&t, now_ns() - t0, failed);
+        }
+        timer_finish(&t, results, block_size, "rand_write", "vazia", (uint64_t)ops * block_size);
+
+        timer_init(&t, ops);
+        for (uint32_t k = 0; k < ops; k++) {
+            BenchFile *f = &files[rand_r(&seed) % created];
+            uint32_t b = rand_r(&seed) % MAX_BLOCKS_PER_INODE;
+            uint64_t t0 = now_ns();
+            int failed = file_io(disk, f, DISK_IO_READ, b, 1, buf) != 0;
+            timer_add(&t, now_ns() - t0, failed);
+        }
+        timer_finish(&t, results, block_size, "rand_read", "vazia", (uint64_t)ops * block_size);
+    }
+
+    disk_buf_put(disk, buf);
+    free(files);
+    image_close(&img);
+    return 0;
+}
+
+/* ====================== */
+/* Alocação               */
+/* ====================== */
+
+// Mede inode_alloc_blocks com criação e remoção intercaladas. Na imagem
+// fragmentada, ela é antes preenchida até BENCH_FILL_PERCENT e metade dos
+// arquivos é removida ao acaso
+static int bench_alloc(uint32_t block_size, uint32_t ops, unsigned int seed, int fragmented,
+                       BenchResults *results) {
+    BenchImage img;
+    if (image_open(&img, block_size) != 0) return -1;
+    Disk *disk = img.disk;
+
+    uint32_t data_blocks = (uint32_t)(disk->size / block_size) - disk->sb->data_start_block;
+    uint32_t capacity = data_blocks + ops;
+    Inode *live = malloc(capacity * sizeof(Inode));
+    uint32_t num_live = 0;
+
+    if (fragmented) {
+        uint32_t target = (uint32_t)((uint64_t)data_blocks * BENCH_FILL_PERCENT / 100);
+        uint32_t used = 0;
+        while (used < target) {
+            Inode *f = &live[num_live];
+            memset(f, 0, sizeof(Inode));
+            uint32_t want = 1 + rand_r(&seed) % MAX_BLOCKS_PER_INODE;
+            if (inode_alloc_blocks(disk, f, 0, want) != 0) break;
+            used += want;
+            num_live++;
+        }
+        for (uint32_t i = 0; i < num_live;) {
+            if (rand_r(&seed) % 2) {
+                for (uint32_t k = 0; k < MAX_BLOCKS_PER_INODE; k++) {
+                    if (live[i].blocks[k] != 0) bitmap_set(disk, live[i].blocks[k], 0);
+                }
+                live[i] = live[--num_live];
+            } else {
+                i++;
+            }
+        }
+    }
+
+    BenchTimer t;
+    timer_init(&t, ops);
+    uint32_t keep = num_live + ops / 2;
+    for (uint32_t op = 0; op < ops; op++) {
+        Inode *f = &live[num_live];
+        memset(f, 0, sizeof(Inode));
+        uint32_t want = 1 + rand_r(&seed) % MAX_BLOCKS_PER_INODE;
+        uint64_t t0 = now_ns();
+        int failed = inode_alloc_blocks(disk, f, 0, want) != 0;
+        timer_add(&t, now_ns() - t0, failed);
+        if (!failed) num_live++;
+
+        // Remoções mantêm a ocupação estável (e ao menos 10% da imagem livre)
+        int full = disk->sb->free_blocks < data_blocks / 10;
+        if ((num_live > keep || full || failed) && num_live > 0) {
+            uint32_t victim = rand_r(&seed) % num_live;
+            for (uint32_t k = 0; k < MAX_BLOCKS_PER_INODE; k++) {
+                if (live[victim].blocks[k] != 0) bitmap_set(disk, live[victim].blocks[k], 0);
+            }
+            live[victim] = live[--num_live];
+        }
+    }
+    timer_finish(&t, results, block_size, "alloc", fragmented ? "fragmentada" : "vazia", 0);
+
+    free(live);
+    image_close(&img);
+    return 0;
+}
+
+/* ====================== */
+/* Saída                  */
+/* ====================== */
+
+static void print_csv(FILE *out, const BenchResults *results) {
+    fprintf(out, "block_size,benchmark,image,ops,errors,seconds,ops_per_sec,mb_per_sec,avg_ns,p50_ns,p99_ns,max_ns\n");
+    for (uint32_t i = 0; i < results->count; i++) {
+        const BenchResult *r = &results->items[i];
+        double secs = r->seconds > 0 ? r->seconds : 1e-9;
+        fprintf(out, "%u,%s,%s,%u,%u,%.6f,%.1f,%.2f,%.0f,%llu,%llu,%llu\n",
+                r->block_size, r->name, r->image, r->ops, r->errors, r->seconds, r->ops / secs,
+                r->bytes / secs / (1024.0 * 1024.0), r->avg_ns,
+                (unsigned long long)r->p50_ns, (unsigned long long)r->p99_ns, (unsigned long long)r->max_ns);
+    }
+}
+
+static void print_json(FILE *out, const BenchResults *results, uint32_t ops, unsigned int seed) {
+    fprintf(out, "{\n  \"ops\": %u,\n  \"seed\": %u,\n  \"results\": [\n", ops, seed);
+    for (uint32_t i = 0; i < results->count; i++) {
+        const BenchResult *r = &results->items[i];
+        double secs = r->seconds > 0 ? r->seconds : 1e-9;
+        fprintf(out, "    {\"block_size\": %u, \"benchmark\": \"%s\", \"image\": \"%s\", \"ops\": %u, "
+                "\"errors\": %u, \"seconds\": %.6f, \"ops_per_sec\": %.1f, \"mb_per_sec\": %.2f, \"avg_ns\": %.0f, "
+                "\"p50_ns\": %llu, \"p99_ns\": %llu, \"max_ns\": %llu}%s\n",
+                r->block_size, r->name, r->image, r->ops, r->errors, r->seconds, r->ops / secs,
+                r->bytes / secs / (1024.0 * 1024.0), r->avg_ns,
+                (unsigned long long)r->p50_ns, (unsigned long long)r->p99_ns, (unsigned long long)r->max_ns,
+                i + 1 < results->count ? "," : "");
+    }
+    fprintf(out, "  ]\n}\n");
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr, "Uso: %s [-f csv|json] [-o arquivo] [-n operacoes] [-b tamanho_bloco] [-s semente]\n", prog);
+    fprintf(stderr, "  Sem -b, roda com blocos de 512, 1024, 2048, 4096 e 8192 bytes\n");
+}
+
+int bench_main(int argc, char **argv) {
+    const char *format = "csv";
+    const char *output = NULL;
+    uint32_t ops = BENCH_OPS_DEFAULT;
+    uint32_t only_block = 0;
+    unsigned int seed = 1;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "f:o:n:b:s:h")) != -1) {
+        switch (opt) {
+            case 'f': format = optarg; break;
+            case 'o': output = optarg; break;
+            case 'n': ops = (uint32_t)atoi(optarg); break;
+            case 'b': only_block = (uint32_t)atoi(optarg); break;
+            case 's': seed = (unsigned int)atoi(optarg); break;
+            default:
+                usage(argv[0]);
+                return opt == 'h' ? 0 : 1;
+        }
+    }
+    if ((strcmp(format, "csv") != 0 && strcmp(format, "json") != 0) || ops == 0 ||
+        (only_block && (only_block < 512 || only_block > 8192 || (only_block & (only_block - 1)) != 0))) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    // As mensagens [INFO] das operações vão para stdout: os resultados saem
+    // por uma cópia do descritor original e stdout é descartado durante os testes
+    FILE *out = output ? fopen(output, "w") : fdopen(dup(STDOUT_FILENO), "w");
+    if (!out) {
+        fprintf(stderr, "[ERRO] Não foi possível abrir a saída %s\n", output ? output : "padrão");
+        return 1;
+    }
+    fflush(stdout);
+    if (!freopen("/dev/null", "w", stdout)) {
+        fprintf(stderr, "[ERRO] Não foi possível redirecionar stdout\n");
+        return 1;
+    }
+
+    // Conteúdo dos arquivos criados nos testes de metadados (sem zeros: não vira buraco)
+    FILE *payload = fopen(BENCH_PAYLOAD_FILE, "w");
+    if (!payload) {
+        fprintf(stderr, "[ERRO] Não foi possível criar %s\n", BENCH_PAYLOAD_FILE);
+        return 1;
+    }
+    for (int i = 0; i < BENCH_PAYLOAD_SIZE; i++) fputc('a' + i % 26, payload);
+    fclose(payload);
+
+    BenchResults results = {NULL, 0, 0};
+    int failed = 0;
+    for (uint32_t b = 0; b < BENCH_BLOCK_SIZES; b++) {
+        uint32_t bs = block_sizes[b];
+        if (only_block && bs != only_block) continue;
+        fprintf(stderr, "[INFO] Bloco de %u bytes...\n", bs);
+        if (bench_metadata(bs, ops, seed, &results) != 0 ||
+            bench_data(bs, ops, seed, &results) != 0 ||
+            bench_alloc(bs, ops, seed, 0, &results) != 0 ||
+            bench_alloc(bs, ops, seed, 1, &results) != 0) {
+            fprintf(stderr, "[ERRO] Falha ao preparar a imagem com bloco de %u bytes\n", bs);
+            failed = 1;
+        }
+    }
+    unlink(BENCH_PAYLOAD_FILE);
+
+    if (strcmp(format, "json") == 0) print_json(out, &results, ops, seed);
+    else print_csv(out, &results);
+    fclose(out);
+    free(results.items);
+    return failed;
+}
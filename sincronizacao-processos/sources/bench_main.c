@@ -0,0 +1,6 @@
+// Binário fs_bench (make bench): o mesmo que "fs_simulator bench"
+#include "bench.h"
+
+int main(int argc, char **argv) {
+    return bench_main(argc, argv);
+}
@@ -1,33 +1,50 @@
 #include "bitmap.h"
 #include "superblock.h"
+#include "alloc.h"
+#include "stats.h"
+#include "snapshot.h"
 #include <unistd.h>
 #include <stdlib.h>
 
 #define BITMAP_START_BLOCK 1
 
 void bitmap_init(Disk *disk, Superblock *sb) {
-    // Calcula o tamanho necessário para o bitmap
-    uint32_t bitmap_size = disk->size / disk->block_size / 8;
-    uint8_t *bitmap = calloc(bitmap_size, 1);
-    
-    // Marca blocos obrigatórios como USADOS (1):
-    bitmap_set(disk, 0, 1);  // Superbloco
-    bitmap_set(disk, 1, 1);  // Bitmap itself
+    // Calcula o tamanho necessário para o bitmap (1 bit por bloco)
+    uint32_t total_blocks = (uint32_t)(disk->size / disk->block_size);
+    uint64_t bitmap_size = ((uint64_t)total_blocks + 7) / 8;
+
+    // Bitmap inteiro zerado sem gravar byte a byte (importa em discos de GB/TB)
+    disk_zero(disk, disk_block_offset(disk, sb->bitmap_start_block), bitmap_size);
+
+    // Marca blocos de metadados como USADOS (1): superbloco, bitmaps e tabela de i-nodes
+    uint32_t meta_size = (sb->data_start_block + 7) / 8;
+    uint8_t *bitmap = calloc(meta_size, 1);
+    for (uint32_t b = 0; b < sb->data_start_block; b++) {
+        bitmap[b / 8] |= 1 << (b % 8);
+    }
     
-    // Escreve o bitmap no disco
-    lseek(disk->fd, sb->bitmap_start_block * disk->block_size, SEEK_SET);
-    write(disk->fd, bitmap, bitmap_size);
+    // Escreve só a parte do bitmap que cobre os metadados
+    stats_pwrite(disk->fd, bitmap, meta_size, disk_block_offset(disk, sb->bitmap_start_block));
     free(bitmap);
+
+    // Bitmap de i-nodes: todos livres
+    disk_zero(disk, disk_block_offset(disk, sb->inode_bitmap_start), (sb->inode_count + 7) / 8);
 }
 
-void bitmap_set(Disk *disk, uint32_t block_num, int used) {
-    uint32_t byte_pos = block_num / 8;
-    uint8_t bit_mask = 1 << (block_num % 8);
+// Altera um bit de um bitmap no disco e retorna o valor anterior
+static int bitmap_update(Disk *disk, uint32_t start_block, uint32_t bit, int used) {
+    uint32_t byte_pos = bit / 8;
+    uint8_t bit_mask = 1 << (bit % 8);
     uint8_t byte;
 
+    off_t bitmap_offset = disk_block_offset(disk, start_block);
+    snapshot_cow_meta(disk, start_block + byte_pos / disk->block_size, 1);
+
     // Lê o byte atual do bitmap no disco
-    lseek(disk->fd, disk->block_size + byte_pos, SEEK_SET); // Corrigido: Começa no bloco 1 (bitmap)
-    read(disk->fd, &byte, 1);
+    stats_pread(disk->fd, &byte, 1, bitmap_offset + byte_pos);
+
+    int old = (byte & bit_mask) ? 1 : 0;
+    if (old == (used ? 1 : 0)) return old; // Nada muda
 
     // Modifica o bit correspondente
     if (used) {
@@ -37,25 +54,148 @@ void bitmap_set(Disk *disk, uint32_t block_num, int used) {
     }
 
     // Escreve o byte de volta no disco
-    lseek(disk->fd, disk->block_size + byte_pos, SEEK_SET);
-    write(disk->fd, &byte, 1);
+    stats_pwrite(disk->fd, &byte, 1, bitmap_offset + byte_pos);
+    return old;
+}
+
+void bitmap_set(Disk *disk, uint32_t block_num, int used) {
+    STATS_SCOPE(STATS_BITMAP_SET);
+    Superblock *sb = disk->sb;
+    Allocator *a = disk->alloc;
+    int old;
+
+    // Bloco retido por um snapshot: continua marcado até o snapshot ser removido
+    if (!used && snapshot_holds(disk, block_num)) return;
+
+    if (a) {
+        // Bitmap em memória: só grava o byte alterado e avisa a política
+        uint8_t *byte = &a->bitmap[block_num / 8];
+        uint8_t bit_mask = 1 << (block_num % 8);
+        old = (*byte & bit_mask) ? 1 : 0;
+        if (old == (used ? 1 : 0)) return;
+
+        if (used) *byte |= bit_mask;
+        else *byte &= ~bit_mask;
+        alloc_block_changed(a, block_num, used);
+        // Os snapshots copiam o bloco do bitmap (ainda sem a mudança no disco);
+        // a cópia reserva outro bloco, já vendo este como ocupado
+        snapshot_cow_meta(disk, sb->bitmap_start_block + block_num / 8 / disk->block_size, 1);
+        stats_pwrite(disk->fd, byte, 1, disk_block_offset(disk, sb->bitmap_start_block) + block_num / 8);
+    } else {
+        old = bitmap_update(disk, sb->bitmap_start_block, block_num, used);
+        if (old == (used ? 1 : 0)) return;
+    }
+
+    // Contador de blocos livres acompanha cada alocação/liberação
+    if (used) sb->free_blocks--;
+    else sb->free_blocks++;
+    sb->free_blocks_count = sb->free_blocks;
+    superblock_mark_dirty(disk);
+}
+
+void bitmap_set_range(Disk *disk, uint32_t start, uint32_t count, int used) {
+    STATS_SCOPE(STATS_BITMAP_SET_RANGE);
+    Superblock *sb = disk->sb;
+    Allocator *a = disk->alloc;
+    int uniform = (a != NULL);
+
+    // O caminho rápido exige que todos os blocos do trecho mudem de estado
+    for (uint32_t b = start; uniform && b < start + count; b++) {
+        if (((a->bitmap[b / 8] >> (b % 8)) & 1) == (used ? 1 : 0)) uniform = 0;
+        if (!used && snapshot_holds(disk, b)) uniform = 0;
+    }
+    if (!uniform) {
+        for (uint32_t i = 0; i < count; i++) bitmap_set(disk, start + i, used);
+        return;
+    }
+    if (count == 0) return;
+
+    // Altera os bits em memória e grava os bytes afetados de uma vez
+    for (uint32_t b = start; b < start + count; b++) {
+        if (used) a->bitmap[b / 8] |= 1 << (b % 8);
+        else a->bitmap[b / 8] &= ~(1 << (b % 8));
+    }
+    alloc_range_changed(a, start, count, used);
+    uint32_t first_byte = start / 8, last_byte = (start + count - 1) / 8;
+    snapshot_cow_meta(disk, sb->bitmap_start_block + first_byte / disk->block_size,
+                      last_byte / disk->block_size - first_byte / disk->block_size + 1);
+    stats_pwrite(disk->fd, &a->bitmap[first_byte], last_byte - first_byte + 1,
+                 disk_block_offset(disk, sb->bitmap_start_block) + first_byte);
+
+    if (used) sb->free_blocks -= count;
+    else sb->free_blocks += count;
+    sb->free_blocks_count = sb->free_blocks;
+    superblock_mark_dirty(disk);
 }
 
 int bitmap_get(Disk *disk, uint32_t block_num) {
+    STATS_SCOPE(STATS_BITMAP_GET);
     uint32_t byte_pos = block_num / 8;
     uint8_t bit_mask = 1 << (block_num % 8);
     uint8_t byte;
 
-    // CORREÇÃO: Precisa ler do bloco 1 (bitmap), não da posição 0
-    lseek(disk->fd, disk->block_size + byte_pos, SEEK_SET);
-    read(disk->fd, &byte, 1);
+    if (disk->alloc) return (disk->alloc->bitmap[byte_pos] & bit_mask) ? 1 : 0;
+
+    // Lê do bloco onde inicia o bitmap (registrado no superbloco)
+    stats_pread(disk->fd, &byte, 1, disk_block_offset(disk, disk->sb->bitmap_start_block) + byte_pos);
     return (byte & bit_mask) ? 1 : 0;
 }
 
 uint32_t bitmap_find_free_block(Disk *disk) {
-    uint32_t total_blocks = disk->size / disk->block_size;
-    for (uint32_t i = 0; i < total_blocks; i++) {
+    STATS_SCOPE(STATS_BITMAP_FIND_FREE_BLOCK);
+    // Disco cheio: falha imediatamente, sem varrer o bitmap
+    if (disk->sb->free_blocks == 0) return (uint32_t)-1;
+    if (disk->alloc) return disk->alloc->ops->find(disk->alloc, 1);
+
+    uint32_t total_blocks = (uint32_t)(disk->size / disk->block_size);
+    for (uint32_t i = disk->sb->data_start_block; i < total_blocks; i++) {
         if (!bitmap_get(disk, i)) return i;
     }
     return (uint32_t)-1; // Retorna valor inválido se nenhum bloco livre for encontrado
-}
\ No newline at end of file
+}
+
+uint32_t bitmap_find_free_run(Disk *disk, uint32_t count) {
+    STATS_SCOPE(STATS_BITMAP_FIND_FREE_RUN);
+    Superblock *sb = disk->sb;
+    if (count == 0 || sb->free_blocks < count) return (uint32_t)-1;
+    if (disk->alloc) return disk->alloc->ops->find(disk->alloc, count);
+
+    // Uma leitura do bitmap inteiro e busca first-fit por count bits zerados seguidos
+    uint32_t total_blocks = (uint32_t)(disk->size / disk->block_size);
+    uint32_t bitmap_size = (total_blocks + 7) / 8;
+    uint8_t *bitmap = malloc(bitmap_size);
+    stats_pread(disk->fd, bitmap, bitmap_size, disk_block_offset(disk, sb->bitmap_start_block));
+
+    uint32_t run_start = 0, run_len = 0, found = (uint32_t)-1;
+    for (uint32_t i = sb->data_start_block; i < total_blocks; i++) {
+        if (bitmap[i / 8] & (1 << (i % 8))) {
+            run_len = 0;
+            continue;
+        }
+        if (run_len++ == 0) run_start = i;
+        if (run_len == count) {
+            found = run_start;
+            break;
+        }
+    }
+    free(bitmap);
+    return found;
+}
+
+void inode_bitmap_set(Disk *disk, uint32_t inode_num, int used) {
+    STATS_SCOPE(STATS_INODE_BITMAP_SET);
+    Superblock *sb = disk->sb;
+    int old = bitmap_update(disk, sb->inode_bitmap_start, inode_num, used);
+    if (old == (used ? 1 : 0)) return;
+
+    if (used) sb->free_inodes--;
+    else sb->free_inodes++;
+    superblock_mark_dirty(disk);
+}
+
+int inode_bitmap_get(Disk *disk, uint32_t inode_num) {
+    STATS_SCOPE(STATS_INODE_BITMAP_GET);
+    uint8_t byte;
+    stats_pread(disk->fd, &byte, 1, disk_block_offset(disk, disk->sb->inode_bitmap_start) + inode_num / 8);
+    return (byte >> (inode_num % 8)) & 1;
+}
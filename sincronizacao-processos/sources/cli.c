@@ -0,0 +1,343 @@
+#include "cli.h"
+#include "disk.h"
+#include "superblock.h"
+#include "alloc.h"
+#include "diskio.h"
+#include "icache.h"
+#include "fsck.h"
+#include "stats.h"
+#include "script.h"
+#include "bench.h"
+#include "command.h"
+#include "server.h"
+#include "rpc.h"
+#include "snapshot.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// Opções comuns aos comandos (0 ou -1 = padrão do comando)
+typedef struct {
+    const char *image;
+    uint32_t block_size;
+    uint64_t disk_mb;
+    int engine;
+    int policy;
+    int repair;
+    int quiet;          // -q: sem eco das linhas; -qq: modo batch
+    const char *socket; // serve/rpc
+    uint32_t snapshot;  // mount: snapshot aberto só para leitura (0 = imagem viva)
+} CliOptions;
+
+static void usage(void) {
+    fprintf(stderr,
+        "Uso: fs_simulator <comando> [opções]\n"
+        "  mkfs  [-i imagem] [-b bloco] [-s MB] [-a politica]  Formata uma imagem nova\n"
+        "  mount [-i imagem] [opções] [comandos]              Executa comandos (arquivo ou stdin) numa imagem existente\n"
+        "  run   [opções] script                              Cria a imagem pela primeira linha do script e o executa\n"
+        "  fsck  [-i imagem] [-r]                             Verifica a imagem (-r corrige)\n"
+        "  serve [-i imagem] [-S socket] [opções]             Serve a imagem pelo protocolo binário (socket Unix)\n"
+        "  rpc   [-S socket] operação args                    Cliente: lookup dir nome | create dir nome [texto] |\n"
+        "                                                     mkdir dir nome | read inode [offset] [bytes] |\n"
+        "                                                     write dir inode offset texto | readdir dir | stat inode\n"
+        "  bench [opções do benchmark]                        Microbenchmarks (fs_simulator bench -h)\n"
+        "Opções:\n"
+        "  -i imagem   Arquivo da imagem (padrão: " CLI_DEFAULT_IMAGE "; run: " CLI_SCRIPT_IMAGE ")\n"
+        "  -b bytes    Tamanho do bloco (padrão: %d; run: primeira linha do script)\n"
+        "  -s MB       Tamanho do disco (padrão: 10; run: primeira linha do script)\n"
+        "  -c n        I-nodes sem referência mantidos no cache (padrão: %d)\n"
+        "  -e motor    Motor de E/S: sync, threads ou uring (padrão: uring)\n"
+        "  -a politica Política de alocação: first, next, best ou buddy (padrão: a da imagem)\n"
+        "  -S socket   serve/rpc: socket Unix (padrão: " RPC_SOCKET_DEFAULT ")\n"
+        "  -r          fsck: corrige os problemas encontrados\n"
+        "  -n id       mount: abre o snapshot id só para leitura (veja snapshot_list)\n"
+        "  -q          mount/run: não ecoa as linhas; -qq descarta a saída dos comandos\n"
+        "              (falhas vão para stderr com o número da linha)\n"
+        "Sem comando, pergunta o modo (interativo ou script).\n",
+        BLOCK_SIZE_DEFAULT, ICACHE_MAX_UNUSED);
+}
+
+// Lê as opções de argv (argv[0] é o comando). Retorna o índice do primeiro
+// argumento posicional ou -1 se alguma opção for inválida
+static int parse_options(int argc, char **argv, CliOptions *o) {
+    memset(o, 0, sizeof(CliOptions));
+    o->engine = -1;
+    o->policy = -1;
+
+    int opt;
+    optind = 1;
+    while ((opt = getopt(argc, argv, "i:b:s:c:e:a:S:n:rqh")) != -1) {
+        switch (opt) {
+            case 'i': o->image = optarg; break;
+            case 'b': o->block_size = (uint32_t)atoi(optarg); break;
+            case 's': o->disk_mb = (uint64_t)atoll(optarg); break;
+            case 'c': icache_set_limit((uint32_t)atoi(optarg)); break;
+            case 'e':
+                o->engine = disk_io_engine_from_name(optarg);
+                if (o->engine < 0) {
+                    fprintf(stderr, "[ERRO] Motor de E/S desconhecido: %s\n", optarg);
+                    return -1;
+                }
+                break;
+            case 'a':
+                o->policy = alloc_policy_from_name(optarg);
+                if (o->policy < 0) {
+                    fprintf(stderr, "[ERRO] Política de alocação desconhecida: %s\n", optarg);
+                    return -1;
+                }
+                break;
+            case 'r': o->repair = 1; break;
+            case 'q': o->quiet++; break;
+            case 'S': o->socket = optarg; break;
+            case 'n':
+                o->snapshot = (uint32_t)atoi(optarg);
+                if (o->snapshot == 0) {
+                    fprintf(stderr, "[ERRO] Snapshot inválido: %s\n", optarg);
+                    return -1;
+                }
+                break;
+            default: return -1;
+        }
+    }
+    return optind;
+}
+
+// Abre uma imagem formatada com a política e o motor de E/S pedidos
+static CmdOutput cli_output(const CliOptions *o) {
+    if (o->quiet >= 2) return CMD_OUTPUT_BATCH;
+    return o->quiet ? CMD_OUTPUT_QUIET : CMD_OUTPUT_NORMAL;
+}
+
+static Disk *cli_mount(const CliOptions *o) {
+    const char *image = o->image ? o->image : CLI_DEFAULT_IMAGE;
+    if (o->snapshot) {
+        // Snapshot: sem alocador, nada é gravado
+        Disk *disk = snapshot_open(image, o->snapshot);
+        if (!disk) {
+            fprintf(stderr, "[ERRO] %s não tem o snapshot %u (veja snapshot_list)\n", image, o->snapshot);
+            return NULL;
+        }
+        disk_io_init(disk, o->engine >= 0 ? (DiskIoEngine)o->engine : DISK_IO_URING, DISK_IO_DEPTH_DEFAULT);
+        return disk;
+    }
+    Disk *disk = superblock_open(image);
+    if (!disk) {
+        fprintf(stderr, "[ERRO] %s não existe ou não é uma imagem válida (use mkfs)\n", image);
+        return NULL;
+    }
+    alloc_attach(disk, o->policy >= 0 ? (AllocPolicy)o->policy : (AllocPolicy)disk->sb->alloc_policy);
+    disk_io_init(disk, o->engine >= 0 ? (DiskIoEngine)o->engine : DISK_IO_URING, DISK_IO_DEPTH_DEFAULT);
+    return disk;
+}
+
+static void cli_unmount(Disk *disk) {
+    Superblock *sb = disk->sb; // Alocado por superblock_load
+    disk_free(disk);
+    free(sb);
+}
+
+static int cmd_mkfs(const CliOptions *o) {
+    const char *image = o->image ? o->image : CLI_DEFAULT_IMAGE;
+    uint32_t block_size = o->block_size ? o->block_size : BLOCK_SIZE_DEFAULT;
+    uint64_t disk_mb = o->disk_mb ? o->disk_mb : 10;
+
+    Superblock sb;
+    Disk *disk = script_format(image, disk_mb * 1024 * 1024, block_size,
+                               o->policy >= 0 ? o->policy : ALLOC_FIRST_FIT, &sb);
+    if (!disk) return 1;
+    FsStat st;
+    superblock_statfs(disk, &st);
+    printf("[INFO] %s: %u blocos de %u bytes (%u para dados), %u i-nodes, política %s\n", image,
+           st.total_blocks, st.block_size, st.data_blocks, st.total_inodes, alloc_policy_name(sb.alloc_policy));
+    disk_free(disk);
+    return 0;
+}
+
+static int cmd_mount(const CliOptions *o, const char *commands) {
+    FILE *in = stdin;
+    if (commands && !(in = fopen(commands, "r"))) {
+        fprintf(stderr, "[ERRO] Não foi possível abrir %s\n", commands);
+        return 1;
+    }
+    Disk *disk = cli_mount(o);
+    if (!disk) {
+        if (in != stdin) fclose(in);
+        return 1;
+    }
+    printf("[INFO] %s montada: bloco de %u bytes, motor de E/S %s\n", o->image ? o->image : CLI_DEFAULT_IMAGE,
+           disk->block_size, disk_io_engine_name(disk_io_engine(disk)));
+    if (o->snapshot) printf("[INFO] Snapshot %u, somente leitura\n", o->snapshot);
+    script_run(disk, in, cli_output(o), 0);
+    if (in != stdin) fclose(in);
+    if (stats_write_json(disk, STATS_JSON_FILE) == 0) {
+        printf("[INFO] Estatísticas gravadas em %s\n", STATS_JSON_FILE);
+    }
+    cli_unmount(disk);
+    return 0;
+}
+
+static int cmd_run(const CliOptions *o, const char *script) {
+    ScriptOptions opts = {o->image ? o->image : CLI_SCRIPT_IMAGE, o->block_size, o->disk_mb, o->engine, o->policy,
+                         cli_output(o)};
+    return script_execute(script, &opts) == 0 ? 0 : 1;
+}
+
+// Códigos de saída como os do e2fsck: 0 sem problemas, 1 todos corrigidos,
+// 4 problemas restantes, 8 erro de operação
+static int cmd_fsck(const CliOptions *o) {
+    Disk *disk = cli_mount(o);
+    if (!disk) return 8;
+    FsckReport report;
+    int problems = fsck_run(disk, o->repair, 0, &report);
+    if (problems >= 0) fsck_print_report(&report);
+    cli_unmount(disk);
+    if (problems < 0) return 8;
+    if (problems == 0) return 0;
+    return (o->repair && report.repaired >= (uint32_t)problems) ? 1 : 4;
+}
+
+static int cmd_serve(const CliOptions *o) {
+    Disk *disk = cli_mount(o);
+    if (!disk) return 1;
+    ServerReport report;
+    int result = server_run(disk, o->socket ? o->socket : RPC_SOCKET_DEFAULT, &report);
+    if (result == 0) server_print_report(&report);
+    if (stats_write_json(disk, STATS_JSON_FILE) == 0) {
+        printf("[INFO] Estatísticas gravadas em %s\n", STATS_JSON_FILE);
+    }
+    cli_unmount(disk);
+    return result == 0 ? 0 : 1;
+}
+
+// Cliente de linha de comando do modo servidor (uma operação por execução)
+static int cmd_rpc(const CliOptions *o, int argc, char **argv) {
+    static uint8_t body[RPC_MAX_PAYLOAD];
+    if (argc < 2) {
+        fprintf(stderr, "[ERRO] Sintaxe: fs_simulator rpc [-S socket] operação args\n");
+        return 1;
+    }
+    const char *path = o->socket ? o->socket : RPC_SOCKET_DEFAULT;
+    int fd = rpc_connect(path);
+    if (fd < 0) {
+        fprintf(stderr, "[ERRO] Não foi possível conectar a %s\n", path);
+        return 1;
+    }
+
+    RpcRequest req;
+    memset(&req, 0, sizeof(req));
+    req.id = 1;
+    uint32_t len = 0;
+    const char *op = argv[0];
+    if ((strcmp(op, "lookup") == 0 || strcmp(op, "create") == 0 || strcmp(op, "mkdir") == 0) && argc >= 3) {
+        req.op = strcmp(op, "lookup") == 0 ? RPC_LOOKUP : RPC_CREATE;
+        req.flags = strcmp(op, "mkdir") == 0 ? RPC_CREATE_DIR : 0;
+        req.dir = (uint32_t)atoi(argv[1]);
+        req.count = len = strlen(argv[2]);
+        memcpy(body, argv[2], len);
+        if (req.op == RPC_CREATE && argc > 3) {
+            size_t text = strlen(argv[3]);
+            memcpy(body + len, argv[3], text);
+            len += text;
+        }
+    } else if (strcmp(op, "read") == 0 && argc >= 2) {
+        req.op = RPC_READ;
+        req.inode = (uint32_t)atoi(argv[1]);
+        req.offset = (argc > 2) ? (uint32_t)atoi(argv[2]) : 0;
+        req.count = (argc > 3) ? (uint32_t)atoi(argv[3]) : 0;
+    } else if (strcmp(op, "write") == 0 && argc >= 5) {
+        req.op = RPC_WRITE;
+        req.dir = (uint32_t)atoi(argv[1]);
+        req.inode = (uint32_t)atoi(argv[2]);
+        req.offset = (uint32_t)atoi(argv[3]);
+        len = strlen(argv[4]);
+        memcpy(body, argv[4], len);
+    } else if (strcmp(op, "readdir") == 0 && argc >= 2) {
+        req.op = RPC_READDIR;
+        req.dir = (uint32_t)atoi(argv[1]);
+    } else if (strcmp(op, "stat") == 0 && argc >= 2) {
+        req.op = RPC_STAT;
+        req.inode = (uint32_t)atoi(argv[1]);
+    } else {
+        fprintf(stderr, "[ERRO] Operação ou argumentos inválidos: %s\n", op);
+        close(fd);
+        return 1;
+    }
+    req.len = len;
+
+    RpcResponse resp;
+    do {
+        if (rpc_call(fd, &req, body, &resp, body, sizeof(body)) != 0) {
+            fprintf(stderr, "[ERRO] Conexão encerrada pelo servidor\n");
+            close(fd);
+            return 1;
+        }
+        if (resp.status != RPC_OK) {
+            fprintf(stderr, "[ERRO] %s: %s\n", rpc_op_name(resp.op), rpc_status_name(resp.status));
+            close(fd);
+            return 1;
+        }
+        if (req.op == RPC_READ) {
+            fwrite(body, 1, resp.len, stdout);
+        } else if (req.op == RPC_READDIR) {
+            for (uint32_t pos = 0; pos + RPC_DIRENT_HEADER <= resp.len;) {
+                uint32_t inode;
+                memcpy(&inode, body + pos, sizeof(inode));
+                uint8_t name_len = body[pos + 4];
+                printf("  [%u] %.*s\n", inode, name_len, (const char *)body + pos + RPC_DIRENT_HEADER);
+                pos += RPC_DIRENT_HEADER + name_len;
+            }
+            req.offset = resp.inode; // Continua de onde parou
+        } else if (req.op == RPC_STAT) {
+            RpcStat st;
+            memcpy(&st, body, sizeof(st));
+            printf("Inode: %u\nModo: %o\nTamanho: %u bytes\nBlocos: %u\n", st.inode, st.mode, st.size, st.blocks);
+        } else {
+            printf("%u\n", resp.inode);
+        }
+    } while (req.op == RPC_READDIR && resp.inode != 0);
+    close(fd);
+    return 0;
+}
+
+int cli_main(int argc, char **argv) {
+    if (argc < 2 || strcmp(argv[1], "-h") == 0 || strcmp(argv[1], "help") == 0) {
+        usage();
+        return argc < 2 ? 1 : 0;
+    }
+    const char *cmd = argv[1];
+
+    // bench tem as próprias opções
+    if (strcmp(cmd, "bench") == 0) {
+        optind = 1;
+        return bench_main(argc - 1, argv + 1);
+    }
+
+    CliOptions o;
+    int first = parse_options(argc - 1, argv + 1, &o);
+    if (first < 0) {
+        usage();
+        return 1;
+    }
+    const char *positional = (first < argc - 1) ? argv[1 + first] : NULL;
+    if (o.snapshot && strcmp(cmd, "mount") != 0) {
+        fprintf(stderr, "[ERRO] -n só vale para mount\n");
+        return 1;
+    }
+
+    if (strcmp(cmd, "mkfs") == 0) return cmd_mkfs(&o);
+    if (strcmp(cmd, "mount") == 0) return cmd_mount(&o, positional);
+    if (strcmp(cmd, "fsck") == 0) return cmd_fsck(&o);
+    if (strcmp(cmd, "serve") == 0) return cmd_serve(&o);
+    if (strcmp(cmd, "rpc") == 0) return cmd_rpc(&o, argc - 1 - first, argv + 1 + first);
+    if (strcmp(cmd, "run") == 0) {
+        if (!positional) {
+            fprintf(stderr, "[ERRO] Sintaxe: fs_simulator run [opções] script\n");
+            return 1;
+        }
+        return cmd_run(&o, positional);
+    }
+    fprintf(stderr, "[ERRO] Comando desconhecido: %s\n", cmd);
+    usage();
+    return 1;
+}
@@ -0,0 +1,1161 @@
+#include "command.h"
+#include "superblock.h"
+#include "inode.h"
+#include "bitmap.h"
+#include "dir.h"
+#include "fsck.h"
+#include "defrag.h"
+#include "alloc.h"
+#include "import.h"
+#include "export.h"
+#include "diskio.h"
+#include "icache.h"
+#include "walk.h"
+#include "stats.h"
+#include "trace.h"
+#include "script.h"
+#include "snapshot.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <fnmatch.h>
+#include <pthread.h>
+
+typedef int (*CmdHandler)(CmdSession *s, int argc, char **argv);
+
+// Entrada da tabela de comandos
+typedef struct {
+    const char *name;
+    CmdHandler fn;
+    int min_args;           // Contando o nome do comando
+    int flags;
+    const char *usage;
+} Command;
+
+#define CMD_WRITES 1            // Altera a imagem (recusado num snapshot só para leitura)
+
+static const char *output_names[CMD_OUTPUT_COUNT] = {
+    [CMD_OUTPUT_NORMAL] = "normal",
+    [CMD_OUTPUT_QUIET] = "quiet",
+    [CMD_OUTPUT_BATCH] = "batch",
+};
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// Totais de cada diretório, depois dos seus subdiretórios
+static void du_print_entry(const WalkEntry *e, void *arg) {
+    (void)arg;
+    if (!e->is_dir) return;
+    printf("%10llu bytes %8llu blocos  %s\n", (unsigned long long)e->total_bytes,
+           (unsigned long long)e->total_blocks, e->path);
+}
+
+// Critério do comando find
+typedef struct {
+    int kind;          // 0 nome, 1 tamanho, 2 modificação
+    const char *pattern;
+    int cmp;           // -1 menor, 0 igual, 1 maior
+    long long value;   // Bytes ou minutos
+    time_t now;
+    uint32_t matches;
+} FindQuery;
+
+static void find_match_entry(const WalkEntry *e, void *arg) {
+    FindQuery *q = arg;
+    if (e->depth == 0) return;
+    int match;
+    if (q->kind == 0) {
+        match = fnmatch(q->pattern, e->name, 0) == 0;
+    } else {
+        long long v = (q->kind == 1) ? (long long)e->inode->size
+                                     : (long long)(q->now - e->inode->modified_at) / 60;
+        match = (q->cmp < 0) ? v < q->value : (q->cmp > 0) ? v > q->value : v == q->value;
+    }
+    if (match) {
+        printf("  [%u] %s%s\n", e->inode_num, e->path, e->is_dir ? "/" : "");
+        q->matches++;
+    }
+}
+
+/* ====================== */
+/* Comandos               */
+/* ====================== */
+
+// info [inode]
+static int cmd_info(CmdSession *s, int argc, char **argv) {
+    Disk *disk = s->disk;
+    uint32_t inode_num = (argc > 1) ? (uint32_t)atoi(argv[1]) : s->cwd;
+    Inode *inode = inode_load(disk, inode_num);
+    if (!inode) {
+        printf("[ERRO] Inode %u não encontrado.\n", inode_num);
+        return -1;
+    }
+
+    if ((inode->mode & 040000) == 040000) {
+        // Diretório
+        dir_list_detailed(disk, inode_num);
+    } else {
+        // Arquivo
+        printf("Inode: %u\n", inode_num);
+        printf("Tamanho: %u bytes\n", inode->size);
+        printf("Links: %u\n", inode->nlink ? inode->nlink : 1);
+        printf("Criado em: %s", ctime(&inode->created_at));
+        printf("Modificado em: %s", ctime(&inode->modified_at));
+    }
+    inode_put(inode);
+    return 0;
+}
+
+// create_file [diretorio] [arquivo_host] [nome_fs]
+static int cmd_create_file(CmdSession *s, int argc, char **argv) {
+    Disk *disk = s->disk;
+    (void)argc;
+    uint32_t dir_inode = atoi(argv[1]);
+    uint64_t t = trace_begin();
+    int ok = file_create(disk, dir_inode, argv[2], argv[3]) == 0;
+    trace_end_create(disk, t, TRACE_CREATE, dir_inode, 0, argv[3], ok);
+    if (ok) {
+        printf("Arquivo '%s' criado com sucesso no diretório %u.\n", argv[3], dir_inode);
+    } else {
+        printf("[ERRO] Falha ao criar arquivo '%s'\n", argv[3]);
+    }
+    return ok ? 0 : -1;
+}
+
+// list_dir [inode]
+static int cmd_list_dir(CmdSession *s, int argc, char **argv) {
+    Disk *disk = s->disk;
+    uint32_t dir_inode = (argc > 1) ? (uint32_t)atoi(argv[1]) : s->cwd;
+    uint64_t t = trace_begin();
+    int ok = dir_list(disk, dir_inode) == 0;
+    trace_end(t, TRACE_LIST, dir_inode, 0, 0, NULL, 0, ok);
+    if (!ok) {
+        printf("[ERRO] Falha ao listar conteúdo do diretório %u\n", dir_inode);
+    }
+    return ok ? 0 : -1;
+}
+
+// create_dir [diretorio_pai] [nome]
+static int cmd_create_dir(CmdSession *s, int argc, char **argv) {
+    Disk *disk = s->disk;
+    (void)argc;
+    uint32_t parent_inode = atoi(argv[1]);
+    uint64_t t = trace_begin();
+    int ok = dir_create(disk, parent_inode, argv[2]) == 0;
+    trace_end_create(disk, t, TRACE_MKDIR, parent_inode, 0, argv[2], ok);
+    if (ok) {
+        printf("Diretório '%s' criado com sucesso no diretório %u!\n", argv[2], parent_inode);
+    } else {
+        printf("[ERRO] Falha ao criar diretório '%s'\n", argv[2]);
+    }
+    return ok ? 0 : -1;
+}
+
+// rename_dir [diretorio_pai] [inode_dir] [novo_nome]
+static int cmd_rename_dir(CmdSession *s, int argc, char **argv) {
+    Disk *disk = s->disk;
+    (void)argc;
+    uint32_t parent_inode = atoi(argv[1]);
+    uint32_t dir_inode = atoi(argv[2]);
+    uint64_t t = trace_begin();
+    int ok = dir_rename_entry(disk, parent_inode, dir_inode, argv[3]) == 0;
+    trace_end(t, TRACE_RENAME, parent_inode, dir_inode, 0, argv[3], 0, ok);
+    if (ok) {
+        printf("Diretório renomeado com sucesso!\n");
+    } else {
+        printf("[ERRO] Falha ao renomear diretório.\n");
+    }
+    return ok ? 0 : -1;
+}
+
+// delete_dir [diretorio_pai] [inode_dir]
+static int cmd_delete_dir(CmdSession *s, int argc, char **argv) {
+    Disk *disk = s->disk;
+    (void)argc;
+    uint32_t parent_inode = atoi(argv[1]);
+    uint32_t dir_inode = atoi(argv[2]);
+    uint64_t t = trace_begin();
+
+    // Remove entrada no diretório pai
+    if (dir_remove_entry(disk, parent_inode, dir_inode) != 0) {
+        trace_end(t, TRACE_RMDIR, parent_inode, dir_inode, 0, NULL, 0, 0);
+        printf("[ERRO] Falha ao remover entrada no diretório pai.\n");
+        return -1;
+    }
+
+    // Libera os blocos usados pelo diretório
+    Inode *inode_apagar = inode_load(disk, dir_inode);
+    if (!inode_apagar) {
+        printf("[ERRO] Falha ao carregar inode do diretório.\n");
+        return -1;
+    }
+    for (int i = 0; i < MAX_BLOCKS_PER_INODE; i++) {
+        if (inode_apagar->blocks[i] != 0 && inode_apagar->blocks[i] != (uint32_t)-1) {
+            bitmap_set(disk, inode_apagar->blocks[i], 0);
+        }
+    }
+    inode_put(inode_apagar);
+
+    // Libera o inode
+    inode_free(disk, dir_inode);
+    trace_end(t, TRACE_RMDIR, parent_inode, dir_inode, 0, NULL, 0, 1);
+    printf("Diretório apagado com sucesso.\n");
+    return 0;
+}
+
+// rename_file [diretorio] [inode_file] [novo_nome]
+static int cmd_rename_file(CmdSession *s, int argc, char **argv) {
+    Disk *disk = s->disk;
+    (void)argc;
+    uint32_t dir_inode = atoi(argv[1]);
+    uint32_t file_inode = atoi(argv[2]);
+    uint64_t t = trace_begin();
+    int ok = dir_rename_entry(disk, dir_inode, file_inode, argv[3]) == 0;
+    trace_end(t, TRACE_RENAME, dir_inode, file_inode, 0, argv[3], 0, ok);
+    if (ok) {
+        printf("Arquivo renomeado com sucesso!\n");
+    } else {
+        printf("[ERRO] Falha ao renomear arquivo.\n");
+    }
+    return ok ? 0 : -1;
+}
+
+// move_file [diretorio_origem] [inode_file] [diretorio_destino]
+static int cmd_move_file(CmdSession *s, int argc, char **argv) {
+    Disk *disk = s->disk;
+    (void)argc;
+    uint32_t origem_inode = atoi(argv[1]);
+    uint32_t file_inode = atoi(argv[2]);
+    uint32_t destino_inode = atoi(argv[3]);
+    uint64_t t = trace_begin();
+
+    // Obter o nome do arquivo
+    char nome_arquivo[MAX_NAME_LEN] = {0};
+    if (dir_find_entry(disk, origem_inode, file_inode, nome_arquivo) != 0) {
+        trace_end(t, TRACE_MOVE, origem_inode, file_inode, destino_inode, NULL, 0, 0);
+        printf("[ERRO] Arquivo não encontrado no diretório de origem\n");
+        return -1;
+    }
+
+    // Remover do diretório de origem
+    if (dir_remove_entry(disk, origem_inode, file_inode) != 0) {
+        trace_end(t, TRACE_MOVE, origem_inode, file_inode, destino_inode, NULL, 0, 0);
+        printf("[ERRO] Falha ao remover do diretório de origem.\n");
+        return -1;
+    }
+
+    // Adicionar no diretório de destino
+    int ok = dir_add_entry(disk, destino_inode, file_inode, nome_arquivo) == 0;
+    trace_end(t, TRACE_MOVE, origem_inode, file_inode, destino_inode, NULL, 0, ok);
+    if (!ok) {
+        printf("[ERRO] Falha ao adicionar no diretório destino.\n");
+        return -1;
+    }
+
+    printf("Arquivo movido com sucesso!\n");
+    return ok ? 0 : -1;
+}
+
+// delete_file [diretorio_pai] [inode_file]
+static int cmd_delete_file(CmdSession *s, int argc, char **argv) {
+    Disk *disk = s->disk;
+    (void)argc;
+    uint32_t parent_inode = atoi(argv[1]);
+    uint32_t file_inode = atoi(argv[2]);
+    uint64_t t = trace_begin();
+    int ok = file_delete(disk, parent_inode, file_inode) == 0;
+    trace_end(t, TRACE_DELETE, parent_inode, file_inode, 0, NULL, 0, ok);
+    if (ok) {
+        printf("Arquivo apagado com sucesso.\n");
+    } else {
+        printf("[ERRO] Falha ao apagar arquivo.\n");
+    }
+    return ok ? 0 : -1;
+}
+
+// link [diretorio] [inode_file] [nome] - Nova entrada para um arquivo existente (hard link)
+static int cmd_link(CmdSession *s, int argc, char **argv) {
+    Disk *disk = s->disk;
+    (void)argc;
+    uint32_t dir_inode = atoi(argv[1]);
+    uint32_t file_inode = atoi(argv[2]);
+    uint64_t t = trace_begin();
+    int ok = file_link(disk, dir_inode, file_inode, argv[3]) == 0;
+    trace_end(t, TRACE_LINK, dir_inode, file_inode, 0, argv[3], 0, ok);
+    if (!ok) {
+        printf("[ERRO] Falha ao criar o link '%s'.\n", argv[3]);
+        return -1;
+    }
+    Inode *inode = inode_load(disk, file_inode);
+    printf("Link '%s' criado no diretório %u para o inode %u (%u links).\n", argv[3], dir_inode, file_inode,
+           inode ? inode->nlink : 0);
+    inode_put(inode);
+    return 0;
+}
+
+// read_file [inode_file]
+static int cmd_read_file(CmdSession *s, int argc, char **argv) {
+    Disk *disk = s->disk;
+    (void)argc;
+    uint32_t file_inode = atoi(argv[1]);
+    uint64_t t = trace_begin();
+    int ok = file_read(disk, file_inode) == 0;
+    trace_end(t, TRACE_READ, 0, file_inode, 0, NULL, 0, ok);
+    if (!ok) {
+        printf("[ERRO] Falha ao ler o arquivo de inode %u.\n", file_inode);
+    }
+    return ok ? 0 : -1;
+}
+
+// cd [inode_dir]
+static int cmd_cd(CmdSession *s, int argc, char **argv) {
+    Disk *disk = s->disk;
+    (void)argc;
+    uint32_t new_dir = atoi(argv[1]);
+    Inode *inode = inode_load(disk, new_dir);
+    if (!inode || (inode->mode & 040000) != 040000) {
+        printf("[ERRO] O inode %u não é um diretório válido.\n", new_dir);
+        if (inode) inode_put(inode);
+        return -1;
+    }
+    inode_put(inode);
+    s->cwd = new_dir;
+    printf("Diretório atual alterado para %u\n", s->cwd);
+    return 0;
+}
+
+// disk_usage - Mostra estatísticas de uso do disco (contadores do superbloco)
+static int cmd_disk_usage(CmdSession *s, int argc, char **argv) {
+    Disk *disk = s->disk;
+    (void)argc;
+    (void)argv;
+    FsStat st;
+    superblock_statfs(disk, &st);
+    uint32_t total_blocks = st.total_blocks;
+    uint32_t used_blocks = total_blocks - st.free_blocks;
+
+    uint32_t free_blocks = st.free_blocks;
+    double usage_percent = (double)used_blocks / total_blocks * 100.0;
+
+    printf("=== ESTATÍSTICAS DO DISCO ===\n");
+    printf("Tamanho total: %u blocos (%llu MB)\n", total_blocks,
+        (unsigned long long)((uint64_t)total_blocks * disk->block_size / (1024 * 1024)));
+    printf("Blocos usados: %u (%.1f%%)\n", used_blocks, usage_percent);
+    printf("Blocos livres: %u\n", free_blocks);
+    printf("I-nodes livres: %u de %u\n", st.free_inodes, st.total_inodes);
+    printf("Tamanho do bloco: %u bytes\n", disk->block_size);
+    return 0;
+}
+
+// find_orphans - Encontra inodes órfãos (não referenciados por nenhum diretório)
+static int cmd_find_orphans(CmdSession *s, int argc, char **argv) {
+    Disk *disk = s->disk;
+    (void)argc;
+    (void)argv;
+    printf("=== PROCURANDO INODES ÓRFÃOS ===\n");
+    FsckReport report;
+    if (fsck_run(disk, 0, 0, &report) < 0) {
+        printf("[ERRO] Falha ao verificar o sistema de arquivos\n");
+        return -1;
+    }
+
+    if (report.orphan_inodes == 0 && report.unreachable_dirs == 0) {
+        printf("Nenhum inode órfão encontrado.\n");
+    } else {
+        printf("%u inodes órfãos, %u diretórios inalcançáveis.\n",
+            report.orphan_inodes, report.unreachable_dirs);
+    }
+    return 0;
+}
+
+// fsck [-r] - Verifica a consistência (e repara com -r)
+static int cmd_fsck(CmdSession *s, int argc, char **argv) {
+    Disk *disk = s->disk;
+    int repair = (argc > 1 && strcmp(argv[1], "-r") == 0);
+    FsckReport report;
+    if (fsck_run(disk, repair, 0, &report) < 0) {
+        printf("[ERRO] Falha ao verificar o sistema de arquivos\n");
+        return -1;
+    }
+    fsck_print_report(&report);
+    return 0;
+}
+
+// defrag [max_arquivos] - Compacta diretórios e realoca os arquivos mais fragmentados
+static int cmd_defrag(CmdSession *s, int argc, char **argv) {
+    Disk *disk = s->disk;
+    uint32_t max_files = (argc > 1) ? (uint32_t)atoi(argv[1]) : 0;
+    DefragReport report;
+    if (defrag_run(disk, max_files, &report) != 0) return -1;
+    printf("=== DESFRAGMENTAÇÃO ===\n");
+    printf("I-nodes analisados: %u\n", report.inodes_scanned);
+    printf("Fragmentados antes: %u\n", report.fragmented_before);
+    printf("Realocados: %u\n", report.relocated);
+    printf("Fragmentados depois: %u\n", report.fragmented_after);
+    printf("Diretórios compactados: %u (%u blocos liberados)\n",
+        report.dirs_compacted, report.blocks_freed);
+    return 0;
+}
+
+// snapshot - Congela o estado atual da imagem
+static int cmd_snapshot(CmdSession *s, int argc, char **argv) {
+    (void)argc;
+    (void)argv;
+    uint32_t id = snapshot_create(s->disk);
+    if (id == (uint32_t)-1) return -1;
+    printf("[INFO] Snapshot %u criado\n", id);
+    return 0;
+}
+
+// snapshot_list - Lista os snapshots e o espaço que retêm
+static int cmd_snapshot_list(CmdSession *s, int argc, char **argv) {
+    (void)argc;
+    (void)argv;
+    SnapshotInfo info[SNAPSHOT_MAX];
+    uint32_t retained;
+    int n = snapshot_list(s->disk, info, SNAPSHOT_MAX, &retained);
+    printf("=== SNAPSHOTS ===\n");
+    if (n == 0) printf("Nenhum snapshot.\n");
+    for (int i = 0; i < n; i++) {
+        char when[32];
+        strftime(when, sizeof(when), "%Y-%m-%d %H:%M:%S", localtime(&info[i].created_at));
+        printf("  %3u  %s  %u blocos de metadados copiados, %u de mapas\n",
+               info[i].id, when, info[i].copies, info[i].map_blocks);
+    }
+    if (n > 0 && !snapshot_read_only(s->disk)) {
+        printf("Blocos retidos só pelos snapshots: %u (%u bytes)\n",
+               retained, retained * s->disk->block_size);
+    }
+    return 0;
+}
+
+// snapshot_delete [id] - Remove um snapshot e libera o que só ele retinha
+static int cmd_snapshot_delete(CmdSession *s, int argc, char **argv) {
+    (void)argc;
+    return snapshot_delete(s->disk, (uint32_t)atoi(argv[1]));
+}
+
+// alloc_policy [first|next|best|buddy] - Mostra ou troca a política de alocação
+static int cmd_alloc_policy(CmdSession *s, int argc, char **argv) {
+    Disk *disk = s->disk;
+    if (argc > 1) {
+        int policy = alloc_policy_from_name(argv[1]);
+        if (policy < 0 || alloc_attach(disk, policy) != 0) {
+            printf("[ERRO] Política desconhecida: %s (use first, next, best ou buddy)\n", argv[1]);
+            return -1;
+        }
+    }
+    uint32_t extents, largest;
+    alloc_free_extents(disk, &extents, &largest);
+    printf("Política de alocação: %s\n", alloc_policy_name(disk->alloc->policy));
+    printf("Trechos livres: %u (maior: %u blocos)\n", extents, largest);
+    return 0;
+}
+
+// io_engine [sync|threads|uring] [profundidade] - Mostra ou troca o motor de E/S em lote
+static int cmd_io_engine(CmdSession *s, int argc, char **argv) {
+    Disk *disk = s->disk;
+    if (argc > 1) {
+        int requested = disk_io_engine_from_name(argv[1]);
+        if (requested < 0) {
+            printf("[ERRO] Motor desconhecido: %s (use sync, threads ou uring)\n", argv[1]);
+            return -1;
+        }
+        uint32_t depth = (argc > 2) ? (uint32_t)atoi(argv[2]) : DISK_IO_DEPTH_DEFAULT;
+        disk_io_init(disk, requested, depth);
+    }
+    printf("Motor de E/S: %s\n", disk_io_engine_name(disk_io_engine(disk)));
+    return 0;
+}
+
+// direct_io [on|off] - Mostra ou troca o modo O_DIRECT dos dados de arquivo
+static int cmd_direct_io(CmdSession *s, int argc, char **argv) {
+    Disk *disk = s->disk;
+    if (argc > 1) {
+        int enable = strcmp(argv[1], "on") == 0;
+        if (!enable && strcmp(argv[1], "off") != 0) {
+            printf("[ERRO] Sintaxe: direct_io [on|off]\n");
+            return -1;
+        }
+        if (disk_set_direct(disk, enable) != 0) {
+            printf("[ERRO] Não foi possível ligar o modo direto\n");
+        }
+    }
+    printf("E/S direta (O_DIRECT): %s\n", disk->direct_fd >= 0 ? "ligada" : "desligada");
+    return 0;
+}
+
+// icache - Mostra os contadores do cache de i-nodes e do slab
+static int cmd_icache(CmdSession *s, int argc, char **argv) {
+    Disk *disk = s->disk;
+    (void)argc;
+    (void)argv;
+    ICacheStats st;
+    icache_stats(disk, &st);
+    uint64_t loads = st.hits + st.misses;
+    printf("=== CACHE DE I-NODES ===\n");
+    printf("Leituras: %llu (%llu no cache, %.1f%%)\n", (unsigned long long)loads,
+           (unsigned long long)st.hits, loads ? 100.0 * st.hits / loads : 0.0);
+    printf("I-nodes em cache: %u (%llu descartados)\n", st.cached, (unsigned long long)st.evictions);
+    printf("Slabs: %u de %d objetos (%u em uso, %u livres)\n", st.slabs, ICACHE_SLAB_OBJECTS,
+           st.in_use, st.slab_free);
+    return 0;
+}
+
+// stats - Latências por operação, syscalls, bytes e acertos do cache
+// stats [reset|on|off] - Zera os contadores / liga ou desliga a medição de tempo
+// stats json [arquivo] - Grava os contadores e os histogramas em JSON
+static int cmd_stats(CmdSession *s, int argc, char **argv) {
+    Disk *disk = s->disk;
+    if (argc == 1) {
+        stats_print(disk);
+    } else if (strcmp(argv[1], "reset") == 0) {
+        stats_reset();
+        printf("[INFO] Contadores zerados\n");
+    } else if (strcmp(argv[1], "on") == 0 || strcmp(argv[1], "off") == 0) {
+        stats_enable(strcmp(argv[1], "on") == 0);
+        printf("Medição de latência: %s\n", strcmp(argv[1], "on") == 0 ? "ligada" : "desligada");
+    } else if (strcmp(argv[1], "json") == 0) {
+        const char *path = (argc > 2) ? argv[2] : STATS_JSON_FILE;
+        if (stats_write_json(disk, path) != 0) {
+            printf("[ERRO] Não foi possível gravar %s\n", path);
+            return -1;
+        }
+        printf("[INFO] Estatísticas gravadas em %s\n", path);
+    } else {
+        printf("[ERRO] Sintaxe: stats [reset|on|off|json] [arquivo]\n");
+    }
+    return 0;
+}
+
+// trace_start [arquivo] - Grava os comandos seguintes em um trace binário
+static int cmd_trace_start(CmdSession *s, int argc, char **argv) {
+    Disk *disk = s->disk;
+    const char *path = (argc > 1) ? argv[1] : TRACE_DEFAULT_FILE;
+    if (trace_start(path, disk->block_size) != 0) {
+        printf("[ERRO] Não foi possível criar o trace %s\n", path);
+        return -1;
+    }
+    printf("[INFO] Gravando trace em %s\n", path);
+    return 0;
+}
+
+// trace_stop - Termina a gravação do trace
+static int cmd_trace_stop(CmdSession *s, int argc, char **argv) {
+    (void)s;
+    (void)argc;
+    (void)argv;
+    if (!trace_active()) {
+        printf("[AVISO] Nenhuma gravação em andamento\n");
+        return -1;
+    }
+    trace_stop();
+    printf("[INFO] Gravação do trace encerrada\n");
+    return 0;
+}
+
+// trace_replay [arquivo] [inode_dir] [paced] - Reproduz um trace com o root gravado em
+// inode_dir (padrão: diretório atual); "paced" respeita os intervalos gravados
+static int cmd_trace_replay(CmdSession *s, int argc, char **argv) {
+    Disk *disk = s->disk;
+    uint32_t root = (argc > 2) ? (uint32_t)atoi(argv[2]) : s->cwd;
+    int paced = (argc > 3 && strcmp(argv[3], "paced") == 0);
+    TraceReport report;
+    if (trace_replay(disk, argv[1], root, paced, &report) != 0 && report.records == 0) return -1;
+    trace_print_report(&report);
+    return 0;
+}
+
+// alloc_bench [operacoes] [semente] - Compara as políticas com um trace de criação/remoção
+static int cmd_alloc_bench(CmdSession *s, int argc, char **argv) {
+    Disk *disk = s->disk;
+    uint32_t ops = (argc > 1) ? (uint32_t)atoi(argv[1]) : 5000;
+    unsigned int seed = (argc > 2) ? (unsigned int)atoi(argv[2]) : 42;
+    alloc_benchmark(disk->block_size, ops, seed);
+    return 0;
+}
+
+// scale_bench [max_GB] [arquivos] - Aloca e busca em discos esparsos de 16MB até max_GB
+static int cmd_scale_bench(CmdSession *s, int argc, char **argv) {
+    Disk *disk = s->disk;
+    uint64_t max_gb = (argc > 1) ? strtoull(argv[1], NULL, 10) : 1024;
+    uint32_t ops = (argc > 2) ? (uint32_t)atoi(argv[2]) : 2000;
+    if (alloc_scale_benchmark(disk->block_size, max_gb << 30, ops, 42) != 0) {
+        printf("[ERRO] Parâmetros inválidos para o benchmark de escala\n");
+    }
+    return 0;
+}
+
+// import_tree [dir_host] [inode_dir] - Importa um diretório do host recursivamente
+static int cmd_import_tree(CmdSession *s, int argc, char **argv) {
+    Disk *disk = s->disk;
+    uint32_t target = (argc > 2) ? (uint32_t)atoi(argv[2]) : s->cwd;
+    ImportReport report;
+    if (import_tree(disk, argv[1], target, &report) == 0 || report.files + report.dirs > 0) {
+        import_print_report(&report);
+    }
+    return 0;
+}
+
+// export_tree [inode_dir] [dir_host] - Recria a subárvore do diretório no host
+static int cmd_export_tree(CmdSession *s, int argc, char **argv) {
+    Disk *disk = s->disk;
+    (void)argc;
+    ExportReport report;
+    uint32_t source = (uint32_t)atoi(argv[1]);
+    if (export_tree(disk, source, argv[2], &report) == 0 || report.files > 0) {
+        export_print_report(&report);
+    }
+    return 0;
+}
+
+// tree [inode] - Mostra árvore de diretórios
+static int cmd_tree(CmdSession *s, int argc, char **argv) {
+    Disk *disk = s->disk;
+    uint32_t root_inode = (argc > 1) ? (uint32_t)atoi(argv[1]) : 0;
+    printf("=== ÁRVORE DE DIRETÓRIOS ===\n");
+    print_directory_tree(disk, root_inode, 0);
+    return 0;
+}
+
+// du [inode] - Tamanho acumulado de cada diretório da subárvore
+// du -s [inode] - Só o total, lido dos contadores do diretório (sem caminhada)
+static int cmd_du(CmdSession *s, int argc, char **argv) {
+    Disk *disk = s->disk;
+    if (argc > 1 && strcmp(argv[1], "-s") == 0) {
+        uint32_t dir_inode = (argc > 2) ? (uint32_t)atoi(argv[2]) : s->cwd;
+        Inode *dir = inode_load(disk, dir_inode);
+        if (!dir || (dir->mode & 040000) != 040000) {
+            printf("[ERRO] Inode %u não é um diretório\n", dir_inode);
+            if (dir) inode_put(dir);
+            return -1;
+        }
+        printf("%10llu bytes %8llu blocos %8u arquivos  (inode %u)\n",
+               (unsigned long long)dir->tree_bytes, (unsigned long long)dir->tree_blocks,
+               dir->tree_files, dir_inode);
+        inode_put(dir);
+        return 0;
+    }
+    uint32_t root_inode = (argc > 1) ? (uint32_t)atoi(argv[1]) : s->cwd;
+    printf("=== USO POR DIRETÓRIO ===\n");
+    WalkReport report;
+    if (walk_tree(disk, root_inode, 0, NULL, du_print_entry, NULL, &report) < 0) return -1;
+    walk_print_report(&report);
+    return 0;
+}
+
+// find [inode] [name|size|mtime] [valor] - Busca na subárvore
+// (name: padrão como "*.txt"; size: bytes, +N maior, -N menor; mtime: minutos, +N/-N)
+static int cmd_find(CmdSession *s, int argc, char **argv) {
+    Disk *disk = s->disk;
+    (void)argc;
+    FindQuery q;
+    memset(&q, 0, sizeof(q));
+    q.now = time(NULL);
+    if (strcmp(argv[2], "name") == 0) {
+        q.kind = 0;
+        q.pattern = argv[3];
+    } else if (strcmp(argv[2], "size") == 0 || strcmp(argv[2], "mtime") == 0) {
+        q.kind = (strcmp(argv[2], "size") == 0) ? 1 : 2;
+        const char *v = argv[3];
+        if (*v == '+' || *v == '-') q.cmp = (*v++ == '+') ? 1 : -1;
+        q.value = atoll(v);
+    } else {
+        printf("[ERRO] Critério inválido: %s (use name, size ou mtime)\n", argv[2]);
+        return -1;
+    }
+    printf("=== BUSCA ===\n");
+    WalkReport report;
+    if (walk_tree(disk, (uint32_t)atoi(argv[1]), 0, find_match_entry, NULL, &q, &report) < 0) return -1;
+    printf("Encontrados: %u\n", q.matches);
+    walk_print_report(&report);
+    return 0;
+}
+
+// workload_config [personalidade] - Volta aos padrões de fileserver, mailserver, largeseq ou metastorm
+// workload_config [parametro] [valor] - Altera um parâmetro (fanout, depth, files, size_dist,
+// size_mean ou o peso de uma operação: create, read, delete, stat, rename, lookup, list, mkdir)
+static int cmd_workload_config(CmdSession *s, int argc, char **argv) {
+    if (argc == 2) {
+        int type = workload_type_from_name(argv[1]);
+        if (type < 0) {
+            printf("[ERRO] Personalidade desconhecida: %s\n", argv[1]);
+            return -1;
+        }
+        workload_defaults(type, &s->workload);
+    } else if (argc == 3) {
+        if (workload_set(&s->workload, argv[1], argv[2]) != 0) {
+            printf("[ERRO] Parâmetro inválido: %s %s\n", argv[1], argv[2]);
+            return -1;
+        }
+    }
+    workload_print_config(&s->workload);
+    return 0;
+}
+
+// workload [operacoes] [semente] - Executa a carga configurada no diretório atual
+static int cmd_workload(CmdSession *s, int argc, char **argv) {
+    Disk *disk = s->disk;
+    if (argc > 1) s->workload.ops = (uint32_t)atoi(argv[1]);
+    if (argc > 2) s->workload.seed = (uint32_t)atoi(argv[2]);
+    workload_print_config(&s->workload);
+    WorkloadReport report;
+    if (workload_run(disk, s->cwd, &s->workload, &report) != 0) return -1;
+    workload_print_report(&report);
+    return 0;
+}
+
+// write_file [diretorio] [inode_file] [offset] [texto] - Grava o texto no offset (sobrescreve)
+static int cmd_write_file(CmdSession *s, int argc, char **argv) {
+    Disk *disk = s->disk;
+    (void)argc;
+    uint32_t parent_inode = atoi(argv[1]);
+    uint32_t file_inode = atoi(argv[2]);
+    uint32_t offset = atoi(argv[3]);
+    uint32_t len = strlen(argv[4]);
+    uint64_t t = trace_begin();
+    int ok = file_write_data(disk, parent_inode, file_inode, offset, (const uint8_t *)argv[4], len) == 0;
+    trace_end(t, TRACE_WRITE, parent_inode, file_inode, offset, NULL, len, ok);
+    if (!ok) {
+        printf("[ERRO] Falha ao gravar no arquivo de inode %u.\n", file_inode);
+        return -1;
+    }
+    printf("%u bytes gravados no offset %u do inode %u.\n", len, offset, file_inode);
+    return 0;
+}
+
+// truncate_file [diretorio] [inode_file] [tamanho] - Corta ou estende (com buraco) o arquivo
+static int cmd_truncate_file(CmdSession *s, int argc, char **argv) {
+    Disk *disk = s->disk;
+    (void)argc;
+    uint32_t parent_inode = atoi(argv[1]);
+    uint32_t file_inode = atoi(argv[2]);
+    uint32_t size = atoi(argv[3]);
+    uint64_t t = trace_begin();
+    int ok = file_truncate(disk, parent_inode, file_inode, size) == 0;
+    trace_end(t, TRACE_TRUNCATE, parent_inode, file_inode, size, NULL, 0, ok);
+    if (!ok) {
+        printf("[ERRO] Falha ao mudar o tamanho do arquivo de inode %u.\n", file_inode);
+        return -1;
+    }
+    printf("Arquivo de inode %u agora tem %u bytes.\n", file_inode, size);
+    return 0;
+}
+
+// copy_file [dir_origem] [inode_file] [dir_destino] [novo_nome]
+static int cmd_copy_file(CmdSession *s, int argc, char **argv) {
+    Disk *disk = s->disk;
+    (void)argc;
+    // uint32_t origem_dir = atoi(argv[1]); // REMOVIDO - variável não utilizada
+    uint32_t file_inode = atoi(argv[2]);
+    uint32_t destino_dir = atoi(argv[3]);
+    char *novo_nome = argv[4];
+    uint64_t t = trace_begin();
+
+    // Carregar arquivo original (só arquivos regulares são copiados)
+    Inode *orig_file = inode_load(disk, file_inode);
+    if (!orig_file || (orig_file->mode & 0100000) == 0) {
+        printf(orig_file && orig_file->mode ? "[ERRO] Só arquivos regulares podem ser copiados\n"
+                                            : "[ERRO] Arquivo não encontrado\n");
+        inode_put(orig_file);
+        trace_end_create(disk, t, TRACE_COPY, destino_dir, file_inode, novo_nome, 0);
+        return -1;
+    }
+
+    // Criar novo inode
+    uint32_t new_inode = inode_alloc(disk);
+    if (new_inode == (uint32_t)-1) {
+        printf("[ERRO] Não foi possível alocar novo inode\n");
+        inode_put(orig_file);
+        trace_end_create(disk, t, TRACE_COPY, destino_dir, file_inode, novo_nome, 0);
+        return -1;
+    }
+
+    // Copiar dados do inode
+    Inode *new_file = inode_create(orig_file->mode);
+    new_file->size = orig_file->size;
+
+    // Copiar blocos de dados: buracos continuam buracos e o destino é
+    // reservado em trechos contíguos
+    uint32_t num_blocks = (orig_file->size + disk->block_size - 1) / disk->block_size;
+    if (num_blocks > MAX_BLOCKS_PER_INODE) num_blocks = MAX_BLOCKS_PER_INODE;
+    uint8_t *buffer = disk_buf_get(disk);
+    memset(buffer, 0, (size_t)num_blocks * disk->block_size);
+    DiskIoReq reqs[MAX_BLOCKS_PER_INODE];
+    for (uint32_t i = 0; i < num_blocks; i++) {
+        reqs[i].result = disk->block_size;
+        if (orig_file->blocks[i] == 0) continue;
+        reqs[i] = (DiskIoReq){DISK_IO_READ, buffer + i * disk->block_size, disk->block_size,
+                              disk_block_offset(disk, orig_file->blocks[i]), 0, 0};
+        disk_io_submit(disk, &reqs[i]);
+    }
+    disk_io_wait(disk);
+
+    // Uma leitura curta viraria zeros na cópia
+    const char *erro = NULL;
+    for (uint32_t i = 0; i < num_blocks && !erro; i++) {
+        if (reqs[i].result != (ssize_t)disk->block_size) erro = "Falha ao ler os blocos do arquivo original";
+    }
+    if (!erro && inode_write_sparse(disk, new_file, buffer, orig_file->size) != 0) {
+        erro = "Não há blocos livres suficientes";
+    }
+    disk_buf_put(disk, buffer);
+
+    if (!erro) {
+        // Salvar novo arquivo e adicionar ao diretório destino
+        inode_save(disk, new_inode, new_file);
+        if (dir_add_entry(disk, destino_dir, new_inode, novo_nome) != 0) {
+            erro = "Falha ao adicionar arquivo ao diretório destino";
+            for (uint32_t i = 0; i < MAX_BLOCKS_PER_INODE; i++) {
+                if (new_file->blocks[i] != 0) bitmap_set(disk, new_file->blocks[i], 0);
+            }
+        }
+    }
+    if (erro) {
+        printf("[ERRO] %s\n", erro);
+        inode_free(disk, new_inode);
+    } else {
+        printf("Arquivo copiado com sucesso como '%s' (inode %u)\n", novo_nome, new_inode);
+    }
+    trace_end_create(disk, t, TRACE_COPY, destino_dir, file_inode, novo_nome, !erro);
+
+    inode_put(orig_file);
+    inode_put(new_file);
+    return erro ? -1 : 0;
+}
+
+// file_size [inode] - Mostra tamanho detalhado do arquivo
+static int cmd_file_size(CmdSession *s, int argc, char **argv) {
+    Disk *disk = s->disk;
+    (void)argc;
+    uint32_t file_inode = atoi(argv[1]);
+    Inode *inode = inode_load(disk, file_inode);
+    if (!inode) {
+        printf("[ERRO] Inode não encontrado\n");
+        return -1;
+    }
+
+    printf("=== INFORMAÇÕES DO ARQUIVO ===\n");
+    printf("Inode: %u\n", file_inode);
+    printf("Tamanho: %u bytes\n", inode->size);
+    printf("Links: %u\n", inode->nlink ? inode->nlink : 1);
+    printf("Blocos alocados: ");
+
+    int block_count = 0, holes = 0;
+    uint32_t logical = (inode->size + disk->block_size - 1) / disk->block_size;
+    for (int i = 0; i < MAX_BLOCKS_PER_INODE; i++) {
+        if (inode->blocks[i] != 0) {
+            printf("%u ", inode->blocks[i]);
+            block_count++;
+        } else if ((uint32_t)i < logical) {
+            printf("- ");
+            holes++;
+        }
+    }
+    printf("\nTotal de blocos: %d\n", block_count);
+    printf("Buracos: %d\n", holes);
+    printf("Trechos contíguos: %u\n", defrag_count_runs(inode));
+    printf("Espaço alocado: %u bytes\n", block_count * disk->block_size);
+    uint32_t allocated = block_count * disk->block_size;
+    printf("Fragmentação interna: %u bytes\n",
+        allocated > inode->size ? allocated - inode->size : 0);
+
+    inode_put(inode);
+    return 0;
+}
+
+// file_map [inode] - Mostra os trechos de dados e buracos do arquivo
+static int cmd_file_map(CmdSession *s, int argc, char **argv) {
+    Disk *disk = s->disk;
+    (void)argc;
+    uint32_t file_inode = atoi(argv[1]);
+    uint32_t pos = 0;
+    uint32_t data = file_seek(disk, file_inode, 0, FILE_SEEK_DATA);
+    if (data == (uint32_t)-1 && file_seek(disk, file_inode, 0, FILE_SEEK_HOLE) == (uint32_t)-1) {
+        printf("[ERRO] Inode %u não é um arquivo regular ou está vazio\n", file_inode);
+        return -1;
+    }
+    printf("=== MAPA DO ARQUIVO (inode %u) ===\n", file_inode);
+    while (data != (uint32_t)-1) {
+        if (data > pos) printf("  buraco [%u, %u)\n", pos, data);
+        uint32_t hole = file_seek(disk, file_inode, data, FILE_SEEK_HOLE);
+        printf("  dados  [%u, %u)\n", data, hole);
+        pos = hole;
+        data = file_seek(disk, file_inode, hole, FILE_SEEK_DATA);
+    }
+    uint32_t end = file_seek(disk, file_inode, pos, FILE_SEEK_HOLE);
+    if (end != (uint32_t)-1) {
+        Inode *inode = inode_load(disk, file_inode);
+        printf("  buraco [%u, %u)\n", pos, inode->size);
+        inode_put(inode);
+    }
+    return 0;
+}
+
+static int cmd_help(CmdSession *s, int argc, char **argv);
+
+// output [normal|quiet|batch] - Mostra ou troca o modo de saída
+static int cmd_output(CmdSession *s, int argc, char **argv) {
+    if (argc > 1) {
+        int output = command_output_from_name(argv[1]);
+        if (output < 0) {
+            printf("[ERRO] Modo desconhecido: %s (use normal, quiet ou batch)\n", argv[1]);
+            return -1;
+        }
+        command_set_output(s, output);
+    }
+    printf("Saída: %s\n", command_output_name(s->output));
+    return 0;
+}
+
+static const Command commands[] = {
+    {"info", cmd_info, 1, 0, "info [inode]"},
+    {"create_file", cmd_create_file, 4, CMD_WRITES, "create_file [diretorio] [arquivo_host] [nome_fs]"},
+    {"list_dir", cmd_list_dir, 1, 0, "list_dir [inode]"},
+    {"create_dir", cmd_create_dir, 3, CMD_WRITES, "create_dir [diretorio_pai] [nome]"},
+    {"rename_dir", cmd_rename_dir, 4, CMD_WRITES, "rename_dir [diretorio_pai] [inode_dir] [novo_nome]"},
+    {"delete_dir", cmd_delete_dir, 3, CMD_WRITES, "delete_dir [diretorio_pai] [inode_dir]"},
+    {"rename_file", cmd_rename_file, 4, CMD_WRITES, "rename_file [diretorio] [inode_file] [novo_nome]"},
+    {"move_file", cmd_move_file, 4, CMD_WRITES, "move_file [diretorio_origem] [inode_file] [diretorio_destino]"},
+    {"delete_file", cmd_delete_file, 3, CMD_WRITES, "delete_file [diretorio_pai] [inode_file]"},
+    {"link", cmd_link, 4, CMD_WRITES, "link [diretorio] [inode_file] [nome]"},
+    {"read_file", cmd_read_file, 2, 0, "read_file [inode_file]"},
+    {"write_file", cmd_write_file, 5, CMD_WRITES, "write_file [diretorio] [inode_file] [offset] [texto]"},
+    {"truncate_file", cmd_truncate_file, 4, CMD_WRITES, "truncate_file [diretorio] [inode_file] [tamanho]"},
+    {"copy_file", cmd_copy_file, 5, CMD_WRITES, "copy_file [dir_origem] [inode_file] [dir_destino] [novo_nome]"},
+    {"file_size", cmd_file_size, 2, 0, "file_size [inode]"},
+    {"file_map", cmd_file_map, 2, 0, "file_map [inode]"},
+    {"cd", cmd_cd, 2, 0, "cd [inode_dir]"},
+    {"tree", cmd_tree, 1, 0, "tree [inode]"},
+    {"du", cmd_du, 1, 0, "du [-s] [inode]"},
+    {"find", cmd_find, 4, 0, "find [inode] [name|size|mtime] [valor]"},
+    {"disk_usage", cmd_disk_usage, 1, 0, "disk_usage"},
+    {"find_orphans", cmd_find_orphans, 1, 0, "find_orphans"},
+    {"fsck", cmd_fsck, 1, CMD_WRITES, "fsck [-r]"},
+    {"defrag", cmd_defrag, 1, CMD_WRITES, "defrag [max_arquivos]"},
+    {"alloc_policy", cmd_alloc_policy, 1, CMD_WRITES, "alloc_policy [first|next|best|buddy]"},
+    {"io_engine", cmd_io_engine, 1, 0, "io_engine [sync|threads|uring] [profundidade]"},
+    {"direct_io", cmd_direct_io, 1, CMD_WRITES, "direct_io [on|off]"},
+    {"icache", cmd_icache, 1, 0, "icache"},
+    {"stats", cmd_stats, 1, 0, "stats [reset|on|off|json] [arquivo]"},
+    {"trace_start", cmd_trace_start, 1, 0, "trace_start [arquivo]"},
+    {"trace_stop", cmd_trace_stop, 1, 0, "trace_stop"},
+    {"trace_replay", cmd_trace_replay, 2, CMD_WRITES, "trace_replay [arquivo] [inode_dir] [paced]"},
+    {"alloc_bench", cmd_alloc_bench, 1, 0, "alloc_bench [operacoes] [semente]"},
+    {"scale_bench", cmd_scale_bench, 1, 0, "scale_bench [max_GB] [arquivos]"},
+    {"import_tree", cmd_import_tree, 2, CMD_WRITES, "import_tree [dir_host] [inode_dir]"},
+    {"export_tree", cmd_export_tree, 3, 0, "export_tree [inode_dir] [dir_host]"},
+    {"workload_config", cmd_workload_config, 1, 0, "workload_config [personalidade | parametro valor]"},
+    {"workload", cmd_workload, 1, CMD_WRITES, "workload [operacoes] [semente]"},
+    {"snapshot", cmd_snapshot, 1, CMD_WRITES, "snapshot"},
+    {"snapshot_list", cmd_snapshot_list, 1, 0, "snapshot_list"},
+    {"snapshot_delete", cmd_snapshot_delete, 2, CMD_WRITES, "snapshot_delete [id]"},
+    {"output", cmd_output, 1, 0, "output [normal|quiet|batch]"},
+    {"help", cmd_help, 1, 0, "help"},
+};
+
+#define CMD_COUNT (sizeof(commands) / sizeof(commands[0]))
+
+// help - Lista os comandos e a sintaxe de cada um
+static int cmd_help(CmdSession *s, int argc, char **argv) {
+    (void)s;
+    (void)argc;
+    (void)argv;
+    for (size_t i = 0; i < CMD_COUNT; i++) {
+        printf("  %s\n", commands[i].usage);
+    }
+    return 0;
+}
+
+/* ====================== */
+/* Hash perfeito          */
+/* ====================== */
+
+// Cada nome da tabela ocupa um slot exclusivo: a busca é um hash e um strcmp
+#define CMD_HASH_SIZE 256       // Potência de 2, bem maior que CMD_COUNT
+
+static uint8_t hash_slot[CMD_HASH_SIZE];   // Índice em commands + 1 (0 = vazio)
+static uint32_t hash_seed;
+static pthread_once_t hash_once = PTHREAD_ONCE_INIT;
+
+// FNV-1a com semente
+static uint32_t name_hash(const char *name, uint32_t seed) {
+    uint32_t h = 2166136261u ^ seed;
+    while (*name) {
+        h ^= (uint8_t)*name++;
+        h *= 16777619u;
+    }
+    return h ^ (h >> 16);
+}
+
+// Procura a primeira semente sem colisões entre os nomes da tabela
+static void hash_build(void) {
+    for (uint32_t seed = 0;; seed++) {
+        memset(hash_slot, 0, sizeof(hash_slot));
+        size_t i;
+        for (i = 0; i < CMD_COUNT; i++) {
+            uint32_t slot = name_hash(commands[i].name, seed) & (CMD_HASH_SIZE - 1);
+            if (hash_slot[slot]) break;
+            hash_slot[slot] = (uint8_t)(i + 1);
+        }
+        if (i == CMD_COUNT) {
+            hash_seed = seed;
+            return;
+        }
+    }
+}
+
+static const Command *command_find(const char *name) {
+    pthread_once(&hash_once, hash_build);
+    uint8_t slot = hash_slot[name_hash(name, hash_seed) & (CMD_HASH_SIZE - 1)];
+    if (slot == 0) return NULL;
+    const Command *c = &commands[slot - 1];
+    return strcmp(c->name, name) == 0 ? c : NULL;
+}
+
+/* ====================== */
+/* Sessão                 */
+/* ====================== */
+
+const char *command_output_name(CmdOutput output) {
+    return (output < CMD_OUTPUT_COUNT) ? output_names[output] : "?";
+}
+
+int command_output_from_name(const char *name) {
+    for (int i = 0; i < CMD_OUTPUT_COUNT; i++) {
+        if (strcmp(name, output_names[i]) == 0) return i;
+    }
+    return -1;
+}
+
+void command_session_init(CmdSession *s, Disk *disk, CmdOutput output) {
+    memset(s, 0, sizeof(CmdSession));
+    s->disk = disk;
+    s->cwd = 0; // Começa no root
+    s->saved_stdout = -1;
+    s->start_ns = now_ns();
+    workload_defaults(WORKLOAD_FILESERVER, &s->workload);
+    command_set_output(s, output);
+}
+
+// Restaura a saída padrão se ela estiver descartada
+static void restore_stdout(CmdSession *s) {
+    if (s->saved_stdout < 0) return;
+    fflush(stdout);
+    dup2(s->saved_stdout, STDOUT_FILENO);
+    close(s->saved_stdout);
+    s->saved_stdout = -1;
+}
+
+void command_set_output(CmdSession *s, CmdOutput output) {
+    if (output == CMD_OUTPUT_BATCH && s->saved_stdout < 0) {
+        // Um único redirecionamento para /dev/null vale para a sessão inteira
+        fflush(stdout);
+        int devnull = open("/dev/null", O_WRONLY);
+        if (devnull >= 0) {
+            s->saved_stdout = dup(STDOUT_FILENO);
+            if (s->saved_stdout >= 0) dup2(devnull, STDOUT_FILENO);
+            close(devnull);
+        }
+    } else if (output != CMD_OUTPUT_BATCH) {
+        restore_stdout(s);
+    }
+    s->output = output;
+}
+
+void command_session_end(CmdSession *s) {
+    restore_stdout(s);
+    trace_stop();
+}
+
+// Conta uma falha. No modo batch a mensagem do comando foi descartada, então
+// a linha vai para stderr
+static int command_fail(CmdSession *s, const char *what) {
+    s->errors++;
+    if (s->output == CMD_OUTPUT_BATCH) {
+        fprintf(stderr, "[ERRO] Linha %llu: %s\n", (unsigned long long)s->lines, what);
+    }
+    return -1;
+}
+
+// Divide a linha em palavras no lugar. Retorna quantas ou -1 se passar de CMD_MAX_ARGS
+static int tokenize(char *p, char **argv) {
+    int argc = 0;
+    for (;;) {
+        while (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n') p++;
+        if (*p == '\0') return argc;
+        if (argc == CMD_MAX_ARGS) return -1;
+        argv[argc++] = p;
+        while (*p && *p != ' ' && *p != '\t' && *p != '\r' && *p != '\n') p++;
+        if (*p) *p++ = '\0';
+    }
+}
+
+int command_exec_line(CmdSession *s, char *line) {
+    s->lines++;
+    if (s->output == CMD_OUTPUT_NORMAL) {
+        line[strcspn(line, "\r\n")] = '\0';
+        if (line[0] == '\0' || line[0] == '#') return 1;
+        printf("\n[EXECUTANDO] %s\n", line);
+    }
+
+    char *argv[CMD_MAX_ARGS];
+    int argc = tokenize(line, argv);
+    if (argc == 0 || (argc > 0 && argv[0][0] == '#')) return 1; // Linha vazia ou comentário
+    s->commands++;
+    if (argc < 0) {
+        printf("[ERRO] Argumentos demais para %s (máximo %d)\n", argv[0], CMD_MAX_ARGS - 1);
+        return command_fail(s, "argumentos demais");
+    }
+
+    const Command *c = command_find(argv[0]);
+    if (!c) {
+        printf("[ERRO] Comando desconhecido: %s (veja help)\n", argv[0]);
+        return command_fail(s, "comando desconhecido");
+    }
+    if (argc < c->min_args) {
+        printf("[ERRO] Sintaxe: %s\n", c->usage);
+        return command_fail(s, c->usage);
+    }
+    uint32_t view = snapshot_read_only(s->disk);
+    if (view && (c->flags & CMD_WRITES)) {
+        printf("[ERRO] %s altera a imagem, aberta somente leitura (snapshot %u)\n", c->name, view);
+        return command_fail(s, "imagem somente leitura");
+    }
+    int failed = c->fn(s, argc, argv) != 0;
+    superblock_flush(s->disk); // Contadores gravados uma vez por comando
+    if (failed) return command_fail(s, c->name);
+    return 0;
+}
+
+void command_exec_file(CmdSession *s, FILE *in) {
+    char line[CMD_MAX_LINE];
+    while (fgets(line, sizeof(line), in)) {
+        size_t len = strlen(line);
+        if (len == sizeof(line) - 1 && line[len - 1] != '\n' && !feof(in)) {
+            // Linha maior que o buffer: descarta o resto
+            int ch;
+            while ((ch = fgetc(in)) != EOF && ch != '\n') {}
+            s->lines++;
+            s->commands++;
+            printf("[ERRO] Linha maior que %d caracteres\n", CMD_MAX_LINE - 1);
+            command_fail(s, "linha longa demais");
+            continue;
+        }
+        command_exec_line(s, line);
+    }
+}
+
+void command_print_report(const CmdSession *s) {
+    double ms = (now_ns() - s->start_ns) / 1e6;
+    printf("[INFO] %llu linhas, %llu comandos (%llu falharam) em %.2f ms (%.0f comandos/s)\n",
+           (unsigned long long)s->lines, (unsigned long long)s->commands, (unsigned long long)s->errors,
+           ms, ms > 0 ? s->commands * 1000.0 / ms : 0.0);
+}
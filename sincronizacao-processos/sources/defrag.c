@@ -0,0 +1,222 @@
+#include "defrag.h"
+#include "superblock.h"
+#include "bitmap.h"
+#include "dir.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// I-node candidato à realocação
+typedef struct {
+    uint32_t inode_num;
+    uint32_t runs;
+} DefragCandidate;
+
+// Copia os blocos alocados do i-node (buracos de arquivos esparsos são pulados)
+static uint32_t used_blocks(Inode *inode, uint32_t *slots) {
+    uint32_t n = 0;
+    for (uint32_t i = 0; i < MAX_BLOCKS_PER_INODE; i++) {
+        if (inode->blocks[i] != 0) slots[n++] = i;
+    }
+    return n;
+}
+
+uint32_t defrag_count_runs(Inode *inode) {
+    uint32_t slots[MAX_BLOCKS_PER_INODE];
+    uint32_t n = used_blocks(inode, slots);
+    if (n == 0) return 0;
+
+    uint32_t runs = 1;
+    for (uint32_t i = 1; i < n; i++) {
+        if (inode->blocks[slots[i]] != inode->blocks[slots[i - 1]] + 1) runs++;
+    }
+    return runs;
+}
+
+int defrag_relocate(Disk *disk, uint32_t inode_num) {
+    Inode *inode = inode_load(disk, inode_num);
+    if (!inode) return -1;
+
+    uint32_t slots[MAX_BLOCKS_PER_INODE];
+    uint32_t n = used_blocks(inode, slots);
+    if (defrag_count_runs(inode) <= 1) {
+        inode_put(inode);
+        return 0;
+    }
+
+    uint32_t start = bitmap_find_free_run(disk, n);
+    if (start == (uint32_t)-1) {
+        inode_put(inode);
+        return -1;
+    }
+
+    // Lê os blocos antigos e grava tudo no novo trecho com uma única escrita
+    uint8_t *data = malloc(n * disk->block_size);
+    for (uint32_t i = 0; i < n; i++) {
+        off_t offset = disk_block_offset(disk, inode->blocks[slots[i]]);
+        if (pread(disk->fd, data + i * disk->block_size, disk->block_size, offset) != (ssize_t)disk->block_size) {
+            printf("[ERRO] Falha ao ler bloco %u do inode %u\n", inode->blocks[slots[i]], inode_num);
+            free(data);
+            inode_put(inode);
+            return -1;
+        }
+    }
+
+    for (uint32_t i = 0; i < n; i++) bitmap_set(disk, start + i, 1);
+    if (pwrite(disk->fd, data, n * disk->block_size, disk_block_offset(disk, start)) !=
+        (ssize_t)(n * disk->block_size)) {
+        printf("[ERRO] Falha ao gravar o novo trecho do inode %u\n", inode_num);
+        for (uint32_t i = 0; i < n; i++) bitmap_set(disk, start + i, 0);
+        free(data);
+        inode_put(inode);
+        return -1;
+    }
+
+    // Só libera os blocos antigos depois que o i-node aponta para os novos
+    uint32_t old_blocks[MAX_BLOCKS_PER_INODE];
+    for (uint32_t i = 0; i < n; i++) {
+        old_blocks[i] = inode->blocks[slots[i]];
+        inode->blocks[slots[i]] = start + i;
+    }
+    inode_save(disk, inode_num, inode);
+    for (uint32_t i = 0; i < n; i++) bitmap_set(disk, old_blocks[i], 0);
+
+    free(data);
+    inode_put(inode);
+    return 0;
+}
+
+int defrag_compact_dir(Disk *disk, uint32_t dir_inode_num, uint32_t *blocks_freed) {
+    Inode *dir = inode_load(disk, dir_inode_num);
+    if (!dir) return -1;
+    if ((dir->mode & 040000) != 040000) {
+        inode_put(dir);
+        return -1;
+    }
+
+    uint32_t num_entries = dir->size / DIR_ENTRY_SIZE;
+    uint32_t per_block = disk->block_size / DIR_ENTRY_SIZE;
+    uint32_t slots[MAX_BLOCKS_PER_INODE];
+    uint32_t n = used_blocks(dir, slots); // Diretórios não têm buracos: slots 0..n-1
+    if (n == 0) {
+        inode_put(dir);
+        return 0;
+    }
+
+    // Lê o diretório inteiro (um read por bloco)
+    DirEntry *entries = calloc(n * per_block, sizeof(DirEntry));
+    for (uint32_t b = 0; b < n; b++) {
+        pread(disk->fd, &entries[b * per_block], disk->block_size, disk_block_offset(disk, dir->blocks[b]));
+    }
+    if (num_entries > n * per_block) num_entries = n * per_block;
+
+    // Mantém a ordem, descartando as entradas apagadas
+    uint32_t kept = 0;
+    for (uint32_t i = 0; i < num_entries; i++) {
+        if (entries[i].name[0] == '\0') continue;
+        if (kept != i) entries[kept] = entries[i];
+        kept++;
+    }
+    if (kept == num_entries) {
+        free(entries);
+        inode_put(dir);
+        return 0; // nada a compactar
+    }
+    memset(&entries[kept], 0, (n * per_block - kept) * sizeof(DirEntry));
+
+    uint32_t needed = (kept * DIR_ENTRY_SIZE + disk->block_size - 1) / disk->block_size;
+    if (needed == 0) needed = 1;
+    for (uint32_t b = 0; b < needed; b++) {
+        pwrite(disk->fd, &entries[b * per_block], disk->block_size, disk_block_offset(disk, dir->blocks[b]));
+    }
+
+    // Blocos que ficaram vazios no fim do diretório são liberados
+    DirUsage usage = {(int64_t)kept * DIR_ENTRY_SIZE - dir->size, -(int64_t)(n - needed), 0};
+    for (uint32_t b = needed; b < n; b++) {
+        bitmap_set(disk, dir->blocks[b], 0);
+        dir->blocks[b] = 0;
+        if (blocks_freed) (*blocks_freed)++;
+    }
+    int removed = num_entries - kept;
+    dir->size = kept * DIR_ENTRY_SIZE;
+    inode_save(disk, dir_inode_num, dir);
+    dir_usage_add(disk, dir_inode_num, &usage, 1);
+
+    free(entries);
+    inode_put(dir);
+    return removed;
+}
+
+static int compare_candidates(const void *a, const void *b) {
+    const DefragCandidate *ca = a, *cb = b;
+    if (ca->runs != cb->runs) return (ca->runs < cb->runs) ? 1 : -1; // mais fragmentados primeiro
+    return (ca->inode_num > cb->inode_num) - (ca->inode_num < cb->inode_num);
+}
+
+int defrag_run(Disk *disk, uint32_t max_files, DefragReport *report) {
+    Superblock *sb = disk->sb;
+    memset(report, 0, sizeof(DefragReport));
+
+    // Mover blocos retidos por snapshots só duplicaria os dados
+    if (sb->snapshot_count > 0) {
+        printf("[AVISO] Desfragmentação desativada: há %u snapshot(s) retendo blocos (remova-os com snapshot_delete)\n",
+               sb->snapshot_count);
+        return -1;
+    }
+
+    uint32_t bitmap_size = (sb->inode_count + 7) / 8;
+    uint8_t *inode_bitmap = malloc(bitmap_size);
+    pread(disk->fd, inode_bitmap, bitmap_size, disk_block_offset(disk, sb->inode_bitmap_start));
+
+    DefragCandidate *candidates = malloc(sb->inode_count * sizeof(DefragCandidate));
+    uint32_t num_candidates = 0;
+
+    // 1. Compacta os diretórios primeiro: liberar blocos aumenta os trechos livres
+    for (uint32_t i = 0; i < sb->inode_count; i++) {
+        if (!(inode_bitmap[i / 8] & (1 << (i % 8)))) continue;
+        Inode *inode = inode_load(disk, i);
+        if (!inode) continue;
+        int is_dir = (inode->mode & 040000) == 040000;
+        inode_put(inode);
+
+        if (is_dir && defrag_compact_dir(disk, i, &report->blocks_freed) > 0) {
+            report->dirs_compacted++;
+        }
+    }
+
+    // 2. Mede a fragmentação de cada i-node
+    for (uint32_t i = 0; i < sb->inode_count; i++) {
+        if (!(inode_bitmap[i / 8] & (1 << (i % 8)))) continue;
+        Inode *inode = inode_load(disk, i);
+        if (!inode) continue;
+        uint32_t runs = defrag_count_runs(inode);
+        inode_put(inode);
+
+        report->inodes_scanned++;
+        if (runs > 1) {
+            report->fragmented_before++;
+            candidates[num_candidates].inode_num = i;
+            candidates[num_candidates].runs = runs;
+            num_candidates++;
+        }
+    }
+
+    // 3. Realoca os piores primeiro
+    qsort(candidates, num_candidates, sizeof(DefragCandidate), compare_candidates);
+    uint32_t limit = (max_files == 0 || max_files > num_candidates) ? num_candidates : max_files;
+    for (uint32_t c = 0; c < limit; c++) {
+        if (defrag_relocate(disk, candidates[c].inode_num) == 0) {
+            printf("[INFO] inode %u: %u trechos -> 1\n", candidates[c].inode_num, candidates[c].runs);
+            report->relocated++;
+        } else {
+            printf("[AVISO] inode %u: sem espaço contíguo para %u trechos\n",
+                   candidates[c].inode_num, candidates[c].runs);
+        }
+    }
+    report->fragmented_after = report->fragmented_before - report->relocated;
+
+    free(candidates);
+    free(inode_bitmap);
+    return 0;
+}
@@ -1,6 +1,9 @@
 #include "dir.h"
 #include "inode.h"
 #include "bitmap.h"
+#include "diskio.h"
+#include "stats.h"
+#include "snapshot.h"
 #include <unistd.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -8,15 +11,21 @@
 #define MAX_BLOCKS_PER_INODE 10
 
 int dir_create(Disk *disk, uint32_t parent_inode_num, const char *name) {
+    STATS_SCOPE(STATS_DIR_CREATE);
     // 1. Aloca um novo i-node para o diretório
-    uint32_t new_inode_num = inode_alloc();
+    uint32_t new_inode_num = inode_alloc(disk);
+    if (new_inode_num == (uint32_t)-1) {
+        printf("[ERRO] Sem i-nodes livres.\n");
+        return -1;
+    }
     Inode *new_dir = inode_create(040755); // 040755 = modo diretório
     if (!new_dir) return -1;
 
     // 2. Encontra um bloco livre e marca como usado
     uint32_t block_num = bitmap_find_free_block(disk);
     if (block_num == (uint32_t)-1) {
-        free(new_dir);
+        inode_free(disk, new_inode_num);
+        inode_put(new_dir);
         return -1;
     }
     bitmap_set(disk, block_num, 1);
@@ -24,6 +33,9 @@ int dir_create(Disk *disk, uint32_t parent_inode_num, const char *name) {
     // 3. Configura o i-node do novo diretório
     new_dir->blocks[0] = block_num;
     new_dir->size = 2 * DIR_ENTRY_SIZE; // 2 entradas (. e ..)
+    new_dir->parent = parent_inode_num;
+    new_dir->tree_bytes = new_dir->size;
+    new_dir->tree_blocks = 1;
 
     // 4. Cria as entradas padrão
     DirEntry entries[2];
@@ -38,10 +50,11 @@ int dir_create(Disk *disk, uint32_t parent_inode_num, const char *name) {
     entries[1].name[MAX_NAME_LEN - 1] = '\0';
 
     // 5. Escreve as entradas no bloco alocado
-    lseek(disk->fd, block_num * disk->block_size, SEEK_SET);
-    if (write(disk->fd, entries, sizeof(entries)) != sizeof(entries)) {
+    if (stats_pwrite(disk->fd, entries, sizeof(entries), disk_block_offset(disk, block_num)) !=
+        sizeof(entries)) {
         bitmap_set(disk, block_num, 0); // Libera o bloco em caso de erro
-        free(new_dir);
+        inode_free(disk, new_inode_num);
+        inode_put(new_dir);
         return -1;
     }
 
@@ -52,17 +65,24 @@ int dir_create(Disk *disk, uint32_t parent_inode_num, const char *name) {
     if (dir_add_entry(disk, parent_inode_num, new_inode_num, name) != 0) {
         printf("[ERRO] Falha ao adicionar entrada '%s' no diretório pai (inode %u)\n", name, parent_inode_num);
         bitmap_set(disk, block_num, 0); // Libera o bloco
-        free(new_dir);
+        inode_free(disk, new_inode_num);
+        inode_put(new_dir);
         return -1;
     }
 
-    free(new_dir);
+    inode_put(new_dir);
     return 0;
 }
 
 int dir_add_entry(Disk *disk, uint32_t dir_inode_num, uint32_t child_inode_num, const char *name) {
+    STATS_SCOPE(STATS_DIR_ADD_ENTRY);
     Inode *dir_inode = inode_load(disk, dir_inode_num);
     if (!dir_inode) return -1;
+    if ((dir_inode->mode & 040000) != 040000) {
+        printf("[ERRO] Inode %u não é um diretório\n", dir_inode_num);
+        inode_put(dir_inode);
+        return -1;
+    }
 
     uint32_t num_entries = dir_inode->size / DIR_ENTRY_SIZE;
     uint32_t target_block_index = (num_entries * DIR_ENTRY_SIZE) / disk->block_size;
@@ -70,20 +90,23 @@ int dir_add_entry(Disk *disk, uint32_t dir_inode_num, uint32_t child_inode_num,
 
     if (target_block_index >= 10) {
         printf("[ERRO] Diretório cheio! (Limite de 10 blocos por inode)\n");
-        free(dir_inode);
+        inode_put(dir_inode);
         return -1;
     }
 
-    // Se o bloco alvo ainda não foi alocado, aloque agora
+    // Se o bloco alvo ainda não foi alocado, aloque agora (logo após o anterior, se possível)
+    DirUsage usage = {DIR_ENTRY_SIZE, 0, 0};
     if (dir_inode->blocks[target_block_index] == 0) {
-        uint32_t new_block = bitmap_find_free_block(disk);
-        if (new_block == (uint32_t)-1) {
+        if (inode_alloc_blocks(disk, dir_inode, target_block_index, 1) != 0) {
             printf("[ERRO] Sem blocos livres para expandir o diretório.\n");
-            free(dir_inode);
+            inode_put(dir_inode);
             return -1;
         }
-        bitmap_set(disk, new_block, 1);
-        dir_inode->blocks[target_block_index] = new_block;
+        usage.blocks = 1;
+    } else if (snapshot_cow_block(disk, dir_inode, target_block_index, 1) < 0) {
+        // Bloco retido por um snapshot: a entrada vai para uma cópia dele
+        inode_put(dir_inode);
+        return -1;
     }
 
     // Cria a nova entrada de diretório
@@ -94,144 +117,511 @@ int dir_add_entry(Disk *disk, uint32_t dir_inode_num, uint32_t child_inode_num,
     new_entry.name[MAX_NAME_LEN - 1] = '\0';
 
     // Grava a entrada no bloco certo, posição certa
-    lseek(disk->fd, dir_inode->blocks[target_block_index] * disk->block_size + block_offset, SEEK_SET);
-    if (write(disk->fd, &new_entry, sizeof(DirEntry)) != sizeof(DirEntry)) {
+    off_t entry_offset = disk_block_offset(disk, dir_inode->blocks[target_block_index]) + block_offset;
+    if (stats_pwrite(disk->fd, &new_entry, sizeof(DirEntry), entry_offset) != sizeof(DirEntry)) {
         printf("[ERRO] Falha ao escrever entrada de diretório.\n");
-        free(dir_inode);
+        inode_put(dir_inode);
         return -1;
     }
 
     // Atualiza o tamanho do diretório
     dir_inode->size += DIR_ENTRY_SIZE;
     inode_save(disk, dir_inode_num, dir_inode);
-
-    free(dir_inode);
+    inode_put(dir_inode);
+
+    // O diretório passa a contar o filho (e o próprio crescimento) até a raiz.
+    // Um link a mais para um arquivo não conta de novo: os blocos são os mesmos
+    Inode *child = inode_load(disk, child_inode_num);
+    if (child) {
+        int first_link = (child->mode & 0100000) != 0100000 || child->nlink == 0;
+        if (first_link) {
+            DirUsage child_usage;
+            dir_usage_of(child, &child_usage);
+            usage.bytes += child_usage.bytes;
+            usage.blocks += child_usage.blocks;
+            usage.files += child_usage.files;
+            child->parent = dir_inode_num;
+        }
+        child->nlink++;
+        inode_save(disk, child_inode_num, child);
+        inode_put(child);
+    }
+    dir_usage_add(disk, dir_inode_num, &usage, 1);
     return 0;
 }
 
-int dir_list(Disk *disk, uint32_t inode_num) {
-    Inode *dir = inode_load(disk, inode_num);
-    if (!dir) {
-        printf("[ERRO] Não foi possível carregar inode %u\n", inode_num);
-        return -1;
+// Diretório que conta o uso do arquivo: com vários links, o dono gravado em
+// inode->parent; senão o diretório por onde o arquivo foi alcançado
+static uint32_t file_usage_dir(const Inode *inode, uint32_t parent_inode_num) {
+    return inode->nlink > 1 ? inode->parent : parent_inode_num;
+}
+
+void dir_usage_of(const Inode *inode, DirUsage *usage) {
+    if ((inode->mode & 040000) == 040000) {
+        usage->bytes = inode->tree_bytes;
+        usage->blocks = inode->tree_blocks;
+        usage->files = inode->tree_files;
+        return;
+    }
+    usage->bytes = inode->size;
+    usage->blocks = 0;
+    for (uint32_t i = 0; i < MAX_BLOCKS_PER_INODE; i++) {
+        if (inode->blocks[i] != 0) usage->blocks++;
     }
+    usage->files = inode->mode != 0;
+}
 
-    // Garante que o inode seja de diretório
-    if ((dir->mode & 040000) != 040000) {
-        printf("[ERRO] Inode %u não é um diretório (mode: %o).\n", inode_num, dir->mode);
-        free(dir);
+void dir_usage_add(Disk *disk, uint32_t dir_inode_num, const DirUsage *usage, int sign) {
+    STATS_SCOPE(STATS_DIR_USAGE_ADD);
+    uint32_t current = dir_inode_num;
+    // O limite de passos evita um laço sem fim se os ponteiros de pai estiverem corrompidos
+    for (uint32_t steps = 0; steps < disk->sb->inode_count; steps++) {
+        Inode *dir = inode_load(disk, current);
+        if (!dir) return;
+        if ((dir->mode & 040000) != 040000) {
+            inode_put(dir);
+            return;
+        }
+        dir->tree_bytes += sign * usage->bytes;
+        dir->tree_blocks += sign * usage->blocks;
+        dir->tree_files += sign * usage->files;
+        inode_save(disk, current, dir);
+        uint32_t parent = dir->parent;
+        inode_put(dir);
+        if (parent == current) return; // Raiz
+        current = parent;
+    }
+}
+
+// Lê de uma vez (um lote no motor de E/S) todos os blocos do diretório.
+// valid[b] indica se o bloco b está alocado e foi lido por inteiro
+static DirEntry *dir_read_blocks(Disk *disk, Inode *dir, uint8_t valid[MAX_BLOCKS_PER_INODE]) {
+    uint32_t num_blocks = (dir->size + disk->block_size - 1) / disk->block_size;
+    if (num_blocks > MAX_BLOCKS_PER_INODE) num_blocks = MAX_BLOCKS_PER_INODE;
+    uint8_t *buffer = calloc(num_blocks ? num_blocks : 1, disk->block_size);
+    DiskIoReq reqs[MAX_BLOCKS_PER_INODE];
+
+    memset(valid, 0, MAX_BLOCKS_PER_INODE);
+    for (uint32_t b = 0; b < num_blocks; b++) {
+        if (dir->blocks[b] == 0) continue;
+        reqs[b] = (DiskIoReq){DISK_IO_READ, buffer + (size_t)b * disk->block_size, disk->block_size,
+                              disk_block_offset(disk, dir->blocks[b]), 0, 0};
+        disk_io_submit(disk, &reqs[b]);
+        valid[b] = 1;
+    }
+    disk_io_wait(disk);
+    for (uint32_t b = 0; b < num_blocks; b++) {
+        if (valid[b] && reqs[b].result != (ssize_t)disk->block_size) valid[b] = 0;
+    }
+    return (DirEntry *)buffer;
+}
+
+int dir_iter_open(Disk *disk, uint32_t dir_inode_num, int flags, DirIter *it) {
+    STATS_SCOPE(STATS_DIR_ITER_OPEN);
+    memset(it, 0, sizeof(DirIter));
+    it->dir = inode_load(disk, dir_inode_num);
+    if (!it->dir) return -1;
+    if ((it->dir->mode & 040000) != 040000) {
+        inode_put(it->dir);
+        it->dir = NULL;
         return -1;
     }
+    it->disk = disk;
+    it->dir_num = dir_inode_num;
+    it->flags = flags;
+    it->num_entries = it->dir->size / DIR_ENTRY_SIZE;
+    uint32_t limit = MAX_BLOCKS_PER_INODE * (disk->block_size / DIR_ENTRY_SIZE);
+    if (it->num_entries > limit) {
+        it->bad += it->num_entries - limit;
+        it->num_entries = limit;
+    }
+    it->entries = dir_read_blocks(disk, it->dir, it->valid);
+    it->plus_block = (uint32_t)-1;
+    if (flags & DIR_ITER_PLUS) it->inodes = malloc((disk->block_size / DIR_ENTRY_SIZE) * sizeof(Inode));
+    return 0;
+}
+
+// Modo plus: carrega em um lote os i-nodes de todas as entradas do bloco
+static void dir_iter_prefetch(DirIter *it, uint32_t block_idx) {
+    uint32_t per_block = it->disk->block_size / DIR_ENTRY_SIZE;
+    uint32_t first = block_idx * per_block;
+    uint32_t nums[per_block], slots[per_block], count = 0;
+    Inode *loaded = malloc(per_block * sizeof(Inode));
+
+    memset(it->inodes, 0, per_block * sizeof(Inode));
+    for (uint32_t e = 0; e < per_block && first + e < it->num_entries; e++) {
+        DirEntry *entry = &it->entries[first + e];
+        if (entry->name[0] == '\0' || entry->inode_num >= it->disk->sb->inode_count) continue;
+        nums[count] = entry->inode_num;
+        slots[count++] = e;
+    }
+    inode_load_many(it->disk, nums, count, loaded);
+    for (uint32_t k = 0; k < count; k++) it->inodes[slots[k]] = loaded[k];
+    free(loaded);
+    it->plus_block = block_idx;
+}
 
-    uint32_t num_entries = dir->size / DIR_ENTRY_SIZE;
+DirEntry *dir_iter_next(DirIter *it, Inode **inode) {
+    STATS_SCOPE(STATS_DIR_ITER_NEXT);
+    uint32_t per_block = it->disk->block_size / DIR_ENTRY_SIZE;
+    while (it->next < it->num_entries) {
+        uint32_t i = it->next++;
+        uint32_t block_idx = i / per_block;
+        if (!it->valid[block_idx]) {
+            it->bad++;
+            continue;
+        }
+        DirEntry *entry = &it->entries[i];
+        if (entry->name[0] == '\0') continue; // Entrada removida
+        entry->name[MAX_NAME_LEN - 1] = '\0';
+
+        if (it->flags & DIR_ITER_PLUS) {
+            if (it->plus_block != block_idx) dir_iter_prefetch(it, block_idx);
+            if (inode) *inode = &it->inodes[i % per_block];
+        }
+        it->pos = i;
+        return entry;
+    }
+    return NULL;
+}
+
+int dir_iter_update(DirIter *it) {
+    STATS_SCOPE(STATS_DIR_ITER_UPDATE);
+    Disk *disk = it->disk;
+    uint32_t block_idx = (it->pos * DIR_ENTRY_SIZE) / disk->block_size;
+    uint32_t offset_in_block = (it->pos * DIR_ENTRY_SIZE) % disk->block_size;
+    // Bloco retido por um snapshot: o diretório passa a usar uma cópia
+    int moved = snapshot_cow_block(disk, it->dir, block_idx, 1);
+    if (moved < 0) return -1;
+    if (moved) inode_save(disk, it->dir_num, it->dir);
+    off_t offset = disk_block_offset(disk, it->dir->blocks[block_idx]) + offset_in_block;
+    if (stats_pwrite(disk->fd, &it->entries[it->pos], sizeof(DirEntry), offset) != sizeof(DirEntry)) return -1;
+    return 0;
+}
+
+void dir_iter_close(DirIter *it) {
+    free(it->entries);
+    free(it->inodes);
+    inode_put(it->dir);
+    memset(it, 0, sizeof(DirIter));
+}
+
+int dir_find_entry(Disk *disk, uint32_t dir_inode_num, uint32_t child_inode_num, char name[MAX_NAME_LEN]) {
+    STATS_SCOPE(STATS_DIR_FIND_ENTRY);
+    DirIter it;
+    if (dir_iter_open(disk, dir_inode_num, 0, &it) != 0) return -1;
+    DirEntry *entry;
+    int found = -1;
+    while ((entry = dir_iter_next(&it, NULL))) {
+        if (entry->inode_num == child_inode_num) {
+            strncpy(name, entry->name, MAX_NAME_LEN);
+            found = 0;
+            break;
+        }
+    }
+    dir_iter_close(&it);
+    return found;
+}
+
+uint32_t dir_lookup(Disk *disk, uint32_t dir_inode_num, const char *name) {
+    STATS_SCOPE(STATS_DIR_LOOKUP);
+    DirIter it;
+    if (dir_iter_open(disk, dir_inode_num, 0, &it) != 0) return (uint32_t)-1;
+    DirEntry *entry;
+    uint32_t found = (uint32_t)-1;
+    while ((entry = dir_iter_next(&it, NULL))) {
+        if (strncmp(entry->name, name, MAX_NAME_LEN - 1) == 0) {
+            found = entry->inode_num;
+            break;
+        }
+    }
+    dir_iter_close(&it);
+    return found;
+}
+
+int dir_list(Disk *disk, uint32_t inode_num) {
+    STATS_SCOPE(STATS_DIR_LIST);
+    DirIter it;
+    if (dir_iter_open(disk, inode_num, 0, &it) != 0) {
+        printf("[ERRO] Inode %u não é um diretório.\n", inode_num);
+        return -1;
+    }
     //printf("Conteúdo do diretório (inode %u):\n", inode_num);
     
-    if (num_entries == 0) {
+    if (it.num_entries == 0) {
         printf("  (vazio)\n");
-        free(dir);
+        dir_iter_close(&it);
         return 0;
     }
 
-    // Lê entrada por entrada para evitar problemas de buffer
-    for (uint32_t i = 0; i < num_entries; i++) {
-        uint32_t block_idx = (i * DIR_ENTRY_SIZE) / disk->block_size;
-        uint32_t offset_in_block = (i * DIR_ENTRY_SIZE) % disk->block_size;
-        
-        if (block_idx >= 10 || dir->blocks[block_idx] == 0) {
-            printf("  [ERRO] Entrada %u: bloco não alocado ou inválido\n", i);
-            continue;
-        }
-
-        DirEntry entry;
-        memset(&entry, 0, sizeof(DirEntry));
-        
-        // Lê a entrada específica
-        lseek(disk->fd, dir->blocks[block_idx] * disk->block_size + offset_in_block, SEEK_SET);
-        ssize_t bytes_read = read(disk->fd, &entry, sizeof(DirEntry));
-        
-        if (bytes_read != sizeof(DirEntry)) {
-            printf("  [ERRO] Entrada %u: falha na leitura (%zd bytes lidos)\n", i, bytes_read);
-            continue;
-        }
-        
+    DirEntry *entry;
+    while ((entry = dir_iter_next(&it, NULL))) {
         // Verifica se a entrada é válida
-        if (entry.name[0] == '\0') {
-            //printf("  [ERRO] Entrada %u: nome vazio\n", i);
-        } else if (entry.name[0] < 32 || entry.name[0] > 126) {
-            printf("  [ERRO] Entrada %u: nome corrompido (primeiro char: %d)\n", i, entry.name[0]);
+        if (entry->name[0] < 32 || entry->name[0] > 126) {
+            printf("  [ERRO] Entrada %u: nome corrompido (primeiro char: %d)\n", it.pos, entry->name[0]);
         } else {
-            // Garante que o nome seja terminado em null
-            entry.name[MAX_NAME_LEN - 1] = '\0';
-            printf("  [%u] %s\n", entry.inode_num, entry.name);
+            printf("  [%u] %s\n", entry->inode_num, entry->name);
         }
     }
+    if (it.bad) printf("  [ERRO] %u entradas em blocos não alocados ou ilegíveis\n", it.bad);
 
-    free(dir);
+    dir_iter_close(&it);
     return 0;
 }
 
+uint32_t file_create_data(Disk *disk, uint32_t parent_inode_num, const char *fs_filename,
+                          const uint8_t *data, uint32_t len) {
+    STATS_SCOPE(STATS_FILE_CREATE_DATA);
+    if (len > MAX_BLOCKS_PER_INODE * disk->block_size) {
+        printf("[ERRO] Arquivo muito grande! (Limite de 10 blocos)\n");
+        return (uint32_t)-1;
+    }
+
+    // 1. Aloca um inode para o arquivo
+    uint32_t new_inode_num = inode_alloc(disk);
+    if (new_inode_num == (uint32_t)-1) {
+        printf("[ERRO] Sem i-nodes livres!\n");
+        return (uint32_t)-1;
+    }
+    Inode *inode = inode_create(0100644);  // Modo arquivo regular (rw-r--r--)
+    inode->size = len;
+
+    // 2. Reserva só os blocos com dados (blocos zerados viram buracos) em
+    // trechos contíguos e escreve no disco virtual
+    if (inode_write_sparse(disk, inode, data, len) != 0) {
+        printf("[ERRO] Sem blocos livres ou falha ao escrever dados do arquivo\n");
+        inode_free(disk, new_inode_num);
+        inode_put(inode);
+        return (uint32_t)-1;
+    }
+
+    // 3. Salva o inode
+    inode_save(disk, new_inode_num, inode);
+
+    // 4. Adiciona a entrada no diretório pai
+    if (dir_add_entry(disk, parent_inode_num, new_inode_num, fs_filename) != 0) {
+        printf("[ERRO] Falha ao adicionar arquivo '%s' no diretório\n", fs_filename);
+        for (uint32_t i = 0; i < MAX_BLOCKS_PER_INODE; i++) {
+            if (inode->blocks[i] != 0) bitmap_set(disk, inode->blocks[i], 0);
+        }
+        inode_free(disk, new_inode_num);
+        inode_put(inode);
+        return (uint32_t)-1;
+    }
+
+    inode_put(inode);
+    return new_inode_num;
+}
+
 int file_create(Disk *disk, uint32_t parent_inode_num, const char *host_filename, const char *fs_filename) {
+    STATS_SCOPE(STATS_FILE_CREATE);
     FILE *src = fopen(host_filename, "rb");
     if (!src) {
         printf("[ERRO] Não foi possível abrir o arquivo de origem: %s\n", host_filename);
         return -1;
     }
 
-    // 1. Aloca um inode para o arquivo
-    uint32_t new_inode_num = inode_alloc();
-    Inode *inode = inode_create(0100644);  // Modo arquivo regular (rw-r--r--)
+    // Descobre quantos blocos o arquivo vai ocupar
+    fseek(src, 0, SEEK_END);
+    long host_size = ftell(src);
+    rewind(src);
+    uint32_t num_blocks = (host_size + disk->block_size - 1) / disk->block_size;
 
-    // 2. Lê o conteúdo do arquivo real e escreve nos blocos do disco virtual
-    uint8_t buffer[disk->block_size];
-    size_t bytes_read;
-    uint32_t block_index = 0;
+    if (num_blocks > 10) {
+        printf("[ERRO] Arquivo muito grande! (Limite de 10 blocos)\n");
+        fclose(src);
+        return -1;
+    }
 
-    while ((bytes_read = fread(buffer, 1, disk->block_size, src)) > 0) {
-        if (block_index >= 10) {
-            printf("[ERRO] Arquivo muito grande! (Limite de 10 blocos)\n");
-            free(inode);
-            fclose(src);
-            return -1;
-        }
+    // Lê o conteúdo do arquivo real (buffer alinhado do pool, pronto para O_DIRECT)
+    uint8_t *buffer = disk_buf_get(disk);
+    size_t bytes_read = fread(buffer, 1, num_blocks * disk->block_size, src);
+    fclose(src);
 
-        uint32_t block_num = bitmap_find_free_block(disk);
-        if (block_num == (uint32_t)-1) {
-            printf("[ERRO] Sem blocos livres!\n");
-            free(inode);
-            fclose(src);
-            return -1;
-        }
+    uint32_t inode_num = file_create_data(disk, parent_inode_num, fs_filename, buffer, (uint32_t)bytes_read);
+    disk_buf_put(disk, buffer);
+    return inode_num == (uint32_t)-1 ? -1 : 0;
+}
 
-        bitmap_set(disk, block_num, 1);
-        inode->blocks[block_index++] = block_num;
-        inode->size += bytes_read;
+// Lê os blocos do arquivo para buffer (buracos ficam como zeros, sem ler o disco).
+// Retorna quantos bytes, a partir do início, foram lidos sem erro
+static uint32_t file_read_blocks(Disk *disk, const Inode *inode, uint8_t *buffer) {
+    uint64_t limit = (uint64_t)MAX_BLOCKS_PER_INODE * disk->block_size;
+    uint32_t size = inode->size < limit ? inode->size : (uint32_t)limit;
+    memset(buffer, 0, MAX_BLOCKS_PER_INODE * disk->block_size);
+    DiskIoReq reqs[MAX_BLOCKS_PER_INODE];
+    uint32_t num_reqs = 0;
+    uint32_t block_index = 0;
 
-        lseek(disk->fd, block_num * disk->block_size, SEEK_SET);
-        if (write(disk->fd, buffer, bytes_read) != (ssize_t)bytes_read) {
-            printf("[ERRO] Falha ao escrever dados do arquivo\n");
-            free(inode);
-            fclose(src);
-            return -1;
+    // Cada trecho de blocos consecutivos no disco vira um pedido; todos vão em um lote
+    while ((uint64_t)block_index * disk->block_size < size) {
+        uint32_t block_num = inode->blocks[block_index];
+        if (block_num == 0) {
+            block_index++;
+            continue;
+        }
+        uint32_t offset = block_index * disk->block_size;
+        uint32_t run = 1;
+        while (block_index + run < MAX_BLOCKS_PER_INODE && offset + run * disk->block_size < size &&
+               inode->blocks[block_index + run] == block_num + run) {
+            run++;
+        }
+        // O último trecho é lido até o fim do setor, para continuar alinhado
+        uint32_t to_read = run * disk->block_size;
+        uint32_t tail = (size - offset + DISK_SECTOR_SIZE - 1) / DISK_SECTOR_SIZE * DISK_SECTOR_SIZE;
+        if (to_read > tail) to_read = tail;
+
+        reqs[num_reqs] = (DiskIoReq){DISK_IO_READ, buffer + offset, to_read, disk_block_offset(disk, block_num), 0, 0};
+        disk_io_submit(disk, &reqs[num_reqs++]);
+        block_index += run;
+    }
+    disk_io_wait(disk);
+
+    // Válido em ordem até o primeiro trecho que falhou
+    uint32_t valid = size;
+    for (uint32_t r = 0; r < num_reqs; r++) {
+        if (reqs[r].result != (ssize_t)reqs[r].len) {
+            uint32_t start = (uint32_t)((uint8_t *)reqs[r].buf - buffer);
+            if (start < valid) valid = start;
         }
     }
+    return valid;
+}
 
-    fclose(src);
+int file_read_data(Disk *disk, uint32_t inode_num, uint8_t *buffer) {
+    STATS_SCOPE(STATS_FILE_READ_DATA);
+    Inode *inode = inode_load(disk, inode_num);
+    if (!inode) return -1;
+    if ((inode->mode & 0100000) == 0) {
+        inode_put(inode);
+        return -1;
+    }
+    uint32_t valid = file_read_blocks(disk, inode, buffer);
+    inode_put(inode);
+    return (int)valid;
+}
 
-    // 3. Salva o inode
-    inode_save(disk, new_inode_num, inode);
+int file_write_data(Disk *disk, uint32_t parent_inode_num, uint32_t inode_num, uint32_t offset,
+                    const uint8_t *data, uint32_t len) {
+    STATS_SCOPE(STATS_FILE_WRITE_DATA);
+    uint32_t max = MAX_BLOCKS_PER_INODE * disk->block_size;
+    if (offset > max || len > max - offset) return -1;
+    Inode *inode = inode_load(disk, inode_num);
+    if (!inode) return -1;
+    if ((inode->mode & 0100000) == 0) {
+        inode_put(inode);
+        return -1;
+    }
+    if (len == 0) {
+        inode_put(inode);
+        return 0;
+    }
 
-    // 4. Adiciona a entrada no diretório pai
-    if (dir_add_entry(disk, parent_inode_num, new_inode_num, fs_filename) != 0) {
-        printf("[ERRO] Falha ao adicionar arquivo '%s' no diretório\n", fs_filename);
-        free(inode);
+    // Conteúdo atual dos blocos afetados; o que estiver após o fim vira zero
+    uint8_t *buffer = disk_buf_get(disk);
+    uint32_t old_size = inode->size < max ? inode->size : max;
+    if (file_read_blocks(disk, inode, buffer) < old_size) {
+        disk_buf_put(disk, buffer);
+        inode_put(inode);
         return -1;
     }
+    memset(buffer + old_size, 0, max - old_size);
+    memcpy(buffer + offset, data, len);
+
+    DirUsage before;
+    dir_usage_of(inode, &before);
+
+    // Buracos dentro do trecho escrito recebem blocos, um pedido por sequência
+    uint32_t first = offset / disk->block_size;
+    uint32_t last = (offset + len - 1) / disk->block_size;
+    uint8_t holes[MAX_BLOCKS_PER_INODE] = {0};
+    for (uint32_t i = first; i <= last; i++) holes[i] = inode->blocks[i] == 0;
+    for (uint32_t i = first; i <= last; i++) {
+        if (inode->blocks[i] != 0) continue;
+        uint32_t run = 1;
+        while (i + run <= last && inode->blocks[i + run] == 0) run++;
+        if (inode_alloc_blocks(disk, inode, i, run) != 0) {
+            // Devolve os blocos reservados até aqui e mantém o arquivo como estava
+            for (uint32_t j = first; j < i; j++) {
+                if (holes[j] && inode->blocks[j] != 0) {
+                    bitmap_set(disk, inode->blocks[j], 0);
+                    inode->blocks[j] = 0;
+                }
+            }
+            disk_buf_put(disk, buffer);
+            inode_put(inode);
+            return -1;
+        }
+        i += run - 1;
+    }
+
+    uint32_t count = last - first + 1;
+    int result = inode_write_blocks(disk, inode, first, count, buffer + first * disk->block_size,
+                                    count * disk->block_size);
+    disk_buf_put(disk, buffer);
+    if (offset + len > inode->size) inode->size = offset + len;
+    inode->modified_at = time(NULL);
+    inode_save(disk, inode_num, inode);
+
+    // O pai (e seus ancestrais) passam a contar o novo tamanho e os novos blocos
+    DirUsage after;
+    dir_usage_of(inode, &after);
+    after.bytes -= before.bytes;
+    after.blocks -= before.blocks;
+    after.files = 0;
+    if (after.bytes != 0 || after.blocks != 0) dir_usage_add(disk, file_usage_dir(inode, parent_inode_num), &after, 1);
+    inode_put(inode);
+    return result;
+}
 
-    free(inode);
+int file_truncate(Disk *disk, uint32_t parent_inode_num, uint32_t inode_num, uint32_t size) {
+    STATS_SCOPE(STATS_FILE_TRUNCATE);
+    if (size > MAX_BLOCKS_PER_INODE * disk->block_size) return -1;
+    Inode *inode = inode_load(disk, inode_num);
+    if (!inode) return -1;
+    if ((inode->mode & 0100000) == 0) {
+        inode_put(inode);
+        return -1;
+    }
+
+    DirUsage before;
+    dir_usage_of(inode, &before);
+    if (size < inode->size) {
+        uint32_t keep = (size + disk->block_size - 1) / disk->block_size;
+        // O fim do último bloco volta a ser zero: se o arquivo crescer de novo,
+        // os bytes antigos não reaparecem
+        uint32_t tail = size % disk->block_size;
+        if (tail && inode->blocks[keep - 1] != 0) {
+            uint8_t *buffer = disk_buf_get(disk);
+            file_read_blocks(disk, inode, buffer);
+            uint8_t *last = buffer + (keep - 1) * disk->block_size;
+            memset(last + tail, 0, disk->block_size - tail);
+            inode_write_blocks(disk, inode, keep - 1, 1, last, disk->block_size);
+            disk_buf_put(disk, buffer);
+        }
+        for (uint32_t i = keep; i < MAX_BLOCKS_PER_INODE; i++) {
+            if (inode->blocks[i] == 0) continue;
+            bitmap_set(disk, inode->blocks[i], 0);
+            inode->blocks[i] = 0;
+        }
+    }
+    // Crescer só muda o tamanho: o trecho novo é um buraco
+    inode->size = size;
+    inode->modified_at = time(NULL);
+    inode_save(disk, inode_num, inode);
+
+    DirUsage after;
+    dir_usage_of(inode, &after);
+    after.bytes -= before.bytes;
+    after.blocks -= before.blocks;
+    after.files = 0;
+    if (after.bytes != 0 || after.blocks != 0) dir_usage_add(disk, file_usage_dir(inode, parent_inode_num), &after, 1);
+    inode_put(inode);
     return 0;
 }
 
 int file_read(Disk *disk, uint32_t inode_num) {
+    STATS_SCOPE(STATS_FILE_READ);
     Inode *inode = inode_load(disk, inode_num);
     if (!inode) {
         printf("[ERRO] Não foi possível carregar o inode %u\n", inode_num);
@@ -240,135 +630,99 @@ int file_read(Disk *disk, uint32_t inode_num) {
 
     if ((inode->mode & 0100000) == 0) {
         printf("[ERRO] Inode %u não é um arquivo regular (mode: %o).\n", inode_num, inode->mode);
-        free(inode);
+        inode_put(inode);
         return -1;
     }
 
     printf("[INFO] Conteúdo do arquivo (inode %u):\n", inode_num);
 
-    uint8_t buffer[disk->block_size];
-    uint32_t remaining = inode->size;
-    uint32_t block_index = 0;
+    uint64_t limit = (uint64_t)MAX_BLOCKS_PER_INODE * disk->block_size;
+    uint32_t size = inode->size < limit ? inode->size : (uint32_t)limit;
+    uint8_t *buffer = disk_buf_get(disk);
+    uint32_t valid = file_read_blocks(disk, inode, buffer);
 
-    while (remaining > 0 && block_index < 10) {
-        if (inode->blocks[block_index] == 0) {
-            printf("[ERRO] Bloco %u não alocado para o arquivo\n", block_index);
-            break;
-        }
+    // Saída em ordem até o primeiro trecho que falhou
+    fwrite(buffer, 1, valid, stdout);
+    if (valid < size) printf("[ERRO] Falha ao ler bloco %u do arquivo\n", valid / disk->block_size);
 
-        uint32_t block_num = inode->blocks[block_index];
-        uint32_t to_read = (remaining > disk->block_size) ? disk->block_size : remaining;
+    disk_buf_put(disk, buffer);
+    printf("\n");
+    inode_put(inode);
+    return 0;
+}
+
+uint32_t file_seek(Disk *disk, uint32_t inode_num, uint32_t offset, int whence) {
+    STATS_SCOPE(STATS_FILE_SEEK);
+    Inode *inode = inode_load(disk, inode_num);
+    if (!inode) return (uint32_t)-1;
+    if ((inode->mode & 0100000) == 0 || offset >= inode->size) {
+        inode_put(inode);
+        return (uint32_t)-1;
+    }
+
+    // Só o mapa de blocos é consultado: nenhum dado é lido
+    uint32_t count = (inode->size + disk->block_size - 1) / disk->block_size;
+    if (count > MAX_BLOCKS_PER_INODE) count = MAX_BLOCKS_PER_INODE;
+    uint32_t found = (whence == FILE_SEEK_HOLE) ? inode->size : (uint32_t)-1;
 
-        lseek(disk->fd, block_num * disk->block_size, SEEK_SET);
-        ssize_t bytes_read = read(disk->fd, buffer, to_read);
-        
-        if (bytes_read <= 0) {
-            printf("[ERRO] Falha ao ler bloco %u do arquivo\n", block_index);
+    for (uint32_t i = offset / disk->block_size; i < count; i++) {
+        int is_hole = (inode->blocks[i] == 0);
+        if (is_hole == (whence == FILE_SEEK_HOLE)) {
+            uint32_t pos = i * disk->block_size;
+            found = pos > offset ? pos : offset;
             break;
         }
-
-        fwrite(buffer, 1, bytes_read, stdout);
-        remaining -= bytes_read;
-        block_index++;
     }
 
-    printf("\n");
-    free(inode);
-    return 0;
+    inode_put(inode);
+    return found;
 }
 
 int dir_list_detailed(Disk *disk, uint32_t inode_num) {
-    Inode *dir = inode_load(disk, inode_num);
-    if (!dir) {
-        printf("[ERRO] Não foi possível carregar inode %u\n", inode_num);
-        return -1;
-    }
-
-    if ((dir->mode & 040000) != 040000) {
+    STATS_SCOPE(STATS_DIR_LIST_DETAILED);
+    // Modo plus: os i-nodes de cada bloco de entradas chegam em um lote
+    DirIter it;
+    if (dir_iter_open(disk, inode_num, DIR_ITER_PLUS, &it) != 0) {
         printf("[ERRO] Inode %u não é um diretório.\n", inode_num);
-        free(dir);
         return -1;
     }
 
-    uint32_t num_entries = dir->size / DIR_ENTRY_SIZE;
     printf("Conteúdo detalhado do diretório (inode %u):\n", inode_num);
 
-    for (uint32_t i = 0; i < num_entries; i++) {
-        uint32_t block_idx = (i * DIR_ENTRY_SIZE) / disk->block_size;
-        uint32_t offset_in_block = (i * DIR_ENTRY_SIZE) % disk->block_size;
-
-        if (block_idx >= 10 || dir->blocks[block_idx] == 0) {
-            printf("  [ERRO] Entrada %u: bloco não alocado ou inválido\n", i);
-            continue;
-        }
-
-        DirEntry entry;
-        lseek(disk->fd, dir->blocks[block_idx] * disk->block_size + offset_in_block, SEEK_SET);
-        ssize_t bytes_read = read(disk->fd, &entry, sizeof(DirEntry));
-
-        if (bytes_read != sizeof(DirEntry) || entry.name[0] == '\0') {
-            continue; // ignora entradas inválidas
-        }
-
-        Inode *entry_inode = inode_load(disk, entry.inode_num);
-        if (!entry_inode) {
-            printf("  [%u] %s - [ERRO ao carregar inode]\n", entry.inode_num, entry.name);
-            continue;
-        }
-
+    DirEntry *entry;
+    Inode *entry_inode;
+    while ((entry = dir_iter_next(&it, &entry_inode))) {
         // Exibe informações
         printf("  [%u] %-15s | Tamanho: %u bytes | Criado em: %s",
-               entry.inode_num,
-               entry.name,
+               entry->inode_num,
+               entry->name,
                entry_inode->size,
                ctime(&entry_inode->created_at));
-
-        free(entry_inode);
     }
+    if (it.bad) printf("  [ERRO] %u entradas em blocos não alocados ou ilegíveis\n", it.bad);
 
-    free(dir);
+    dir_iter_close(&it);
     return 0;
 }
 
 int dir_list_dirs(Disk *disk, uint32_t inode_num) {
-    Inode *dir = inode_load(disk, inode_num);
-    if (!dir) {
-        printf("[ERRO] Não foi possível carregar inode %u\n", inode_num);
-        return -1;
-    }
-
-    if ((dir->mode & 040000) != 040000) {
+    STATS_SCOPE(STATS_DIR_LIST_DIRS);
+    DirIter it;
+    if (dir_iter_open(disk, inode_num, DIR_ITER_PLUS, &it) != 0) {
         printf("[ERRO] Inode %u não é um diretório.\n", inode_num);
-        free(dir);
         return -1;
     }
 
-    uint32_t num_entries = dir->size / DIR_ENTRY_SIZE;
     printf("Diretórios dentro do inode %u:\n", inode_num);
 
-    for (uint32_t i = 0; i < num_entries; i++) {
-        uint32_t block_idx = (i * DIR_ENTRY_SIZE) / disk->block_size;
-        uint32_t offset_in_block = (i * DIR_ENTRY_SIZE) % disk->block_size;
-
-        if (block_idx >= 10 || dir->blocks[block_idx] == 0)
-            continue;
-
-        DirEntry entry;
-        lseek(disk->fd, dir->blocks[block_idx] * disk->block_size + offset_in_block, SEEK_SET);
-        ssize_t bytes_read = read(disk->fd, &entry, sizeof(DirEntry));
-        if (bytes_read != sizeof(DirEntry)) continue;
-        if (entry.name[0] == '\0') continue;
-
-        Inode *entry_inode = inode_load(disk, entry.inode_num);
-        if (!entry_inode) continue;
-
+    DirEntry *entry;
+    Inode *entry_inode;
+    while ((entry = dir_iter_next(&it, &entry_inode))) {
         if ((entry_inode->mode & 040000) == 040000) {  // É diretório
-            printf("  [%u] %s\n", entry.inode_num, entry.name);
+            printf("  [%u] %s\n", entry->inode_num, entry->name);
         }
-
-        free(entry_inode);
     }
-    free(dir);
+    dir_iter_close(&it);
     return 0;
 }
 
@@ -399,172 +753,140 @@ uint32_t navegar_diretorios(Disk *disk, uint32_t starting_inode) {
         Inode *inode = inode_load(disk, proximo_inode);
         if (!inode || (inode->mode & 040000) != 040000) {
             printf("[ERRO] O inode %u não é um diretório válido.\n", proximo_inode);
-            if (inode) free(inode);
+            if (inode) inode_put(inode);
             continue;
         }
 
-        free(inode);
+        inode_put(inode);
         current_inode = proximo_inode; // navega para o próximo diretório
     }
 }
 
 int dir_rename_entry(Disk *disk, uint32_t parent_inode_num, uint32_t child_inode_num, const char *novo_nome) {
-    Inode *parent_inode = inode_load(disk, parent_inode_num);
-    if (!parent_inode) return -1;
-
-    if ((parent_inode->mode & 040000) != 040000) {
+    STATS_SCOPE(STATS_DIR_RENAME_ENTRY);
+    DirIter it;
+    if (dir_iter_open(disk, parent_inode_num, 0, &it) != 0) {
         printf("[ERRO] Inode %u não é um diretório.\n", parent_inode_num);
-        free(parent_inode);
         return -1;
     }
 
-    uint32_t num_entries = parent_inode->size / DIR_ENTRY_SIZE;
-
-    for (uint32_t i = 0; i < num_entries; i++) {
-        uint32_t block_idx = (i * DIR_ENTRY_SIZE) / disk->block_size;
-        uint32_t offset_in_block = (i * DIR_ENTRY_SIZE) % disk->block_size;
-
-        if (block_idx >= 10 || parent_inode->blocks[block_idx] == 0)
-            continue;
-
-        DirEntry entry;
-        lseek(disk->fd, parent_inode->blocks[block_idx] * disk->block_size + offset_in_block, SEEK_SET);
-        ssize_t bytes_read = read(disk->fd, &entry, sizeof(DirEntry));
-        if (bytes_read != sizeof(DirEntry)) continue;
-
-        if (entry.inode_num == child_inode_num) {
+    DirEntry *entry;
+    while ((entry = dir_iter_next(&it, NULL))) {
+        if (entry->inode_num == child_inode_num) {
             // Renomear
-            strncpy(entry.name, novo_nome, MAX_NAME_LEN - 1);
-            entry.name[MAX_NAME_LEN - 1] = '\0';
-
-            lseek(disk->fd, parent_inode->blocks[block_idx] * disk->block_size + offset_in_block, SEEK_SET);
-            if (write(disk->fd, &entry, sizeof(DirEntry)) != sizeof(DirEntry)) {
-                printf("[ERRO] Falha ao escrever a entrada renomeada.\n");
-                free(parent_inode);
-                return -1;
-            }
+            memset(entry->name, 0, sizeof(entry->name));
+            strncpy(entry->name, novo_nome, MAX_NAME_LEN - 1);
 
-            free(parent_inode);
-            return 0;  // sucesso
+            int result = dir_iter_update(&it);
+            if (result != 0) printf("[ERRO] Falha ao escrever a entrada renomeada.\n");
+            dir_iter_close(&it);
+            return result;
         }
     }
 
-    free(parent_inode);
+    dir_iter_close(&it);
     printf("[ERRO] Entrada com inode %u não encontrada no diretório %u.\n", child_inode_num, parent_inode_num);
     return -1;
 }
 
 int dir_remove_entry(Disk *disk, uint32_t dir_inode_num, uint32_t target_inode_num) {
-    Inode *dir_inode = inode_load(disk, dir_inode_num);
-    if (!dir_inode) return -1;
-
-    if ((dir_inode->mode & 040000) != 040000) {
-        free(dir_inode);
-        return -1;
-    }
-
-    uint32_t num_entries = dir_inode->size / DIR_ENTRY_SIZE;
-    int found = 0;
-
-    for (uint32_t i = 0; i < num_entries; i++) {
-        uint32_t block_idx = (i * DIR_ENTRY_SIZE) / disk->block_size;
-        uint32_t offset_in_block = (i * DIR_ENTRY_SIZE) % disk->block_size;
-
-        if (block_idx >= MAX_BLOCKS_PER_INODE || dir_inode->blocks[block_idx] == 0)
-            continue;
-
-        DirEntry entry;
-        lseek(disk->fd, dir_inode->blocks[block_idx] * disk->block_size + offset_in_block, SEEK_SET);
-        ssize_t bytes_read = read(disk->fd, &entry, sizeof(DirEntry));
-        if (bytes_read != sizeof(DirEntry)) continue;
-
-        if (entry.inode_num == target_inode_num) {
+    STATS_SCOPE(STATS_DIR_REMOVE_ENTRY);
+    DirIter it;
+    if (dir_iter_open(disk, dir_inode_num, 0, &it) != 0) return -1;
+
+    DirEntry *entry;
+    int result = -1;
+    while ((entry = dir_iter_next(&it, NULL))) {
+        if (entry->inode_num == target_inode_num) {
             // Para "remover", vamos zerar o nome para invalidar a entrada
-            memset(&entry.name, 0, sizeof(entry.name));
-            entry.inode_num = 0;
-
-            lseek(disk->fd, dir_inode->blocks[block_idx] * disk->block_size + offset_in_block, SEEK_SET);
-            if (write(disk->fd, &entry, sizeof(DirEntry)) != sizeof(DirEntry)) {
-                free(dir_inode);
-                return -1;
-            }
-            found = 1;
+            memset(entry, 0, sizeof(DirEntry));
+            result = dir_iter_update(&it);
             break;
         }
     }
 
-    free(dir_inode);
-
-    if (!found) return -1;
-
-    return 0;
+    dir_iter_close(&it);
+
+    // A subárvore deixa de ser contada no diretório e nos ancestrais. Um
+    // arquivo com outros links só sai do uso se este diretório era o dono, e
+    // passa a ser contado em outro diretório que ainda aponta para ele
+    Inode *target = (result == 0) ? inode_load(disk, target_inode_num) : NULL;
+    if (target) {
+        uint32_t links = target->nlink ? target->nlink : 1;
+        int owner = links == 1 || (target->mode & 0100000) != 0100000 || target->parent == dir_inode_num;
+        DirUsage usage;
+        dir_usage_of(target, &usage);
+        if (owner) dir_usage_add(disk, dir_inode_num, &usage, -1);
+        target->nlink = links - 1;
+        inode_save(disk, target_inode_num, target);
+        if (owner && target->nlink > 0) {
+            uint32_t heir = dir_find_parent(disk, target_inode_num);
+            if (heir != (uint32_t)-1) {
+                target->parent = heir;
+                inode_save(disk, target_inode_num, target);
+                dir_usage_add(disk, heir, &usage, 1);
+            }
+        }
+        inode_put(target);
+    }
+    return result;
 }
 
 uint32_t dir_find_parent_recursive(Disk *disk, uint32_t current_inode_num, uint32_t target_inode_num) {
-    Inode *current_inode = inode_load(disk, current_inode_num);
-    if (!current_inode) return (uint32_t)-1;
-
-    if ((current_inode->mode & 040000) != 040000) { // Se não for diretório, libera e retorna
-        free(current_inode);
-        return (uint32_t)-1;
-    }
-
-    uint32_t num_entries = current_inode->size / DIR_ENTRY_SIZE;
-
-    for (uint32_t i = 0; i < num_entries; i++) {
-        uint32_t block_idx = (i * DIR_ENTRY_SIZE) / disk->block_size;
-        uint32_t offset_in_block = (i * DIR_ENTRY_SIZE) % disk->block_size;
-
-        if (block_idx >= MAX_BLOCKS_PER_INODE || current_inode->blocks[block_idx] == 0)
-            continue;
-
-        DirEntry entry;
-        lseek(disk->fd, current_inode->blocks[block_idx] * disk->block_size + offset_in_block, SEEK_SET);
-        ssize_t bytes_read = read(disk->fd, &entry, sizeof(DirEntry));
-        if (bytes_read != sizeof(DirEntry)) continue;
+    DirIter it;
+    if (dir_iter_open(disk, current_inode_num, DIR_ITER_PLUS, &it) != 0) return (uint32_t)-1;
 
+    DirEntry *entry;
+    Inode *entry_inode;
+    uint32_t found = (uint32_t)-1;
+    while (found == (uint32_t)-1 && (entry = dir_iter_next(&it, &entry_inode))) {
         // Ignorar "." e ".."
-        if (strcmp(entry.name, ".") == 0 || strcmp(entry.name, "..") == 0) continue;
+        if (strcmp(entry->name, ".") == 0 || strcmp(entry->name, "..") == 0) continue;
 
-        if (entry.inode_num == target_inode_num) {
-            free(current_inode);
-            return current_inode_num; // Achei o pai
-        }
-
-        // Se for diretório, busca recursivamente dentro dele
-        Inode *entry_inode = inode_load(disk, entry.inode_num);
-        if (entry_inode && (entry_inode->mode & 040000) == 040000) {
-            uint32_t res = dir_find_parent_recursive(disk, entry.inode_num, target_inode_num);
-            free(entry_inode);
-            if (res != (uint32_t)-1) {
-                free(current_inode);
-                return res; // Pai encontrado recursivamente
-            }
-        } else {
-            if(entry_inode) free(entry_inode);
+        if (entry->inode_num == target_inode_num) {
+            found = current_inode_num; // Achei o pai
+        } else if ((entry_inode->mode & 040000) == 040000) {
+            // Se for diretório, busca recursivamente dentro dele
+            found = dir_find_parent_recursive(disk, entry->inode_num, target_inode_num);
         }
     }
 
-    free(current_inode);
-    return (uint32_t)-1; // Não achou
+    dir_iter_close(&it);
+    return found;
 }
 
 uint32_t dir_find_parent(Disk *disk, uint32_t target_inode_num) {
+    STATS_SCOPE(STATS_DIR_FIND_PARENT);
     // Começa pelo root (inode 0)
     if (target_inode_num == 0) return (uint32_t)-1; // root não tem pai
     return dir_find_parent_recursive(disk, 0, target_inode_num);
 }
 
 int file_delete(Disk *disk, uint32_t parent_inode_num, uint32_t file_inode_num) {
+    STATS_SCOPE(STATS_FILE_DELETE);
     Inode *file_inode = inode_load(disk, file_inode_num);
     if (!file_inode) return -1;
 
     if ((file_inode->mode & 0100000) != 0100000) {
         printf("[ERRO] Inode %u não é um arquivo regular.\n", file_inode_num);
-        free(file_inode);
+        inode_put(file_inode);
+        return -1;
+    }
+
+    // Remove entrada do diretório pai (antes de zerar o i-node, que ainda
+    // é descontado do uso dos diretórios)
+    if (dir_remove_entry(disk, parent_inode_num, file_inode_num) != 0) {
+        printf("[ERRO] Falha ao remover a entrada do diretório pai.\n");
+        inode_put(file_inode);
         return -1;
     }
 
+    // Outros links ainda apontam para o arquivo: só a entrada sai
+    if (file_inode->nlink > 0) {
+        inode_put(file_inode);
+        return 0;
+    }
+
     // Libera todos os blocos usados pelo arquivo
     for (int i = 0; i < MAX_BLOCKS_PER_INODE; i++) {
         if (file_inode->blocks[i] != 0 && file_inode->blocks[i] != (uint32_t)-1) {
@@ -575,13 +897,50 @@ int file_delete(Disk *disk, uint32_t parent_inode_num, uint32_t file_inode_num)
     // Libera o inode
     inode_free(disk, file_inode_num);
 
-    // Remove entrada do diretório pai
-    if (dir_remove_entry(disk, parent_inode_num, file_inode_num) != 0) {
-        printf("[ERRO] Falha ao remover a entrada do diretório pai.\n");
-        free(file_inode);
+    inode_put(file_inode);
+    return 0;
+}
+
+int file_link(Disk *disk, uint32_t dir_inode_num, uint32_t inode_num, const char *name) {
+    STATS_SCOPE(STATS_FILE_LINK);
+    Inode *dir = inode_load(disk, dir_inode_num);
+    int is_dir = dir && (dir->mode & 040000) == 040000;
+    inode_put(dir);
+    if (!is_dir) {
+        printf("[ERRO] Inode %u não é um diretório.\n", dir_inode_num);
+        return -1;
+    }
+    if (dir_lookup(disk, dir_inode_num, name) != (uint32_t)-1) {
+        printf("[ERRO] Já existe '%s' no diretório %u.\n", name, dir_inode_num);
+        return -1;
+    }
+    // As entradas são identificadas por (diretório, i-node): dois links no
+    // mesmo diretório não poderiam ser distinguidos por delete_file ou rename_file
+    char existing[MAX_NAME_LEN];
+    if (dir_find_entry(disk, dir_inode_num, inode_num, existing) == 0) {
+        printf("[ERRO] O diretório %u já tem uma entrada para o inode %u ('%s').\n", dir_inode_num, inode_num, existing);
         return -1;
     }
 
-    free(file_inode);
-    return 0;
+    Inode *file = inode_load(disk, inode_num);
+    if (!file) return -1;
+    if ((file->mode & 0100000) != 0100000) {
+        printf("[ERRO] Inode %u não é um arquivo regular (diretórios não aceitam links).\n", inode_num);
+        inode_put(file);
+        return -1;
+    }
+    // Imagem antiga, sem contador: o link existente é o do diretório que o contém
+    if (file->nlink == 0) {
+        uint32_t owner = dir_find_parent(disk, inode_num);
+        if (owner == (uint32_t)-1) {
+            printf("[ERRO] Inode %u não está em nenhum diretório.\n", inode_num);
+            inode_put(file);
+            return -1;
+        }
+        file->nlink = 1;
+        file->parent = owner;
+        inode_save(disk, inode_num, file);
+    }
+    inode_put(file);
+    return dir_add_entry(disk, dir_inode_num, inode_num, name);
 }
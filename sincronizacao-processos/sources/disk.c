@@ -1,17 +1,45 @@
+#define _GNU_SOURCE
 #include "disk.h"
+#include "alloc.h"
+#include "diskio.h"
+#include "icache.h"
+#include "snapshot.h"
+#include "superblock.h"
+#include "stats.h"
 #include <unistd.h>
 #include <fcntl.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdio.h>
+#include <errno.h>
+#include <pthread.h>
 
-Disk *disk_create(const char *filename, uint32_t size, uint32_t block_size) {
+#define ZERO_CHUNK (1024 * 1024) // Escrita de zeros quando o host não abre buracos
+
+// Pilha de buffers alinhados livres (várias threads podem pegar buffers)
+struct DiskBufPool {
+    pthread_mutex_t lock;
+    uint8_t *free[DISK_BUF_POOL_MAX];
+    int count;
+};
+
+Disk *disk_create(const char *filename, uint64_t size, uint32_t block_size) {
     if (size < DISK_SIZE_MIN || size > DISK_SIZE_MAX) return NULL;
-    if (block_size % 512 != 0) return NULL; // Alinhado a setores de 512B
+    if (block_size % DISK_SECTOR_SIZE != 0) return NULL; // Alinhado a setores de 512B
+    if (size / block_size > UINT32_MAX - 8) return NULL; // Números de bloco são de 32 bits
 
     Disk *disk = malloc(sizeof(Disk));
     disk->filename = strdup(filename);
     disk->size = size;
     disk->block_size = block_size;
+    disk->sb = NULL;
+    disk->alloc = NULL;
+    disk->io = NULL;
+    disk->direct_fd = -1;
+    disk->bufs = NULL;
+    disk->icache = NULL;
+    disk->snap = NULL;
+    disk->sb_dirty = 0;
 
     // Cria arquivo binário (O_RDWR | O_CREAT, 0644)
     disk->fd = open(filename, O_RDWR | O_CREAT, 0644);
@@ -21,13 +49,104 @@ Disk *disk_create(const char *filename, uint32_t size, uint32_t block_size) {
         return NULL;
     }
 
-    // Ajusta tamanho do arquivo (ftruncate)
-    ftruncate(disk->fd, size);
+    // Ajusta tamanho do arquivo (ftruncate); o host só aloca o que for escrito
+    if (ftruncate(disk->fd, (off_t)size) != 0) {
+        close(disk->fd);
+        free(disk->filename);
+        free(disk);
+        return NULL;
+    }
     return disk;
 }
 
+off_t disk_block_offset(Disk *disk, uint32_t block_num) {
+    return (off_t)block_num * disk->block_size;
+}
+
+int disk_zero(Disk *disk, off_t offset, uint64_t len) {
+    if (len == 0) return 0;
+    // Abre um buraco no arquivo: lê como zeros e não ocupa espaço no host
+    stats_syscall(STATS_SYS_OTHER);
+    if (fallocate(disk->fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, offset, (off_t)len) == 0)
+        return 0;
+
+    // Sistema de arquivos do host sem suporte: grava zeros em pedaços
+    uint8_t *zeros = calloc(ZERO_CHUNK, 1);
+    while (len > 0) {
+        size_t n = len < ZERO_CHUNK ? len : ZERO_CHUNK;
+        if (stats_pwrite(disk->fd, zeros, n, offset) != (ssize_t)n) {
+            free(zeros);
+            return -1;
+        }
+        offset += n;
+        len -= n;
+    }
+    free(zeros);
+    return 0;
+}
+
+int disk_set_direct(Disk *disk, int enable) {
+    if (!enable) {
+        if (disk->direct_fd >= 0) close(disk->direct_fd);
+        disk->direct_fd = -1;
+        return 0;
+    }
+    if (disk->direct_fd >= 0) return 0;
+    // Escritas pendentes no cache de páginas vão para o disco antes
+    stats_syscall(STATS_SYS_OTHER);
+    fdatasync(disk->fd);
+    disk->direct_fd = open(disk->filename, O_RDWR | O_DIRECT);
+    if (disk->direct_fd == -1) {
+        printf("[AVISO] O_DIRECT não suportado em %s: %s\n", disk->filename, strerror(errno));
+        return -1;
+    }
+    return 0;
+}
+
+uint8_t *disk_buf_get(Disk *disk) {
+    if (!disk->bufs) {
+        disk->bufs = calloc(1, sizeof(struct DiskBufPool));
+        pthread_mutex_init(&disk->bufs->lock, NULL);
+    }
+    struct DiskBufPool *pool = disk->bufs;
+    uint8_t *buffer = NULL;
+
+    pthread_mutex_lock(&pool->lock);
+    if (pool->count > 0) buffer = pool->free[--pool->count];
+    pthread_mutex_unlock(&pool->lock);
+
+    if (!buffer && posix_memalign((void **)&buffer, DISK_DIRECT_ALIGN,
+                                  (size_t)DISK_BUF_BLOCKS * disk->block_size) != 0) {
+        return NULL;
+    }
+    return buffer;
+}
+
+void disk_buf_put(Disk *disk, uint8_t *buffer) {
+    struct DiskBufPool *pool = disk->bufs;
+    if (!buffer) return;
+    pthread_mutex_lock(&pool->lock);
+    if (pool->count < DISK_BUF_POOL_MAX) {
+        pool->free[pool->count++] = buffer;
+        buffer = NULL;
+    }
+    pthread_mutex_unlock(&pool->lock);
+    free(buffer);
+}
+
 void disk_free(Disk *disk) {
+    superblock_flush(disk);
+    disk_io_shutdown(disk);
+    alloc_detach(disk);
+    disk_set_direct(disk, 0);
+    icache_destroy(disk);
+    snapshot_detach(disk);
+    if (disk->bufs) {
+        for (int i = 0; i < disk->bufs->count; i++) free(disk->bufs->free[i]);
+        pthread_mutex_destroy(&disk->bufs->lock);
+        free(disk->bufs);
+    }
     close(disk->fd);
     free(disk->filename);
     free(disk);
-}
\ No newline at end of file
+}
@@ -0,0 +1,388 @@
+#include "diskio.h"
+#include "stats.h"
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <pthread.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sched.h>
+
+// Anel do io_uring mapeado em memória (sem liburing: syscalls diretas)
+typedef struct {
+    int fd;
+    uint32_t entries;
+    unsigned *sq_head, *sq_tail, *sq_mask, *sq_array;
+    unsigned *cq_head, *cq_tail, *cq_mask;
+    struct io_uring_sqe *sqes;
+    struct io_uring_cqe *cqes;
+    void *sq_ptr, *cq_ptr;
+    size_t sq_len, cq_len, sqes_len;
+} Uring;
+
+// Pool de threads: cada uma pega o próximo pedido do lote atual
+typedef struct {
+    pthread_t threads[DISK_IO_POOL_THREADS];
+    int count;
+    pthread_mutex_t lock;
+    pthread_cond_t work;
+    pthread_cond_t done;
+    DiskIoReq **batch;
+    uint32_t batch_size;
+    uint32_t next;       // Próximo pedido a executar
+    uint32_t remaining;  // Pedidos ainda não concluídos
+    int stop;
+    Disk *disk;
+} IoPool;
+
+struct DiskIo {
+    DiskIoEngine engine;
+    pthread_t owner;       // Única thread que enfileira pedidos
+    uint32_t depth;
+    DiskIoReq **pending;
+    uint32_t pending_count;
+    uint32_t pending_capacity;
+    Uring ring;
+    IoPool pool;
+};
+
+static const char *engine_names[DISK_IO_ENGINE_COUNT] = {
+    [DISK_IO_SYNC] = "sync",
+    [DISK_IO_THREADS] = "threads",
+    [DISK_IO_URING] = "uring",
+};
+
+// Pedido que pode usar o descritor com O_DIRECT: buffer, posição e tamanho
+// alinhados a setores
+static int io_can_direct(Disk *disk, DiskIoReq *req) {
+    return disk->direct_fd >= 0 && (uintptr_t)req->buf % DISK_SECTOR_SIZE == 0 &&
+           req->offset % DISK_SECTOR_SIZE == 0 && req->len % DISK_SECTOR_SIZE == 0;
+}
+
+static int io_fd(Disk *disk, DiskIoReq *req) {
+    return req->direct ? disk->direct_fd : disk->fd;
+}
+
+// Executa um pedido com pread/pwrite, completando leituras/escritas parciais.
+// Se o O_DIRECT for recusado (EINVAL), refaz pelo descritor normal
+static void io_sync(Disk *disk, DiskIoReq *req) {
+    uint8_t *p = req->buf;
+    uint32_t left = req->len;
+    off_t offset = req->offset;
+    while (left > 0) {
+        int fd = io_fd(disk, req);
+        ssize_t n = (req->op == DISK_IO_WRITE) ? stats_pwrite(fd, p, left, offset) : stats_pread(fd, p, left, offset);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && errno == EINVAL && req->direct) {
+            req->direct = 0;
+            continue;
+        }
+        if (n < 0) {
+            req->result = -errno;
+            return;
+        }
+        if (n == 0) break;
+        p += n;
+        left -= n;
+        offset += n;
+    }
+    req->result = req->len - left;
+}
+
+/* ====================== */
+/* io_uring               */
+/* ====================== */
+
+static int uring_setup(Uring *r, uint32_t depth) {
+    struct io_uring_params p;
+    memset(&p, 0, sizeof(p));
+    r->fd = syscall(__NR_io_uring_setup, depth, &p);
+    if (r->fd < 0) return -1;
+    r->entries = p.sq_entries;
+
+    r->sq_len = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    r->cq_len = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    if (p.features & IORING_FEAT_SINGLE_MMAP) {
+        if (r->cq_len > r->sq_len) r->sq_len = r->cq_len;
+        r->cq_len = r->sq_len;
+    }
+    r->sq_ptr = mmap(NULL, r->sq_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, r->fd, IORING_OFF_SQ_RING);
+    if (r->sq_ptr == MAP_FAILED) {
+        close(r->fd);
+        return -1;
+    }
+    if (p.features & IORING_FEAT_SINGLE_MMAP) {
+        r->cq_ptr = r->sq_ptr;
+    } else {
+        r->cq_ptr = mmap(NULL, r->cq_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, r->fd, IORING_OFF_CQ_RING);
+        if (r->cq_ptr == MAP_FAILED) {
+            munmap(r->sq_ptr, r->sq_len);
+            close(r->fd);
+            return -1;
+        }
+    }
+    r->sqes_len = p.sq_entries * sizeof(struct io_uring_sqe);
+    r->sqes = mmap(NULL, r->sqes_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, r->fd, IORING_OFF_SQES);
+    if (r->sqes == MAP_FAILED) {
+        if (r->cq_ptr != r->sq_ptr) munmap(r->cq_ptr, r->cq_len);
+        munmap(r->sq_ptr, r->sq_len);
+        close(r->fd);
+        return -1;
+    }
+
+    uint8_t *sq = r->sq_ptr, *cq = r->cq_ptr;
+    r->sq_head = (unsigned *)(sq + p.sq_off.head);
+    r->sq_tail = (unsigned *)(sq + p.sq_off.tail);
+    r->sq_mask = (unsigned *)(sq + p.sq_off.ring_mask);
+    r->sq_array = (unsigned *)(sq + p.sq_off.array);
+    r->cq_head = (unsigned *)(cq + p.cq_off.head);
+    r->cq_tail = (unsigned *)(cq + p.cq_off.tail);
+    r->cq_mask = (unsigned *)(cq + p.cq_off.ring_mask);
+    r->cqes = (struct io_uring_cqe *)(cq + p.cq_off.cqes);
+    return 0;
+}
+
+static void uring_teardown(Uring *r) {
+    munmap(r->sqes, r->sqes_len);
+    if (r->cq_ptr != r->sq_ptr) munmap(r->cq_ptr, r->cq_len);
+    munmap(r->sq_ptr, r->sq_len);
+    close(r->fd);
+}
+
+// Colhe as conclusões disponíveis no anel; retorna quantas foram colhidas
+static uint32_t uring_reap(Uring *r, Disk *disk) {
+    uint32_t reaped = 0;
+    unsigned head = *r->cq_head;
+    unsigned cq_tail = __atomic_load_n(r->cq_tail, __ATOMIC_ACQUIRE);
+    while (head != cq_tail) {
+        struct io_uring_cqe *cqe = &r->cqes[head & *r->cq_mask];
+        DiskIoReq *req = (DiskIoReq *)(uintptr_t)cqe->user_data;
+        req->result = cqe->res;
+        if (cqe->res > 0) stats_bytes(req->op == DISK_IO_WRITE, cqe->res);
+        // O_DIRECT recusado para este pedido: refaz pelo descritor normal
+        if (cqe->res == -EINVAL && req->direct) {
+            req->direct = 0;
+            io_sync(disk, req);
+        }
+        // Transferência parcial: completa o resto de forma síncrona
+        if (cqe->res > 0 && (uint32_t)cqe->res < req->len) {
+            DiskIoReq rest = {req->op, (uint8_t *)req->buf + cqe->res, req->len - cqe->res,
+                              req->offset + cqe->res, 0, req->direct};
+            io_sync(disk, &rest);
+            req->result = cqe->res + (rest.result > 0 ? rest.result : 0);
+        }
+        head++;
+        reaped++;
+    }
+    __atomic_store_n(r->cq_head, head, __ATOMIC_RELEASE);
+    return reaped;
+}
+
+// Mantém até entries pedidos em voo: preenche o anel, entra no kernel uma vez
+// e colhe as conclusões, até o lote terminar
+static void uring_run(Uring *r, Disk *disk, DiskIoReq **reqs, uint32_t count) {
+    uint32_t next = 0, done = 0, inflight = 0, to_submit = 0;
+    while (done < count) {
+        unsigned tail = *r->sq_tail;
+        while (next < count && inflight < r->entries) {
+            DiskIoReq *req = reqs[next++];
+            unsigned index = tail & *r->sq_mask;
+            struct io_uring_sqe *sqe = &r->sqes[index];
+            memset(sqe, 0, sizeof(*sqe));
+            sqe->opcode = (req->op == DISK_IO_WRITE) ? IORING_OP_WRITE : IORING_OP_READ;
+            sqe->fd = io_fd(disk, req);
+            sqe->addr = (uint64_t)(uintptr_t)req->buf;
+            sqe->len = req->len;
+            sqe->off = req->offset;
+            sqe->user_data = (uint64_t)(uintptr_t)req;
+            r->sq_array[index] = index;
+            tail++;
+            inflight++;
+            to_submit++;
+        }
+        __atomic_store_n(r->sq_tail, tail, __ATOMIC_RELEASE);
+
+        stats_syscall(STATS_SYS_URING);
+        int ret = syscall(__NR_io_uring_enter, r->fd, to_submit, 1, IORING_ENTER_GETEVENTS, NULL, 0);
+        if (ret < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+            // Anel inutilizável. Os pedidos não enviados saem do anel (senão
+            // iriam junto com o próximo lote); os que já estão no kernel ainda
+            // usam os buffers e precisam concluir antes de voltar ao chamador
+            __atomic_store_n(r->sq_tail, tail - to_submit, __ATOMIC_RELEASE);
+            uint32_t sent = inflight - to_submit;
+            while (sent > 0) {
+                uint32_t reaped = uring_reap(r, disk);
+                sent -= reaped;
+                if (sent == 0 || reaped > 0) continue;
+                // Espera pelo kernel; se nem isso funcionar, as conclusões
+                // continuam chegando ao anel e são colhidas na próxima volta
+                stats_syscall(STATS_SYS_URING);
+                if (syscall(__NR_io_uring_enter, r->fd, 0, 1, IORING_ENTER_GETEVENTS, NULL, 0) < 0 &&
+                    errno != EINTR) {
+                    sched_yield();
+                }
+            }
+            // O que ainda não foi enviado vai por pread/pwrite
+            for (uint32_t i = next - to_submit; i < count; i++) io_sync(disk, reqs[i]);
+            return;
+        }
+        if (ret > 0) to_submit -= ret;
+
+        uint32_t reaped = uring_reap(r, disk);
+        inflight -= reaped;
+        done += reaped;
+    }
+}
+
+/* ====================== */
+/* Pool de threads        */
+/* ====================== */
+
+static void *pool_worker(void *arg) {
+    IoPool *pool = arg;
+
+    pthread_mutex_lock(&pool->lock);
+    for (;;) {
+        while (!pool->stop && pool->next >= pool->batch_size) pthread_cond_wait(&pool->work, &pool->lock);
+        if (pool->stop) break;
+        DiskIoReq *req = pool->batch[pool->next++];
+        pthread_mutex_unlock(&pool->lock);
+
+        io_sync(pool->disk, req);
+
+        pthread_mutex_lock(&pool->lock);
+        if (--pool->remaining == 0) pthread_cond_signal(&pool->done);
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return NULL;
+}
+
+static int pool_start(IoPool *pool, Disk *disk) {
+    memset(pool, 0, sizeof(IoPool));
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->work, NULL);
+    pthread_cond_init(&pool->done, NULL);
+    pool->disk = disk;
+    for (int t = 0; t < DISK_IO_POOL_THREADS; t++) {
+        if (pthread_create(&pool->threads[pool->count], NULL, pool_worker, pool) == 0) pool->count++;
+    }
+    return pool->count > 0 ? 0 : -1;
+}
+
+static void pool_stop(IoPool *pool) {
+    pthread_mutex_lock(&pool->lock);
+    pool->stop = 1;
+    pthread_cond_broadcast(&pool->work);
+    pthread_mutex_unlock(&pool->lock);
+    for (int t = 0; t < pool->count; t++) pthread_join(pool->threads[t], NULL);
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->work);
+    pthread_cond_destroy(&pool->done);
+}
+
+static void pool_run(IoPool *pool, DiskIoReq **reqs, uint32_t count) {
+    pthread_mutex_lock(&pool->lock);
+    pool->batch = reqs;
+    pool->batch_size = count;
+    pool->next = 0;
+    pool->remaining = count;
+    pthread_cond_broadcast(&pool->work);
+    while (pool->remaining > 0) pthread_cond_wait(&pool->done, &pool->lock);
+    pool->batch_size = 0;
+    pthread_mutex_unlock(&pool->lock);
+}
+
+/* ====================== */
+/* API                    */
+/* ====================== */
+
+DiskIoEngine disk_io_init(Disk *disk, DiskIoEngine engine, uint32_t depth) {
+    disk_io_shutdown(disk);
+    if (engine >= DISK_IO_ENGINE_COUNT) engine = DISK_IO_SYNC;
+
+    struct DiskIo *io = calloc(1, sizeof(struct DiskIo));
+    io->depth = depth ? depth : DISK_IO_DEPTH_DEFAULT;
+    io->engine = engine;
+    io->owner = pthread_self();
+
+    if (engine == DISK_IO_URING && uring_setup(&io->ring, io->depth) != 0) {
+        printf("[AVISO] io_uring indisponível (%s); usando o pool de threads\n", strerror(errno));
+        io->engine = DISK_IO_THREADS;
+    }
+    if (io->engine == DISK_IO_THREADS && pool_start(&io->pool, disk) != 0) {
+        io->engine = DISK_IO_SYNC;
+    }
+    disk->io = io;
+    return io->engine;
+}
+
+void disk_io_shutdown(Disk *disk) {
+    struct DiskIo *io = disk->io;
+    if (!io) return;
+    disk_io_wait(disk);
+    if (io->engine == DISK_IO_URING) uring_teardown(&io->ring);
+    if (io->engine == DISK_IO_THREADS) pool_stop(&io->pool);
+    free(io->pending);
+    free(io);
+    disk->io = NULL;
+}
+
+DiskIoEngine disk_io_engine(Disk *disk) {
+    return disk->io ? disk->io->engine : DISK_IO_SYNC;
+}
+
+const char *disk_io_engine_name(DiskIoEngine engine) {
+    return (engine < DISK_IO_ENGINE_COUNT) ? engine_names[engine] : "?";
+}
+
+int disk_io_engine_from_name(const char *name) {
+    for (int e = 0; e < DISK_IO_ENGINE_COUNT; e++) {
+        if (strcmp(name, engine_names[e]) == 0) return e;
+    }
+    return -1;
+}
+
+void disk_io_submit(Disk *disk, DiskIoReq *req) {
+    struct DiskIo *io = disk->io;
+    req->result = 0;
+    req->direct = io_can_direct(disk, req);
+    // A fila não é compartilhada: outras threads executam na hora
+    if (!io || !pthread_equal(io->owner, pthread_self())) {
+        io_sync(disk, req);
+        return;
+    }
+    if (io->pending_count == io->pending_capacity) {
+        io->pending_capacity = io->pending_capacity ? io->pending_capacity * 2 : 64;
+        io->pending = realloc(io->pending, io->pending_capacity * sizeof(DiskIoReq *));
+    }
+    io->pending[io->pending_count++] = req;
+}
+
+int disk_io_wait(Disk *disk) {
+    struct DiskIo *io = disk->io;
+    if (!io || io->pending_count == 0 || !pthread_equal(io->owner, pthread_self())) return 0;
+
+    DiskIoReq **reqs = io->pending;
+    uint32_t count = io->pending_count;
+    switch (io->engine) {
+    case DISK_IO_URING:
+        uring_run(&io->ring, disk, reqs, count);
+        break;
+    case DISK_IO_THREADS:
+        pool_run(&io->pool, reqs, count);
+        break;
+    default:
+        for (uint32_t i = 0; i < count; i++) io_sync(disk, reqs[i]);
+        break;
+    }
+    io->pending_count = 0;
+
+    int failed = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        if (reqs[i]->result != (ssize_t)reqs[i]->len) failed++;
+    }
+    return failed;
+}
@@ -0,0 +1,279 @@
+#define _GNU_SOURCE
+#include "export.h"
+#include "superblock.h"
+#include "inode.h"
+#include "dir.h"
+#include <pthread.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+
+// Arquivo a exportar (o i-node é lido antes, pela thread principal)
+typedef struct {
+    uint32_t inode_num;
+    Inode inode;
+    char *host_path;
+} ExportJob;
+
+// Fila de trabalho compartilhada pelas threads
+typedef struct {
+    Disk *disk;
+    ExportJob *jobs;
+    uint32_t count;
+    uint32_t capacity;
+    uint32_t next;          // Próximo arquivo a copiar (atômico)
+    uint32_t failed;
+    uint32_t holes;
+    uint32_t fallbacks;
+    uint64_t bytes;
+} ExportQueue;
+
+static double elapsed_ms(struct timespec *start) {
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    return (end.tv_sec - start->tv_sec) * 1000.0 + (end.tv_nsec - start->tv_nsec) / 1e6;
+}
+
+static char *join_path(const char *dir, const char *name) {
+    size_t len = strlen(dir) + strlen(name) + 2;
+    char *path = malloc(len);
+    snprintf(path, len, "%s/%s", dir, name);
+    return path;
+}
+
+// Lê len bytes da imagem com pread (várias threads usam o mesmo descritor)
+static int read_full(int fd, void *buf, size_t len, off_t offset) {
+    uint8_t *p = buf;
+    while (len > 0) {
+        ssize_t n = pread(fd, p, len, offset);
+        if (n <= 0) return -1;
+        p += n;
+        len -= n;
+        offset += n;
+    }
+    return 0;
+}
+
+/* ====================== */
+/* Cópia de um arquivo    */
+/* ====================== */
+
+// Copia len bytes da imagem para o arquivo do host. Usa copy_file_range e,
+// se o kernel ou o sistema de arquivos não suportar, pread/pwrite
+static int copy_range(int in_fd, off_t in_off, int out_fd, off_t out_off, size_t len,
+                      uint8_t *buffer, int *fallback) {
+    while (len > 0 && !*fallback) {
+        ssize_t n = copy_file_range(in_fd, &in_off, out_fd, &out_off, len, 0);
+        if (n > 0) {
+            len -= n;
+            continue;
+        }
+        if (n == 0) return -1;
+        if (errno != EXDEV && errno != ENOSYS && errno != EINVAL && errno != EOPNOTSUPP) return -1;
+        *fallback = 1;
+    }
+    if (len == 0) return 0;
+    if (read_full(in_fd, buffer, len, in_off) != 0) return -1;
+    return pwrite(out_fd, buffer, len, out_off) == (ssize_t)len ? 0 : -1;
+}
+
+static int export_file(ExportQueue *q, ExportJob *job, uint8_t *buffer, int *fallback) {
+    Disk *disk = q->disk;
+    Inode *inode = &job->inode;
+    int fd = open(job->host_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd == -1) return -1;
+
+    // O tamanho é fixado antes: o que não for escrito fica como buraco no host
+    int result = ftruncate(fd, inode->size);
+    uint32_t blocks = (inode->size + disk->block_size - 1) / disk->block_size;
+    if (blocks > MAX_BLOCKS_PER_INODE) blocks = MAX_BLOCKS_PER_INODE;
+    uint32_t i = 0;
+    while (result == 0 && i < blocks) {
+        if (inode->blocks[i] == 0) {
+            __atomic_fetch_add(&q->holes, 1, __ATOMIC_RELAXED);
+            i++;
+            continue;
+        }
+        // Um trecho contíguo na imagem vira uma única cópia sequencial
+        uint32_t run = 1;
+        while (i + run < blocks && inode->blocks[i + run] == inode->blocks[i] + run) run++;
+        uint64_t offset = (uint64_t)i * disk->block_size;
+        uint64_t len = (uint64_t)run * disk->block_size;
+        if (offset + len > inode->size) len = inode->size - offset;
+
+        result = copy_range(disk->fd, disk_block_offset(disk, inode->blocks[i]), fd, (off_t)offset,
+                            len, buffer, fallback);
+        if (result == 0) __atomic_fetch_add(&q->bytes, len, __ATOMIC_RELAXED);
+        i += run;
+    }
+
+    struct timespec times[2] = {{inode->modified_at, 0}, {inode->modified_at, 0}};
+    futimens(fd, times);
+    if (close(fd) != 0) result = -1;
+    return result;
+}
+
+static void *export_worker(void *arg) {
+    ExportQueue *q = arg;
+    uint8_t *buffer = malloc(MAX_BLOCKS_PER_INODE * q->disk->block_size);
+    for (;;) {
+        uint32_t j = __atomic_fetch_add(&q->next, 1, __ATOMIC_RELAXED);
+        if (j >= q->count) break;
+        int fallback = 0;
+        if (export_file(q, &q->jobs[j], buffer, &fallback) != 0) {
+            printf("[ERRO] Falha ao exportar %s\n", q->jobs[j].host_path);
+            __atomic_fetch_add(&q->failed, 1, __ATOMIC_RELAXED);
+        }
+        if (fallback) __atomic_fetch_add(&q->fallbacks, 1, __ATOMIC_RELAXED);
+    }
+    free(buffer);
+    return NULL;
+}
+
+/* ====================== */
+/* Varredura da imagem    */
+/* ====================== */
+
+static void queue_push(ExportQueue *q, uint32_t inode_num, Inode *inode, char *host_path) {
+    if (q->count == q->capacity) {
+        q->capacity = q->capacity ? q->capacity * 2 : 256;
+        q->jobs = realloc(q->jobs, q->capacity * sizeof(ExportJob));
+    }
+    ExportJob *job = &q->jobs[q->count++];
+    job->inode_num = inode_num;
+    job->inode = *inode;
+    job->host_path = host_path;
+}
+
+// Percorre a subárvore criando os diretórios no host e enfileirando os arquivos
+static int export_walk(Disk *disk, uint32_t root, const char *host_dir, ExportQueue *q, ExportReport *report) {
+    uint8_t *visited = calloc((disk->sb->inode_count + 7) / 8, 1);
+
+    // Pilha de diretórios pendentes (i-node e caminho no host)
+    uint32_t stack_size = 1, stack_capacity = 64;
+    uint32_t *stack_inode = malloc(stack_capacity * sizeof(uint32_t));
+    char **stack_path = malloc(stack_capacity * sizeof(char *));
+    stack_inode[0] = root;
+    stack_path[0] = strdup(host_dir);
+    visited[root / 8] |= 1 << (root % 8);
+
+    while (stack_size > 0) {
+        stack_size--;
+        uint32_t dir_num = stack_inode[stack_size];
+        char *dir_path = stack_path[stack_size];
+        DirIter it;
+        if (dir_iter_open(disk, dir_num, DIR_ITER_PLUS, &it) != 0) {
+            free(dir_path);
+            continue;
+        }
+
+        DirEntry *entry;
+        Inode *inode;
+        while ((entry = dir_iter_next(&it, &inode))) {
+            if (strcmp(entry->name, ".") == 0 || strcmp(entry->name, "..") == 0 || strchr(entry->name, '/')) {
+                continue;
+            }
+            uint32_t child = entry->inode_num;
+            if (child >= disk->sb->inode_count) continue;
+
+            char *path = join_path(dir_path, entry->name);
+            if ((inode->mode & 040000) == 040000) {
+                if (visited[child / 8] & (1 << (child % 8))) {
+                    free(path); // Ciclo na árvore: diretório já exportado
+                } else if (mkdir(path, 0755) != 0 && errno != EEXIST) {
+                    printf("[ERRO] Não foi possível criar o diretório %s\n", path);
+                    report->failed++;
+                    free(path);
+                } else {
+                    visited[child / 8] |= 1 << (child % 8);
+                    report->dirs++;
+                    if (stack_size == stack_capacity) {
+                        stack_capacity *= 2;
+                        stack_inode = realloc(stack_inode, stack_capacity * sizeof(uint32_t));
+                        stack_path = realloc(stack_path, stack_capacity * sizeof(char *));
+                    }
+                    stack_inode[stack_size] = child;
+                    stack_path[stack_size++] = path;
+                }
+            } else if (inode->mode & 0100000) {
+                queue_push(q, child, inode, path);
+            } else {
+                free(path);
+            }
+        }
+        dir_iter_close(&it);
+        free(dir_path);
+    }
+
+    free(stack_inode);
+    free(stack_path);
+    free(visited);
+    return 0;
+}
+
+int export_tree(Disk *disk, uint32_t dir_inode_num, const char *host_dir, ExportReport *report) {
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    memset(report, 0, sizeof(ExportReport));
+
+    if (dir_inode_num >= disk->sb->inode_count) {
+        printf("[ERRO] Inode %u inválido\n", dir_inode_num);
+        return -1;
+    }
+    Inode *root = inode_load(disk, dir_inode_num);
+    int is_dir = (root->mode & 040000) == 040000;
+    inode_put(root);
+    if (!is_dir) {
+        printf("[ERRO] Inode %u não é um diretório\n", dir_inode_num);
+        return -1;
+    }
+    if (mkdir(host_dir, 0755) != 0 && errno != EEXIST) {
+        printf("[ERRO] Não foi possível criar o diretório do host: %s\n", host_dir);
+        return -1;
+    }
+
+    // 1. Diretórios criados e i-nodes dos arquivos lidos por esta thread
+    ExportQueue q;
+    memset(&q, 0, sizeof(q));
+    q.disk = disk;
+    export_walk(disk, dir_inode_num, host_dir, &q, report);
+
+    // 2. Cópia dos arquivos em paralelo
+    pthread_t threads[EXPORT_THREADS];
+    int started = 0;
+    for (int t = 0; t < EXPORT_THREADS && (uint32_t)t < q.count; t++) {
+        if (pthread_create(&threads[started], NULL, export_worker, &q) == 0) started++;
+    }
+    if (started == 0) export_worker(&q); // Sem threads: copia tudo aqui
+    for (int t = 0; t < started; t++) pthread_join(threads[t], NULL);
+
+    report->threads = started ? started : 1;
+    report->files = q.count - q.failed;
+    report->failed += q.failed;
+    report->holes = q.holes;
+    report->fallbacks = q.fallbacks;
+    report->bytes = q.bytes;
+    for (uint32_t j = 0; j < q.count; j++) free(q.jobs[j].host_path);
+    free(q.jobs);
+
+    report->elapsed_ms = elapsed_ms(&start);
+    return report->failed ? -1 : 0;
+}
+
+void export_print_report(const ExportReport *report) {
+    double seconds = report->elapsed_ms / 1000.0;
+    printf("=== EXPORTAÇÃO ===\n");
+    printf("Arquivos exportados: %u\n", report->files);
+    printf("Diretórios criados: %u\n", report->dirs);
+    printf("Falhas: %u\n", report->failed);
+    printf("Dados copiados: %.2f MB (%u blocos de buraco pulados)\n",
+           report->bytes / (1024.0 * 1024.0), report->holes);
+    printf("Cópias sem copy_file_range: %u\n", report->fallbacks);
+    printf("Tempo: %.2f ms com %d threads (%.2f MB/s)\n", report->elapsed_ms, report->threads,
+           seconds > 0 ? report->bytes / (1024.0 * 1024.0) / seconds : 0.0);
+}
@@ -0,0 +1,301 @@
+#include "extent.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Comparação por posição ou por (tamanho, posição)
+typedef int (*ExtentCmp)(uint32_t a_start, uint32_t a_len, uint32_t b_start, uint32_t b_len);
+
+static int cmp_offset(uint32_t a_start, uint32_t a_len, uint32_t b_start, uint32_t b_len) {
+    (void)a_len;
+    (void)b_len;
+    return (a_start > b_start) - (a_start < b_start);
+}
+
+static int cmp_length(uint32_t a_start, uint32_t a_len, uint32_t b_start, uint32_t b_len) {
+    if (a_len != b_len) return (a_len > b_len) - (a_len < b_len);
+    return (a_start > b_start) - (a_start < b_start);
+}
+
+/* ====================== */
+/* AVL                    */
+/* ====================== */
+
+static int height(ExtentNode *n) {
+    return n ? n->height : 0;
+}
+
+static uint32_t max_len(ExtentNode *n) {
+    return n ? n->max_len : 0;
+}
+
+// Altura e maior trecho da subárvore, recalculados a partir dos filhos
+static void update_height(ExtentNode *n) {
+    int hl = height(n->left), hr = height(n->right);
+    n->height = (hl > hr ? hl : hr) + 1;
+    uint32_t ml = max_len(n->left), mr = max_len(n->right);
+    n->max_len = n->len;
+    if (ml > n->max_len) n->max_len = ml;
+    if (mr > n->max_len) n->max_len = mr;
+}
+
+static ExtentNode *rotate_right(ExtentNode *n) {
+    ExtentNode *l = n->left;
+    n->left = l->right;
+    l->right = n;
+    update_height(n);
+    update_height(l);
+    return l;
+}
+
+static ExtentNode *rotate_left(ExtentNode *n) {
+    ExtentNode *r = n->right;
+    n->right = r->left;
+    r->left = n;
+    update_height(n);
+    update_height(r);
+    return r;
+}
+
+static ExtentNode *rebalance(ExtentNode *n) {
+    update_height(n);
+    int balance = height(n->left) - height(n->right);
+    if (balance > 1) {
+        if (height(n->left->left) < height(n->left->right)) n->left = rotate_left(n->left);
+        return rotate_right(n);
+    }
+    if (balance < -1) {
+        if (height(n->right->right) < height(n->right->left)) n->right = rotate_right(n->right);
+        return rotate_left(n);
+    }
+    return n;
+}
+
+static ExtentNode *avl_insert(ExtentNode *root, uint32_t start, uint32_t len, ExtentCmp cmp) {
+    if (!root) {
+        ExtentNode *n = malloc(sizeof(ExtentNode));
+        n->start = start;
+        n->len = len;
+        n->max_len = len;
+        n->height = 1;
+        n->left = n->right = NULL;
+        return n;
+    }
+    if (cmp(start, len, root->start, root->len) < 0) root->left = avl_insert(root->left, start, len, cmp);
+    else root->right = avl_insert(root->right, start, len, cmp);
+    return rebalance(root);
+}
+
+static ExtentNode *avl_remove_min(ExtentNode *root, ExtentNode **min) {
+    if (!root->left) {
+        *min = root;
+        return root->right;
+    }
+    root->left = avl_remove_min(root->left, min);
+    return rebalance(root);
+}
+
+static ExtentNode *avl_remove(ExtentNode *root, uint32_t start, uint32_t len, ExtentCmp cmp) {
+    if (!root) return NULL;
+    int c = cmp(start, len, root->start, root->len);
+    if (c < 0) {
+        root->left = avl_remove(root->left, start, len, cmp);
+    } else if (c > 0) {
+        root->right = avl_remove(root->right, start, len, cmp);
+    } else {
+        ExtentNode *l = root->left, *r = root->right;
+        free(root);
+        if (!r) return l;
+        ExtentNode *min;
+        r = avl_remove_min(r, &min);
+        min->left = l;
+        min->right = r;
+        return rebalance(min);
+    }
+    return rebalance(root);
+}
+
+static void avl_destroy(ExtentNode *n) {
+    if (!n) return;
+    avl_destroy(n->left);
+    avl_destroy(n->right);
+    free(n);
+}
+
+/* ====================== */
+/* Árvore de trechos      */
+/* ====================== */
+
+static void add_extent(ExtentTree *tree, uint32_t start, uint32_t len) {
+    tree->by_offset = avl_insert(tree->by_offset, start, len, cmp_offset);
+    tree->by_length = avl_insert(tree->by_length, start, len, cmp_length);
+    tree->count++;
+    tree->free_blocks += len;
+}
+
+static void del_extent(ExtentTree *tree, uint32_t start, uint32_t len) {
+    tree->by_offset = avl_remove(tree->by_offset, start, len, cmp_offset);
+    tree->by_length = avl_remove(tree->by_length, start, len, cmp_length);
+    tree->count--;
+    tree->free_blocks -= len;
+}
+
+// Maior trecho com início <= block
+static ExtentNode *floor_node(ExtentTree *tree, uint32_t block) {
+    ExtentNode *n = tree->by_offset, *best = NULL;
+    while (n) {
+        if (n->start <= block) {
+            best = n;
+            n = n->right;
+        } else {
+            n = n->left;
+        }
+    }
+    return best;
+}
+
+// Menor trecho com início > block
+static ExtentNode *next_node(ExtentTree *tree, uint32_t block) {
+    ExtentNode *n = tree->by_offset, *best = NULL;
+    while (n) {
+        if (n->start > block) {
+            best = n;
+            n = n->left;
+        } else {
+            n = n->right;
+        }
+    }
+    return best;
+}
+
+void extent_tree_init(ExtentTree *tree) {
+    tree->by_offset = NULL;
+    tree->by_length = NULL;
+    tree->count = 0;
+    tree->free_blocks = 0;
+}
+
+void extent_tree_destroy(ExtentTree *tree) {
+    avl_destroy(tree->by_offset);
+    avl_destroy(tree->by_length);
+    extent_tree_init(tree);
+}
+
+void extent_tree_build(ExtentTree *tree, const uint8_t *bitmap, uint32_t first, uint32_t last) {
+    uint32_t run_start = 0, run_len = 0;
+    for (uint32_t b = first; b < last; b++) {
+        // Palavras de 64 bits todas livres ou todas usadas são tratadas de uma vez
+        if (b % 64 == 0 && last - b >= 64) {
+            uint64_t word;
+            memcpy(&word, &bitmap[b / 8], sizeof(word));
+            if (word == UINT64_MAX) {
+                if (run_len > 0) add_extent(tree, run_start, run_len);
+                run_len = 0;
+                b += 63;
+                continue;
+            }
+            if (word == 0) {
+                if (run_len == 0) run_start = b;
+                run_len += 64;
+                b += 63;
+                continue;
+            }
+        }
+        if (bitmap[b / 8] & (1 << (b % 8))) {
+            if (run_len > 0) add_extent(tree, run_start, run_len);
+            run_len = 0;
+            continue;
+        }
+        if (run_len++ == 0) run_start = b;
+    }
+    if (run_len > 0) add_extent(tree, run_start, run_len);
+}
+
+void extent_tree_insert(ExtentTree *tree, uint32_t start, uint32_t len) {
+    ExtentNode *prev = floor_node(tree, start);
+    ExtentNode *next = next_node(tree, start);
+
+    // Junta com o trecho anterior e/ou o seguinte quando encostam
+    if (prev && prev->start + prev->len == start) {
+        uint32_t p_start = prev->start, p_len = prev->len;
+        del_extent(tree, p_start, p_len);
+        start = p_start;
+        len += p_len;
+    }
+    if (next && start + len == next->start) {
+        uint32_t n_start = next->start, n_len = next->len;
+        del_extent(tree, n_start, n_len);
+        len += n_len;
+    }
+    add_extent(tree, start, len);
+}
+
+void extent_tree_remove(ExtentTree *tree, uint32_t start, uint32_t len) {
+    ExtentNode *n = floor_node(tree, start);
+    if (!n || n->start + n->len < start + len) return; // não está livre
+
+    uint32_t e_start = n->start, e_len = n->len;
+    del_extent(tree, e_start, e_len);
+    if (start > e_start) add_extent(tree, e_start, start - e_start);
+    if (start + len < e_start + e_len) add_extent(tree, start + len, e_start + e_len - (start + len));
+}
+
+int extent_tree_best_fit(ExtentTree *tree, uint32_t count, uint32_t *start, uint32_t *len) {
+    ExtentNode *n = tree->by_length, *best = NULL;
+    while (n) {
+        if (n->len >= count) {
+            best = n;
+            n = n->left;
+        } else {
+            n = n->right;
+        }
+    }
+    if (!best) return -1;
+    *start = best->start;
+    *len = best->len;
+    return 0;
+}
+
+// Subárvores cujo maior trecho é menor que count são puladas inteiras
+static ExtentNode *first_fit_node(ExtentNode *n, uint32_t from, uint32_t count) {
+    if (!n || n->max_len < count) return NULL;
+    if (n->start >= from) {
+        ExtentNode *found = first_fit_node(n->left, from, count);
+        if (found) return found;
+        if (n->len >= count) return n;
+    }
+    return first_fit_node(n->right, from, count);
+}
+
+int extent_tree_first_fit(ExtentTree *tree, uint32_t from, uint32_t count, uint32_t *start, uint32_t *len) {
+    ExtentNode *n = first_fit_node(tree->by_offset, from, count);
+    if (!n) return -1;
+    *start = n->start;
+    *len = n->len;
+    return 0;
+}
+
+int extent_tree_find(ExtentTree *tree, uint32_t block, uint32_t *start, uint32_t *len) {
+    ExtentNode *n = floor_node(tree, block);
+    if (!n || n->start + n->len <= block) return -1;
+    *start = n->start;
+    *len = n->len;
+    return 0;
+}
+
+uint32_t extent_tree_largest(ExtentTree *tree) {
+    ExtentNode *n = tree->by_length;
+    if (!n) return 0;
+    while (n->right) n = n->right;
+    return n->len;
+}
+
+static void walk_node(ExtentNode *n, void (*fn)(uint32_t, uint32_t, void *), void *arg) {
+    if (!n) return;
+    walk_node(n->left, fn, arg);
+    fn(n->start, n->len, arg);
+    walk_node(n->right, fn, arg);
+}
+
+void extent_tree_walk(ExtentTree *tree, void (*fn)(uint32_t start, uint32_t len, void *arg), void *arg) {
+    walk_node(tree->by_offset, fn, arg);
+}
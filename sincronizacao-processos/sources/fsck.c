@@ -0,0 +1,565 @@
+#include "fsck.h"
+#include "superblock.h"
+#include "inode.h"
+#include "bitmap.h"
+#include "dir.h"
+#include "snapshot.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+
+// Estado de uma thread da varredura da tabela de i-nodes
+typedef struct {
+    Disk *disk;
+    uint8_t *table;        // Cópia em memória da tabela de i-nodes (compartilhada)
+    uint8_t *block_refs;   // Quantos i-nodes referenciam cada bloco, saturado em 255 (compartilhado)
+    uint32_t first;        // Primeiro i-node da faixa
+    uint32_t last;         // Fim da faixa (exclusivo)
+    uint32_t used;         // I-nodes em uso encontrados na faixa
+    uint32_t invalid;      // Ponteiros inválidos encontrados na faixa
+    int error;
+} FsckWorker;
+
+static Inode *table_inode(uint8_t *table, uint32_t inode_num) {
+    return (Inode *)(table + (size_t)inode_num * INODE_SIZE);
+}
+
+static int is_dir(const Inode *inode) {
+    return (inode->mode & 040000) == 040000;
+}
+
+static int block_valid(Disk *disk, uint32_t block_num) {
+    uint32_t total_blocks = (uint32_t)(disk->size / disk->block_size);
+    return block_num >= disk->sb->data_start_block && block_num < total_blocks;
+}
+
+// Lê len bytes a partir de offset sem depender da posição do descritor
+// (pread pode ser usado por várias threads ao mesmo tempo)
+static int read_full(int fd, void *buf, size_t len, off_t offset) {
+    uint8_t *p = buf;
+    while (len > 0) {
+        ssize_t n = pread(fd, p, len, offset);
+        if (n <= 0) return -1;
+        p += n;
+        len -= n;
+        offset += n;
+    }
+    return 0;
+}
+
+static void *fsck_scan_worker(void *arg) {
+    FsckWorker *w = arg;
+    Disk *disk = w->disk;
+    off_t offset = disk_block_offset(disk, disk->sb->inode_start) + (off_t)w->first * INODE_SIZE;
+    size_t len = (size_t)(w->last - w->first) * INODE_SIZE;
+
+    if (read_full(disk->fd, w->table + (size_t)w->first * INODE_SIZE, len, offset) != 0) {
+        w->error = 1;
+        return NULL;
+    }
+
+    for (uint32_t i = w->first; i < w->last; i++) {
+        Inode *inode = table_inode(w->table, i);
+        if (inode->mode == 0) continue; // i-node livre
+        w->used++;
+
+        for (int k = 0; k < MAX_BLOCKS_PER_INODE; k++) {
+            uint32_t b = inode->blocks[k];
+            if (b == 0 || b == (uint32_t)-1) continue;
+            if (!block_valid(disk, b)) {
+                w->invalid++;
+                continue;
+            }
+            // Contador de 1 byte por bloco (discos de TB): satura em vez de dar a volta
+            uint8_t refs = __atomic_load_n(&w->block_refs[b], __ATOMIC_RELAXED);
+            while (refs < UINT8_MAX &&
+                   !__atomic_compare_exchange_n(&w->block_refs[b], &refs, refs + 1, 1,
+                                                __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+            }
+        }
+    }
+    return NULL;
+}
+
+// Lê todas as entradas de um diretório de uma vez (um read por bloco)
+static DirEntry *read_dir_entries(Disk *disk, Inode *dir, uint32_t *count) {
+    uint32_t num_entries = dir->size / DIR_ENTRY_SIZE;
+    uint32_t per_block = disk->block_size / DIR_ENTRY_SIZE;
+    DirEntry *entries = calloc(num_entries ? num_entries : 1, sizeof(DirEntry));
+
+    for (uint32_t i = 0; i < num_entries; i += per_block) {
+        uint32_t block_idx = i / per_block;
+        uint32_t n = (num_entries - i < per_block) ? num_entries - i : per_block;
+        if (block_idx >= MAX_BLOCKS_PER_INODE || !block_valid(disk, dir->blocks[block_idx]))
+            continue; // entradas ficam zeradas (tratadas como removidas)
+        read_full(disk->fd, &entries[i], n * sizeof(DirEntry),
+                  disk_block_offset(disk, dir->blocks[block_idx]));
+    }
+
+    *count = num_entries;
+    return entries;
+}
+
+static void write_dir_entry(Disk *disk, uint32_t dir_num, Inode *dir, uint32_t index, DirEntry *entry) {
+    uint32_t block_idx = (index * DIR_ENTRY_SIZE) / disk->block_size;
+    uint32_t offset_in_block = (index * DIR_ENTRY_SIZE) % disk->block_size;
+    // Bloco retido por um snapshot: o reparo vai para uma cópia
+    int moved = snapshot_cow_block(disk, dir, block_idx, 1);
+    if (moved < 0) return;
+    if (moved) inode_save(disk, dir_num, dir);
+    pwrite(disk->fd, entry, sizeof(DirEntry),
+           disk_block_offset(disk, dir->blocks[block_idx]) + offset_in_block);
+}
+
+static uint32_t count_zero_bits(const uint8_t *bits, uint32_t nbits) {
+    uint32_t zeros = 0;
+    for (uint32_t i = 0; i < nbits; i++) {
+        if (!((bits[i / 8] >> (i % 8)) & 1)) zeros++;
+    }
+    return zeros;
+}
+
+// Recalcula os contadores de livres do superbloco a partir dos bitmaps
+static void recount_free(Disk *disk) {
+    Superblock *sb = disk->sb;
+    uint32_t total_blocks = (uint32_t)(disk->size / disk->block_size);
+    uint32_t size = (total_blocks + 7) / 8;
+    uint32_t inode_size = (sb->inode_count + 7) / 8;
+    uint8_t *bits = malloc(size > inode_size ? size : inode_size);
+
+    if (read_full(disk->fd, bits, size, disk_block_offset(disk, sb->bitmap_start_block)) == 0) {
+        sb->free_blocks = count_zero_bits(bits, total_blocks);
+        sb->free_blocks_count = sb->free_blocks;
+    }
+    if (read_full(disk->fd, bits, inode_size, disk_block_offset(disk, sb->inode_bitmap_start)) == 0) {
+        sb->free_inodes = count_zero_bits(bits, sb->inode_count);
+    }
+    superblock_sync(disk);
+    free(bits);
+}
+
+// Procura "lost+found" no root, criando o diretório se necessário
+static uint32_t lost_found_inode(Disk *disk) {
+    for (int attempt = 0; attempt < 2; attempt++) {
+        Inode *root = inode_load(disk, 0);
+        uint32_t count;
+        DirEntry *entries = read_dir_entries(disk, root, &count);
+        uint32_t found = (uint32_t)-1;
+        for (uint32_t i = 0; i < count; i++) {
+            if (strncmp(entries[i].name, FSCK_LOST_FOUND, MAX_NAME_LEN) == 0) {
+                found = entries[i].inode_num;
+                break;
+            }
+        }
+        free(entries);
+        inode_put(root);
+
+        if (found != (uint32_t)-1 || attempt == 1) return found;
+        if (dir_create(disk, 0, FSCK_LOST_FOUND) != 0) return (uint32_t)-1;
+    }
+    return (uint32_t)-1;
+}
+
+int fsck_run(Disk *disk, int repair, int num_threads, FsckReport *report) {
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    memset(report, 0, sizeof(FsckReport));
+
+    Superblock *sb = disk->sb;
+    uint32_t total_blocks = (uint32_t)(disk->size / disk->block_size);
+    uint32_t inode_count = sb->inode_count;
+
+    // 1. Bitmap inteiro em memória (uma única leitura)
+    uint32_t bitmap_size = (total_blocks + 7) / 8;
+    uint8_t *bitmap = malloc(bitmap_size);
+    if (read_full(disk->fd, bitmap, bitmap_size, disk_block_offset(disk, sb->bitmap_start_block)) != 0) {
+        printf("[ERRO] Falha ao ler o bitmap\n");
+        free(bitmap);
+        return -1;
+    }
+
+    uint32_t inode_bitmap_size = (inode_count + 7) / 8;
+    uint8_t *inode_bitmap = malloc(inode_bitmap_size);
+    if (read_full(disk->fd, inode_bitmap, inode_bitmap_size, disk_block_offset(disk, sb->inode_bitmap_start)) != 0) {
+        printf("[ERRO] Falha ao ler o bitmap de i-nodes\n");
+        free(inode_bitmap);
+        free(bitmap);
+        return -1;
+    }
+
+    // 2. Varredura paralela da tabela de i-nodes
+    if (num_threads <= 0) num_threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (num_threads < 1) num_threads = 1;
+    if (num_threads > FSCK_MAX_THREADS) num_threads = FSCK_MAX_THREADS;
+    if ((uint32_t)num_threads > inode_count) num_threads = inode_count;
+    report->threads = num_threads;
+
+    uint8_t *table = malloc((size_t)inode_count * INODE_SIZE);
+    uint8_t *block_refs = calloc(total_blocks, 1);
+    pthread_t threads[FSCK_MAX_THREADS];
+    FsckWorker workers[FSCK_MAX_THREADS];
+    uint32_t chunk = (inode_count + num_threads - 1) / num_threads;
+
+    for (int t = 0; t < num_threads; t++) {
+        FsckWorker *w = &workers[t];
+        memset(w, 0, sizeof(FsckWorker));
+        w->disk = disk;
+        w->table = table;
+        w->block_refs = block_refs;
+        w->first = t * chunk;
+        w->last = (w->first + chunk > inode_count) ? inode_count : w->first + chunk;
+        pthread_create(&threads[t], NULL, fsck_scan_worker, w);
+    }
+
+    int scan_error = 0;
+    for (int t = 0; t < num_threads; t++) {
+        pthread_join(threads[t], NULL);
+        scan_error |= workers[t].error;
+        report->inodes_used += workers[t].used;
+        report->invalid_blocks += workers[t].invalid;
+    }
+
+    if (scan_error || !is_dir(table_inode(table, 0))) {
+        printf("[ERRO] %s\n", scan_error ? "Falha ao ler a tabela de i-nodes" : "Root (inode 0) não é um diretório");
+        free(inode_bitmap);
+        free(bitmap);
+        free(table);
+        free(block_refs);
+        return -1;
+    }
+
+    // Bitmap de i-nodes x tabela (mode 0 = livre)
+    for (uint32_t i = 0; i < inode_count; i++) {
+        int marked = (inode_bitmap[i / 8] >> (i % 8)) & 1;
+        int in_use = table_inode(table, i)->mode != 0;
+        if (marked == in_use) continue;
+        report->inode_bitmap_errors++;
+        printf("[FSCK] I-node %u %s no bitmap de i-nodes\n", i, in_use ? "em uso mas livre" : "livre mas marcado");
+        if (repair) {
+            inode_bitmap_set(disk, i, in_use);
+            report->repaired++;
+        }
+    }
+
+    // 3. Alcançabilidade a partir do root (busca em largura)
+    uint8_t *visited = calloc(inode_count, 1);
+    uint8_t *top = calloc(inode_count, 1);
+    uint32_t *parent = calloc(inode_count, sizeof(uint32_t));
+    uint32_t *links = calloc(inode_count, sizeof(uint32_t)); // Entradas que apontam para cada i-node
+    uint8_t *owner_link = calloc(inode_count, 1);            // inode->parent tem uma delas
+    uint32_t *queue = malloc(inode_count * sizeof(uint32_t));
+    uint32_t head = 0, tail = 0; // A fila guarda todos os diretórios, pais antes dos filhos
+
+    for (uint32_t start = 0; start < inode_count; start++) {
+        // Primeiro o root; depois cada diretório em uso não alcançado inicia
+        // a varredura da sua própria subárvore desconectada
+        if (visited[start]) continue;
+        Inode *start_inode = table_inode(table, start);
+        if (start_inode->mode == 0 || !is_dir(start_inode)) continue;
+
+        if (start != 0) top[start] = 1;
+        visited[start] = 1;
+        parent[start] = start == 0 ? 0 : (uint32_t)-1;
+        head = tail;
+        queue[tail++] = start;
+
+        while (head < tail) {
+            uint32_t d = queue[head++];
+            Inode *dir = table_inode(table, d);
+            uint32_t count;
+            DirEntry *entries = read_dir_entries(disk, dir, &count);
+
+            for (uint32_t i = 0; i < count; i++) {
+                DirEntry *e = &entries[i];
+                if (e->name[0] == '\0') continue; // entrada removida
+                e->name[MAX_NAME_LEN - 1] = '\0';
+
+                // "." aponta para o próprio diretório e ".." para o pai
+                int dot = strcmp(e->name, ".") == 0;
+                int dotdot = strcmp(e->name, "..") == 0;
+                if (dot || dotdot) {
+                    uint32_t expected = dot ? d : parent[d];
+                    if (expected != (uint32_t)-1 && e->inode_num != expected) {
+                        report->bad_dot_entries++;
+                        printf("[FSCK] Diretório %u: '%s' aponta para %u (esperado %u)\n",
+                               d, e->name, e->inode_num, expected);
+                        if (repair) {
+                            e->inode_num = expected;
+                            write_dir_entry(disk, d, dir, i, e);
+                            report->repaired++;
+                        }
+                    }
+                    continue;
+                }
+
+                uint32_t t = e->inode_num;
+                if (t >= inode_count || table_inode(table, t)->mode == 0) {
+                    report->dangling_entries++;
+                    printf("[FSCK] Diretório %u: entrada '%s' aponta para i-node livre/inválido %u\n",
+                           d, e->name, t);
+                    if (repair) {
+                        memset(e, 0, sizeof(DirEntry));
+                        write_dir_entry(disk, d, dir, i, e);
+                        report->repaired++;
+                    }
+                    continue;
+                }
+
+                links[t]++;
+                if (table_inode(table, t)->parent == d) owner_link[t] = 1;
+
+                if (visited[t]) {
+                    // Subárvore já varrida a partir de outro ponto: deixa de ser topo
+                    if (top[t] && t != start) top[t] = 0;
+                    continue;
+                }
+                visited[t] = 1;
+                parent[t] = d;
+                if (is_dir(table_inode(table, t))) queue[tail++] = t;
+            }
+            free(entries);
+        }
+    }
+
+    for (uint32_t i = 1; i < inode_count; i++) {
+        Inode *inode = table_inode(table, i);
+        if (inode->mode == 0) continue;
+        if (top[i]) {
+            report->unreachable_dirs++;
+            printf("[FSCK] Diretório %u não é alcançável a partir do root\n", i);
+        } else if (!visited[i]) {
+            report->orphan_inodes++;
+            printf("[FSCK] I-node órfão: %u (%u bytes)\n", i, inode->size);
+        }
+    }
+
+    // Contador de links x entradas (0 em imagens antigas vale como 1). Um
+    // arquivo com vários links é contado no diretório dono (inode->parent)
+    for (uint32_t i = 1; i < inode_count; i++) {
+        Inode *inode = table_inode(table, i);
+        if (inode->mode == 0 || !visited[i] || top[i]) continue;
+        int legacy = inode->nlink == 0 && links[i] == 1;
+        int bad_owner = !is_dir(inode) && links[i] > 1 && !owner_link[i];
+        if ((inode->nlink == links[i] || legacy) && !bad_owner) continue;
+        report->bad_links++;
+        printf("[FSCK] I-node %u: %u links registrados, %u entradas%s\n", i, inode->nlink, links[i],
+               bad_owner ? ", diretório dono incorreto" : "");
+        if (repair) {
+            inode->nlink = links[i];
+            if (bad_owner) inode->parent = parent[i];
+            inode_save(disk, i, inode);
+            report->repaired++;
+        }
+    }
+
+    // Uso acumulado de cada diretório: arquivos somados ao diretório dono e
+    // diretórios somados ao pai, da fila de trás para frente
+    uint64_t *usage = calloc((size_t)inode_count * 3, sizeof(uint64_t)); // bytes, blocos, arquivos
+    for (uint32_t i = 0; i < inode_count; i++) {
+        Inode *inode = table_inode(table, i);
+        if (inode->mode == 0 || !visited[i]) continue;
+        uint64_t *u = &usage[(size_t)i * 3];
+        // Soma: um diretório pode já ter recebido arquivos de número menor
+        u[0] += inode->size;
+        for (int k = 0; k < MAX_BLOCKS_PER_INODE; k++) {
+            if (block_valid(disk, inode->blocks[k])) u[1]++; // Ponteiros inválidos serão zerados
+        }
+        u[2] += !is_dir(inode);
+        uint32_t owner = (!is_dir(inode) && links[i] > 1 && owner_link[i]) ? inode->parent : parent[i];
+        if (!is_dir(inode) && owner != (uint32_t)-1) {
+            uint64_t *p = &usage[(size_t)owner * 3];
+            for (int k = 0; k < 3; k++) p[k] += u[k];
+        }
+    }
+    for (uint32_t q = tail; q-- > 0;) {
+        uint32_t d = queue[q];
+        if (d == 0 || parent[d] == (uint32_t)-1) continue;
+        uint64_t *p = &usage[(size_t)parent[d] * 3];
+        for (int k = 0; k < 3; k++) p[k] += usage[(size_t)d * 3 + k];
+    }
+    for (uint32_t q = 0; q < tail; q++) {
+        uint32_t d = queue[q];
+        Inode *dir = table_inode(table, d);
+        uint64_t *u = &usage[(size_t)d * 3];
+        int bad_parent = parent[d] != (uint32_t)-1 && dir->parent != parent[d];
+        if (!bad_parent && dir->tree_bytes == u[0] && dir->tree_blocks == u[1] && dir->tree_files == u[2]) continue;
+        report->bad_usage++;
+        printf("[FSCK] Diretório %u: uso acumulado %llu bytes/%llu blocos/%u arquivos (esperado %llu/%llu/%llu)%s\n",
+               d, (unsigned long long)dir->tree_bytes, (unsigned long long)dir->tree_blocks, dir->tree_files,
+               (unsigned long long)u[0], (unsigned long long)u[1], (unsigned long long)u[2],
+               bad_parent ? ", pai incorreto" : "");
+        if (repair) {
+            if (parent[d] != (uint32_t)-1) dir->parent = parent[d];
+            dir->tree_bytes = u[0];
+            dir->tree_blocks = u[1];
+            dir->tree_files = (uint32_t)u[2];
+            inode_save(disk, d, dir);
+            report->repaired++;
+        }
+    }
+    free(usage);
+
+    // 4. Bitmap x mapas de blocos dos i-nodes (e blocos dos snapshots)
+    uint8_t *snap_owned = calloc(total_blocks, 1);
+    snapshot_mark_blocks(disk, snap_owned);
+    uint32_t marked_free = 0;
+    for (uint32_t b = 0; b < total_blocks; b++) {
+        int marked = (bitmap[b / 8] >> (b % 8)) & 1;
+        if (!marked) marked_free++;
+        int in_use = b < sb->data_start_block || block_refs[b] > 0 || snap_owned[b];
+
+        if (block_refs[b] > 1) {
+            report->double_alloc++;
+            printf("[FSCK] Bloco %u referenciado por %u i-nodes\n", b, block_refs[b]);
+        }
+        if (in_use && !marked) {
+            report->unmarked_blocks++;
+            printf("[FSCK] Bloco %u em uso mas livre no bitmap\n", b);
+            if (repair) {
+                bitmap_set(disk, b, 1);
+                report->repaired++;
+            }
+        } else if (!in_use && marked) {
+            report->leaked_blocks++;
+            if (repair) {
+                bitmap_set(disk, b, 0);
+                report->repaired++;
+            }
+        }
+    }
+    free(snap_owned);
+    if (report->leaked_blocks > 0) {
+        printf("[FSCK] %u blocos marcados no bitmap sem nenhum dono\n", report->leaked_blocks);
+    }
+
+    // Contadores do superbloco x bitmaps
+    uint32_t inodes_free = count_zero_bits(inode_bitmap, inode_count);
+    if (sb->free_blocks != marked_free || sb->free_blocks_count != marked_free || sb->free_inodes != inodes_free) {
+        report->bad_counters++;
+        printf("[FSCK] Contadores do superbloco incorretos (blocos livres %u, esperado %u; i-nodes livres %u, esperado %u)\n",
+               sb->free_blocks, marked_free, sb->free_inodes, inodes_free);
+        if (repair) report->repaired++; // Recontados ao final dos reparos
+    }
+
+    // 5. Reparos nos mapas de blocos: ponteiros inválidos são zerados e
+    // blocos compartilhados são duplicados (o primeiro dono fica com o original)
+    if (repair && (report->invalid_blocks > 0 || report->double_alloc > 0)) {
+        uint8_t *claimed = calloc(total_blocks, 1);
+        uint8_t *copy = malloc(disk->block_size);
+
+        for (uint32_t i = 0; i < inode_count; i++) {
+            Inode *inode = table_inode(table, i);
+            if (inode->mode == 0) continue;
+            int dirty = 0;
+
+            for (int k = 0; k < MAX_BLOCKS_PER_INODE; k++) {
+                uint32_t b = inode->blocks[k];
+                if (b == 0 || b == (uint32_t)-1) continue;
+                if (!block_valid(disk, b)) {
+                    printf("[FSCK] I-node %u: ponteiro inválido %u removido\n", i, b);
+                    inode->blocks[k] = 0;
+                    dirty = 1;
+                    report->repaired++;
+                    continue;
+                }
+                if (block_refs[b] < 2) continue;
+                if (!claimed[b]) {
+                    claimed[b] = 1;
+                    continue;
+                }
+
+                uint32_t new_block = bitmap_find_free_block(disk);
+                if (new_block == (uint32_t)-1) {
+                    printf("[ERRO] Sem blocos livres para duplicar o bloco %u\n", b);
+                    continue;
+                }
+                bitmap_set(disk, new_block, 1);
+                read_full(disk->fd, copy, disk->block_size, disk_block_offset(disk, b));
+                pwrite(disk->fd, copy, disk->block_size, disk_block_offset(disk, new_block));
+                printf("[FSCK] I-node %u: bloco %u duplicado para %u\n", i, b, new_block);
+                inode->blocks[k] = new_block;
+                dirty = 1;
+                report->repaired++;
+            }
+            if (dirty) inode_save(disk, i, inode);
+        }
+        free(copy);
+        free(claimed);
+    }
+
+    // 6. Reanexa órfãos e diretórios inalcançáveis em /lost+found
+    if (repair && (report->orphan_inodes > 0 || report->unreachable_dirs > 0)) {
+        uint32_t lost_found = lost_found_inode(disk);
+        if (lost_found == (uint32_t)-1) {
+            printf("[ERRO] Não foi possível criar /%s\n", FSCK_LOST_FOUND);
+        } else {
+            for (uint32_t i = 1; i < inode_count; i++) {
+                Inode *inode = table_inode(table, i);
+                if (inode->mode == 0 || (visited[i] && !top[i])) continue;
+
+                char name[MAX_NAME_LEN];
+                snprintf(name, sizeof(name), "#%u", i);
+                // A entrada em lost+found passa a ser o único link
+                inode->nlink = 0;
+                inode_save(disk, i, inode);
+                if (dir_add_entry(disk, lost_found, i, name) != 0) continue;
+                inode->nlink = 1;
+                inode->parent = lost_found;
+
+                if (top[i] && inode->size >= 2 * DIR_ENTRY_SIZE && block_valid(disk, inode->blocks[0])) {
+                    DirEntry dotdot;
+                    memset(&dotdot, 0, sizeof(DirEntry));
+                    dotdot.inode_num = lost_found;
+                    strcpy(dotdot.name, "..");
+                    write_dir_entry(disk, i, inode, 1, &dotdot);
+                }
+                printf("[FSCK] I-node %u reanexado em /%s/%s\n", i, FSCK_LOST_FOUND, name);
+                report->repaired++;
+            }
+        }
+    }
+
+    // Após os reparos, os contadores são recalculados a partir dos bitmaps
+    if (repair) recount_free(disk);
+
+    free(queue);
+    free(inode_bitmap);
+    free(owner_link);
+    free(links);
+    free(parent);
+    free(top);
+    free(visited);
+    free(block_refs);
+    free(table);
+    free(bitmap);
+
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    report->elapsed_ms = (t1.tv_sec - t0.tv_sec) * 1000.0 + (t1.tv_nsec - t0.tv_nsec) / 1e6;
+
+    return report->orphan_inodes + report->unreachable_dirs + report->double_alloc +
+           report->invalid_blocks + report->unmarked_blocks + report->leaked_blocks +
+           report->dangling_entries + report->bad_dot_entries +
+           report->inode_bitmap_errors + report->bad_counters + report->bad_usage + report->bad_links;
+}
+
+void fsck_print_report(const FsckReport *report) {
+    printf("=== VERIFICAÇÃO DO SISTEMA DE ARQUIVOS ===\n");
+    printf("I-nodes em uso: %u\n", report->inodes_used);
+    printf("I-nodes órfãos: %u\n", report->orphan_inodes);
+    printf("Diretórios inalcançáveis: %u\n", report->unreachable_dirs);
+    printf("Blocos com alocação dupla: %u\n", report->double_alloc);
+    printf("Ponteiros de bloco inválidos: %u\n", report->invalid_blocks);
+    printf("Blocos em uso livres no bitmap: %u\n", report->unmarked_blocks);
+    printf("Blocos perdidos no bitmap: %u\n", report->leaked_blocks);
+    printf("Entradas de diretório pendentes: %u\n", report->dangling_entries);
+    printf("Entradas '.'/'..' incorretas: %u\n", report->bad_dot_entries);
+    printf("Erros no bitmap de i-nodes: %u\n", report->inode_bitmap_errors);
+    printf("Contadores do superbloco incorretos: %u\n", report->bad_counters);
+    printf("Diretórios com uso acumulado incorreto: %u\n", report->bad_usage);
+    printf("I-nodes com contador de links incorreto: %u\n", report->bad_links);
+    printf("Problemas corrigidos: %u\n", report->repaired);
+    printf("Tempo: %.2f ms (%d threads)\n", report->elapsed_ms, report->threads);
+}
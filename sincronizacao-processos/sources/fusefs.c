@@ -0,0 +1,452 @@
+// Adaptador FUSE: monta uma imagem do simulador num diretório do host.
+// Compilado só por "make fuse" (precisa da libfuse3)
+#define _GNU_SOURCE
+#define FUSE_USE_VERSION 31
+#include <fuse.h>
+#include "disk.h"
+#include "superblock.h"
+#include "inode.h"
+#include "bitmap.h"
+#include "dir.h"
+#include "alloc.h"
+#include "diskio.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+#include <time.h>
+
+// As operações de leitura rodam em paralelo nas threads do FUSE; as que
+// alteram a imagem são exclusivas (inode.c e dir.c não têm trava própria)
+static pthread_rwlock_t fs_lock = PTHREAD_RWLOCK_INITIALIZER;
+
+static Disk *fs_disk(void) {
+    return fuse_get_context()->private_data;
+}
+
+static int is_dir(const Inode *inode) {
+    return (inode->mode & 040000) == 040000;
+}
+
+// Resolve o caminho a partir do root. Retorna o i-node ou (uint32_t)-1
+static uint32_t resolve(Disk *disk, const char *path) {
+    uint32_t current = 0;
+    char name[MAX_NAME_LEN];
+    while (*path) {
+        while (*path == '/') path++;
+        if (!*path) break;
+        size_t len = strcspn(path, "/");
+        if (len >= MAX_NAME_LEN) return (uint32_t)-1;
+        memcpy(name, path, len);
+        name[len] = '\0';
+        current = dir_lookup(disk, current, name);
+        if (current == (uint32_t)-1) return current;
+        path += len;
+    }
+    return current;
+}
+
+// Separa o caminho em diretório pai (resolvido) e último componente.
+// Retorna 0 ou -errno
+static int resolve_parent(Disk *disk, const char *path, uint32_t *parent, char name[MAX_NAME_LEN]) {
+    const char *slash = strrchr(path, '/');
+    const char *last = slash ? slash + 1 : path;
+    size_t len = strlen(last);
+    if (len == 0) return -EINVAL;
+    if (len >= MAX_NAME_LEN) return -ENAMETOOLONG;
+    memcpy(name, last, len + 1);
+
+    char dir_path[4096];
+    size_t dir_len = slash ? (size_t)(slash - path) : 0;
+    if (dir_len >= sizeof(dir_path)) return -ENAMETOOLONG;
+    memcpy(dir_path, path, dir_len);
+    dir_path[dir_len] = '\0';
+    *parent = resolve(disk, dir_path);
+    if (*parent == (uint32_t)-1) return -ENOENT;
+    return 0;
+}
+
+static void fill_stat(Disk *disk, uint32_t inode_num, const Inode *inode, struct stat *st) {
+    memset(st, 0, sizeof(struct stat));
+    uint32_t blocks = 0;
+    for (uint32_t i = 0; i < MAX_BLOCKS_PER_INODE; i++) {
+        if (inode->blocks[i] != 0) blocks++;
+    }
+    st->st_ino = inode_num;
+    st->st_mode = inode->mode;
+    st->st_nlink = is_dir(inode) ? 2 : (inode->nlink ? inode->nlink : 1);
+    st->st_uid = inode->uid;
+    st->st_size = inode->size;
+    st->st_blksize = disk->block_size;
+    st->st_blocks = (blkcnt_t)blocks * disk->block_size / 512;
+    st->st_mtime = inode->modified_at;
+    st->st_ctime = inode->modified_at;
+    st->st_atime = inode->modified_at;
+}
+
+/* ====================== */
+/* Leitura                */
+/* ====================== */
+
+static int fs_getattr(const char *path, struct stat *st, struct fuse_file_info *fi) {
+    (void)fi;
+    Disk *disk = fs_disk();
+    pthread_rwlock_rdlock(&fs_lock);
+    int result = -ENOENT;
+    uint32_t inode_num = resolve(disk, path);
+    Inode *inode = inode_num != (uint32_t)-1 ? inode_load(disk, inode_num) : NULL;
+    if (inode) {
+        if (inode->mode != 0) {
+            fill_stat(disk, inode_num, inode, st);
+            result = 0;
+        }
+        inode_put(inode);
+    }
+    pthread_rwlock_unlock(&fs_lock);
+    return result;
+}
+
+static int fs_readdir(const char *path, void *buf, fuse_fill_dir_t filler, off_t offset,
+                      struct fuse_file_info *fi, enum fuse_readdir_flags flags) {
+    (void)offset;
+    (void)fi;
+    (void)flags;
+    Disk *disk = fs_disk();
+    pthread_rwlock_rdlock(&fs_lock);
+    DirIter it;
+    uint32_t dir = resolve(disk, path);
+    if (dir == (uint32_t)-1 || dir_iter_open(disk, dir, 0, &it) != 0) {
+        pthread_rwlock_unlock(&fs_lock);
+        return dir == (uint32_t)-1 ? -ENOENT : -ENOTDIR;
+    }
+    DirEntry *e;
+    while ((e = dir_iter_next(&it, NULL)) != NULL) {
+        if (filler(buf, e->name, NULL, 0, 0) != 0) break;
+    }
+    dir_iter_close(&it);
+    pthread_rwlock_unlock(&fs_lock);
+    return 0;
+}
+
+static int fs_open(const char *path, struct fuse_file_info *fi) {
+    (void)fi;
+    Disk *disk = fs_disk();
+    pthread_rwlock_rdlock(&fs_lock);
+    int result = -ENOENT;
+    uint32_t inode_num = resolve(disk, path);
+    Inode *inode = inode_num != (uint32_t)-1 ? inode_load(disk, inode_num) : NULL;
+    if (inode) {
+        result = is_dir(inode) ? -EISDIR : 0;
+        inode_put(inode);
+    }
+    pthread_rwlock_unlock(&fs_lock);
+    return result;
+}
+
+static int fs_read(const char *path, char *buf, size_t size, off_t offset, struct fuse_file_info *fi) {
+    (void)fi;
+    Disk *disk = fs_disk();
+    pthread_rwlock_rdlock(&fs_lock);
+    uint32_t inode_num = resolve(disk, path);
+    if (inode_num == (uint32_t)-1) {
+        pthread_rwlock_unlock(&fs_lock);
+        return -ENOENT;
+    }
+    uint8_t *buffer = disk_buf_get(disk);
+    int len = file_read_data(disk, inode_num, buffer);
+    int result = -EISDIR;
+    if (len >= 0) {
+        result = 0;
+        if (offset < len) {
+            result = (size_t)(len - offset) < size ? len - (int)offset : (int)size;
+            memcpy(buf, buffer + offset, result);
+        }
+    }
+    disk_buf_put(disk, buffer);
+    pthread_rwlock_unlock(&fs_lock);
+    return result;
+}
+
+static int fs_statfs(const char *path, struct statvfs *sv) {
+    (void)path;
+    Disk *disk = fs_disk();
+    FsStat st;
+    pthread_rwlock_rdlock(&fs_lock);
+    superblock_statfs(disk, &st);
+    pthread_rwlock_unlock(&fs_lock);
+    memset(sv, 0, sizeof(struct statvfs));
+    sv->f_bsize = st.block_size;
+    sv->f_frsize = st.block_size;
+    sv->f_blocks = st.total_blocks;
+    sv->f_bfree = st.free_blocks;
+    sv->f_bavail = st.free_blocks;
+    sv->f_files = st.total_inodes;
+    sv->f_ffree = st.free_inodes;
+    sv->f_favail = st.free_inodes;
+    sv->f_namemax = MAX_NAME_LEN - 1;
+    return 0;
+}
+
+/* ====================== */
+/* Escrita                */
+/* ====================== */
+
+static int fs_create(const char *path, mode_t mode, struct fuse_file_info *fi) {
+    (void)mode;
+    (void)fi;
+    Disk *disk = fs_disk();
+    uint32_t parent;
+    char name[MAX_NAME_LEN];
+    pthread_rwlock_wrlock(&fs_lock);
+    int result = resolve_parent(disk, path, &parent, name);
+    if (result == 0 && dir_lookup(disk, parent, name) != (uint32_t)-1) result = -EEXIST;
+    if (result == 0 && file_create_data(disk, parent, name, NULL, 0) == (uint32_t)-1) result = -ENOSPC;
+    pthread_rwlock_unlock(&fs_lock);
+    return result;
+}
+
+static int fs_mkdir(const char *path, mode_t mode) {
+    (void)mode;
+    Disk *disk = fs_disk();
+    uint32_t parent;
+    char name[MAX_NAME_LEN];
+    pthread_rwlock_wrlock(&fs_lock);
+    int result = resolve_parent(disk, path, &parent, name);
+    if (result == 0 && dir_lookup(disk, parent, name) != (uint32_t)-1) result = -EEXIST;
+    if (result == 0 && dir_create(disk, parent, name) != 0) result = -ENOSPC;
+    pthread_rwlock_unlock(&fs_lock);
+    return result;
+}
+
+static int fs_write(const char *path, const char *buf, size_t size, off_t offset, struct fuse_file_info *fi) {
+    (void)fi;
+    Disk *disk = fs_disk();
+    uint32_t parent;
+    char name[MAX_NAME_LEN];
+    if ((uint64_t)offset + size > (uint64_t)MAX_BLOCKS_PER_INODE * disk->block_size) return -EFBIG;
+    pthread_rwlock_wrlock(&fs_lock);
+    int result = resolve_parent(disk, path, &parent, name);
+    uint32_t inode_num = result == 0 ? dir_lookup(disk, parent, name) : (uint32_t)-1;
+    if (result == 0 && inode_num == (uint32_t)-1) result = -ENOENT;
+    if (result == 0) {
+        result = file_write_data(disk, parent, inode_num, (uint32_t)offset, (const uint8_t *)buf, (uint32_t)size) == 0
+                     ? (int)size : -ENOSPC;
+    }
+    pthread_rwlock_unlock(&fs_lock);
+    return result;
+}
+
+static int fs_truncate(const char *path, off_t size, struct fuse_file_info *fi) {
+    (void)fi;
+    Disk *disk = fs_disk();
+    uint32_t parent;
+    char name[MAX_NAME_LEN];
+    if ((uint64_t)size > (uint64_t)MAX_BLOCKS_PER_INODE * disk->block_size) return -EFBIG;
+    pthread_rwlock_wrlock(&fs_lock);
+    int result = resolve_parent(disk, path, &parent, name);
+    uint32_t inode_num = result == 0 ? dir_lookup(disk, parent, name) : (uint32_t)-1;
+    if (result == 0 && inode_num == (uint32_t)-1) result = -ENOENT;
+    if (result == 0 && file_truncate(disk, parent, inode_num, (uint32_t)size) != 0) result = -EISDIR;
+    pthread_rwlock_unlock(&fs_lock);
+    return result;
+}
+
+static int fs_unlink(const char *path) {
+    Disk *disk = fs_disk();
+    uint32_t parent;
+    char name[MAX_NAME_LEN];
+    pthread_rwlock_wrlock(&fs_lock);
+    int result = resolve_parent(disk, path, &parent, name);
+    uint32_t inode_num = result == 0 ? dir_lookup(disk, parent, name) : (uint32_t)-1;
+    if (result == 0 && inode_num == (uint32_t)-1) result = -ENOENT;
+    if (result == 0 && file_delete(disk, parent, inode_num) != 0) result = -EISDIR;
+    pthread_rwlock_unlock(&fs_lock);
+    return result;
+}
+
+// Remove um diretório vazio (só "." e ".."), como o comando delete_dir
+static int remove_dir(Disk *disk, uint32_t parent, uint32_t dir) {
+    DirIter it;
+    if (dir_iter_open(disk, dir, 0, &it) != 0) return -ENOTDIR;
+    DirEntry *e;
+    int entries = 0;
+    while ((e = dir_iter_next(&it, NULL)) != NULL) {
+        if (strcmp(e->name, ".") != 0 && strcmp(e->name, "..") != 0) entries++;
+    }
+    dir_iter_close(&it);
+    if (entries > 0) return -ENOTEMPTY;
+    if (dir_remove_entry(disk, parent, dir) != 0) return -EIO;
+
+    Inode *inode = inode_load(disk, dir);
+    if (!inode) return -EIO;
+    for (int i = 0; i < MAX_BLOCKS_PER_INODE; i++) {
+        if (inode->blocks[i] != 0 && inode->blocks[i] != (uint32_t)-1) bitmap_set(disk, inode->blocks[i], 0);
+    }
+    inode_put(inode);
+    inode_free(disk, dir);
+    return 0;
+}
+
+static int fs_rmdir(const char *path) {
+    Disk *disk = fs_disk();
+    uint32_t parent;
+    char name[MAX_NAME_LEN];
+    pthread_rwlock_wrlock(&fs_lock);
+    int result = resolve_parent(disk, path, &parent, name);
+    uint32_t dir = result == 0 ? dir_lookup(disk, parent, name) : (uint32_t)-1;
+    if (result == 0 && dir == (uint32_t)-1) result = -ENOENT;
+    if (result == 0) result = remove_dir(disk, parent, dir);
+    pthread_rwlock_unlock(&fs_lock);
+    return result;
+}
+
+static int fs_link(const char *from, const char *to) {
+    Disk *disk = fs_disk();
+    uint32_t parent;
+    char name[MAX_NAME_LEN];
+    pthread_rwlock_wrlock(&fs_lock);
+    uint32_t inode_num = resolve(disk, from);
+    int result = inode_num == (uint32_t)-1 ? -ENOENT : resolve_parent(disk, to, &parent, name);
+    if (result == 0 && dir_lookup(disk, parent, name) != (uint32_t)-1) result = -EEXIST;
+    if (result == 0 && file_link(disk, parent, inode_num, name) != 0) result = -EPERM;
+    pthread_rwlock_unlock(&fs_lock);
+    return result;
+}
+
+// Mesmo diretório: renomeia a entrada. Outro diretório: remove e adiciona com
+// o novo nome (como move_file). Um arquivo no destino é substituído
+static int fs_rename(const char *from, const char *to, unsigned int flags) {
+    Disk *disk = fs_disk();
+    uint32_t from_parent, to_parent;
+    char from_name[MAX_NAME_LEN], to_name[MAX_NAME_LEN];
+    if (flags & RENAME_EXCHANGE) return -EINVAL;
+    pthread_rwlock_wrlock(&fs_lock);
+    int result = resolve_parent(disk, from, &from_parent, from_name);
+    if (result == 0) result = resolve_parent(disk, to, &to_parent, to_name);
+    uint32_t inode_num = result == 0 ? dir_lookup(disk, from_parent, from_name) : (uint32_t)-1;
+    if (result == 0 && inode_num == (uint32_t)-1) result = -ENOENT;
+
+    uint32_t existing = result == 0 ? dir_lookup(disk, to_parent, to_name) : (uint32_t)-1;
+    if (result == 0 && existing == inode_num) {
+        pthread_rwlock_unlock(&fs_lock);
+        return 0;
+    }
+    if (result == 0 && existing != (uint32_t)-1) {
+        if (flags & RENAME_NOREPLACE) result = -EEXIST;
+        else if (file_delete(disk, to_parent, existing) != 0) result = -EEXIST; // Diretórios não são substituídos
+    }
+
+    if (result == 0) {
+        if (from_parent == to_parent) {
+            if (dir_rename_entry(disk, from_parent, inode_num, to_name) != 0) result = -EIO;
+        } else if (dir_remove_entry(disk, from_parent, inode_num) != 0) {
+            result = -EIO;
+        } else if (dir_add_entry(disk, to_parent, inode_num, to_name) != 0) {
+            dir_add_entry(disk, from_parent, inode_num, from_name); // Volta para a origem
+            result = -ENOSPC;
+        }
+    }
+    pthread_rwlock_unlock(&fs_lock);
+    return result;
+}
+
+static int fs_utimens(const char *path, const struct timespec tv[2], struct fuse_file_info *fi) {
+    (void)fi;
+    Disk *disk = fs_disk();
+    pthread_rwlock_wrlock(&fs_lock);
+    int result = -ENOENT;
+    uint32_t inode_num = resolve(disk, path);
+    Inode *inode = inode_num != (uint32_t)-1 ? inode_load(disk, inode_num) : NULL;
+    if (inode) {
+        inode->modified_at = (tv && tv[1].tv_nsec != UTIME_NOW && tv[1].tv_nsec != UTIME_OMIT)
+                                 ? tv[1].tv_sec : time(NULL);
+        if (!tv || tv[1].tv_nsec != UTIME_OMIT) inode_save(disk, inode_num, inode);
+        inode_put(inode);
+        result = 0;
+    }
+    pthread_rwlock_unlock(&fs_lock);
+    return result;
+}
+
+static int fs_chmod(const char *path, mode_t mode, struct fuse_file_info *fi) {
+    (void)fi;
+    Disk *disk = fs_disk();
+    pthread_rwlock_wrlock(&fs_lock);
+    int result = -ENOENT;
+    uint32_t inode_num = resolve(disk, path);
+    Inode *inode = inode_num != (uint32_t)-1 ? inode_load(disk, inode_num) : NULL;
+    if (inode) {
+        inode->mode = (inode->mode & ~07777u) | (mode & 07777);
+        inode_save(disk, inode_num, inode);
+        inode_put(inode);
+        result = 0;
+    }
+    pthread_rwlock_unlock(&fs_lock);
+    return result;
+}
+
+// Não há grupos na imagem: só confirma que o caminho existe
+static int fs_chown(const char *path, uid_t uid, gid_t gid, struct fuse_file_info *fi) {
+    (void)uid;
+    (void)gid;
+    (void)fi;
+    Disk *disk = fs_disk();
+    pthread_rwlock_rdlock(&fs_lock);
+    int result = resolve(disk, path) == (uint32_t)-1 ? -ENOENT : 0;
+    pthread_rwlock_unlock(&fs_lock);
+    return result;
+}
+
+static void *fs_init(struct fuse_conn_info *conn, struct fuse_config *cfg) {
+    (void)conn;
+    cfg->use_ino = 1;           // st_ino é o número do i-node da imagem
+    cfg->kernel_cache = 1;      // A imagem só muda por este processo
+    return fuse_get_context()->private_data;
+}
+
+static const struct fuse_operations fs_ops = {
+    .init = fs_init,
+    .getattr = fs_getattr,
+    .readdir = fs_readdir,
+    .open = fs_open,
+    .read = fs_read,
+    .statfs = fs_statfs,
+    .create = fs_create,
+    .mkdir = fs_mkdir,
+    .write = fs_write,
+    .truncate = fs_truncate,
+    .unlink = fs_unlink,
+    .rmdir = fs_rmdir,
+    .rename = fs_rename,
+    .link = fs_link,
+    .utimens = fs_utimens,
+    .chmod = fs_chmod,
+    .chown = fs_chown,
+};
+
+int main(int argc, char **argv) {
+    if (argc < 3) {
+        fprintf(stderr, "Uso: %s imagem ponto_de_montagem [opções do FUSE, ex.: -f -s -o allow_other]\n", argv[0]);
+        return 1;
+    }
+    Disk *disk = superblock_open(argv[1]);
+    if (!disk) {
+        fprintf(stderr, "[ERRO] %s não existe ou não é uma imagem válida\n", argv[1]);
+        return 1;
+    }
+    alloc_attach(disk, disk->sb->alloc_policy);
+    // Motor síncrono: o FUSE pode criar um processo novo ao ir para o fundo
+    // (as threads do pool e o anel do io_uring não iriam junto), e os pedidos
+    // chegam de várias threads, que já executam na hora
+    disk_io_init(disk, DISK_IO_SYNC, DISK_IO_DEPTH_DEFAULT);
+
+    // O FUSE recebe os argumentos sem a imagem
+    argv[1] = argv[0];
+    int result = fuse_main(argc - 1, argv + 1, &fs_ops, disk);
+
+    Superblock *sb = disk->sb; // Alocado por superblock_load
+    disk_free(disk);
+    free(sb);
+    return result;
+}
@@ -0,0 +1,243 @@
+#include "icache.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+// I-node em memória. O Inode vem primeiro: o ponteiro entregue aos
+// chamadores é o próprio objeto
+typedef struct ICacheEntry {
+    Inode inode;
+    struct ICache *owner;            // Cache do disco (NULL = anônimo)
+    uint32_t inode_num;
+    uint32_t refcount;
+    struct ICacheEntry *hash_next;
+    struct ICacheEntry *lru_prev;    // Lista LRU dos sem referência
+    struct ICacheEntry *lru_next;    // (também encadeia a lista livre do slab)
+} ICacheEntry;
+
+struct ICache {
+    ICacheEntry *buckets[ICACHE_BUCKETS];
+    ICacheEntry lru;                 // Sentinela: lru_next é o mais antigo
+    uint32_t cached;
+    uint32_t unused;
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;
+};
+
+// Um único lock protege os slabs e os caches de todos os discos
+static pthread_mutex_t icache_lock = PTHREAD_MUTEX_INITIALIZER;
+static ICacheEntry *slab_free_list = NULL;
+static uint32_t slab_count = 0;
+static uint32_t slab_free_count = 0;
+static uint32_t objects_in_use = 0;
+static uint32_t max_unused = ICACHE_MAX_UNUSED; // Limite da lista LRU (icache_set_limit)
+
+/* ====================== */
+/* Slab                   */
+/* ====================== */
+
+static ICacheEntry *slab_get(void) {
+    if (!slab_free_list) {
+        // Slab novo: os objetos nunca voltam ao malloc, só à lista livre
+        ICacheEntry *slab = malloc(ICACHE_SLAB_OBJECTS * sizeof(ICacheEntry));
+        if (!slab) return NULL;
+        for (int i = 0; i < ICACHE_SLAB_OBJECTS; i++) {
+            slab[i].lru_next = slab_free_list;
+            slab_free_list = &slab[i];
+        }
+        slab_count++;
+        slab_free_count += ICACHE_SLAB_OBJECTS;
+    }
+    ICacheEntry *e = slab_free_list;
+    slab_free_list = e->lru_next;
+    slab_free_count--;
+    objects_in_use++;
+    memset(e, 0, sizeof(ICacheEntry));
+    e->refcount = 1;
+    return e;
+}
+
+static void slab_release(ICacheEntry *e) {
+    e->lru_next = slab_free_list;
+    slab_free_list = e;
+    slab_free_count++;
+    objects_in_use--;
+}
+
+/* ====================== */
+/* Tabela hash e LRU      */
+/* ====================== */
+
+static uint32_t bucket_of(uint32_t inode_num) {
+    return inode_num & (ICACHE_BUCKETS - 1);
+}
+
+static struct ICache *cache_of(Disk *disk) {
+    if (!disk->icache) {
+        disk->icache = calloc(1, sizeof(struct ICache));
+        disk->icache->lru.lru_next = disk->icache->lru.lru_prev = &disk->icache->lru;
+    }
+    return disk->icache;
+}
+
+static void lru_unlink(struct ICache *cache, ICacheEntry *e) {
+    e->lru_prev->lru_next = e->lru_next;
+    e->lru_next->lru_prev = e->lru_prev;
+    cache->unused--;
+}
+
+static void lru_push(struct ICache *cache, ICacheEntry *e) {
+    e->lru_prev = cache->lru.lru_prev;
+    e->lru_next = &cache->lru;
+    cache->lru.lru_prev->lru_next = e;
+    cache->lru.lru_prev = e;
+    cache->unused++;
+}
+
+static ICacheEntry *hash_find(struct ICache *cache, uint32_t inode_num) {
+    ICacheEntry *e = cache->buckets[bucket_of(inode_num)];
+    while (e && e->inode_num != inode_num) e = e->hash_next;
+    return e;
+}
+
+static void hash_remove(struct ICache *cache, ICacheEntry *e) {
+    ICacheEntry **link = &cache->buckets[bucket_of(e->inode_num)];
+    while (*link != e) link = &(*link)->hash_next;
+    *link = e->hash_next;
+    cache->cached--;
+}
+
+// Tira o objeto do cache: sem referência volta ao slab, com referência
+// vira anônimo e é liberado no último icache_put
+static void entry_drop(struct ICache *cache, ICacheEntry *e) {
+    hash_remove(cache, e);
+    if (e->refcount == 0) {
+        lru_unlink(cache, e);
+        slab_release(e);
+    } else {
+        e->owner = NULL;
+    }
+}
+
+// Ganha uma referência sobre um objeto do cache
+static void entry_hold(struct ICache *cache, ICacheEntry *e) {
+    if (e->refcount++ == 0) lru_unlink(cache, e);
+}
+
+/* ====================== */
+/* API                    */
+/* ====================== */
+
+Inode *icache_alloc(void) {
+    pthread_mutex_lock(&icache_lock);
+    ICacheEntry *e = slab_get();
+    pthread_mutex_unlock(&icache_lock);
+    return e ? &e->inode : NULL;
+}
+
+void icache_put(Inode *inode) {
+    if (!inode) return;
+    ICacheEntry *e = (ICacheEntry *)inode;
+
+    pthread_mutex_lock(&icache_lock);
+    if (--e->refcount == 0) {
+        struct ICache *cache = e->owner;
+        if (!cache) {
+            slab_release(e);
+        } else {
+            lru_push(cache, e);
+            // Cache cheio: descarta os menos usados recentemente
+            while (cache->unused > max_unused) {
+                entry_drop(cache, cache->lru.lru_next);
+                cache->evictions++;
+            }
+        }
+    }
+    pthread_mutex_unlock(&icache_lock);
+}
+
+Inode *icache_lookup(Disk *disk, uint32_t inode_num) {
+    pthread_mutex_lock(&icache_lock);
+    struct ICache *cache = cache_of(disk);
+    ICacheEntry *e = hash_find(cache, inode_num);
+    if (e) {
+        entry_hold(cache, e);
+        cache->hits++;
+    } else {
+        cache->misses++;
+    }
+    pthread_mutex_unlock(&icache_lock);
+    return e ? &e->inode : NULL;
+}
+
+Inode *icache_insert(Disk *disk, uint32_t inode_num, Inode *inode) {
+    ICacheEntry *e = (ICacheEntry *)inode;
+
+    pthread_mutex_lock(&icache_lock);
+    struct ICache *cache = cache_of(disk);
+    ICacheEntry *existing = hash_find(cache, inode_num);
+    if (existing) {
+        entry_hold(cache, existing);
+        slab_release(e);
+        e = existing;
+    } else {
+        uint32_t b = bucket_of(inode_num);
+        e->owner = cache;
+        e->inode_num = inode_num;
+        e->hash_next = cache->buckets[b];
+        cache->buckets[b] = e;
+        cache->cached++;
+    }
+    pthread_mutex_unlock(&icache_lock);
+    return &e->inode;
+}
+
+void icache_update(Disk *disk, uint32_t inode_num, const Inode *inode) {
+    if (!disk->icache) return;
+    pthread_mutex_lock(&icache_lock);
+    ICacheEntry *e = hash_find(disk->icache, inode_num);
+    if (e && &e->inode != inode) memcpy(&e->inode, inode, sizeof(Inode));
+    pthread_mutex_unlock(&icache_lock);
+}
+
+void icache_invalidate(Disk *disk, uint32_t inode_num) {
+    if (!disk->icache) return;
+    pthread_mutex_lock(&icache_lock);
+    ICacheEntry *e = hash_find(disk->icache, inode_num);
+    if (e) entry_drop(disk->icache, e);
+    pthread_mutex_unlock(&icache_lock);
+}
+
+void icache_set_limit(uint32_t max) {
+    pthread_mutex_lock(&icache_lock);
+    max_unused = max;
+    pthread_mutex_unlock(&icache_lock);
+}
+
+void icache_destroy(Disk *disk) {
+    struct ICache *cache = disk->icache;
+    if (!cache) return;
+    pthread_mutex_lock(&icache_lock);
+    for (uint32_t b = 0; b < ICACHE_BUCKETS; b++) {
+        while (cache->buckets[b]) entry_drop(cache, cache->buckets[b]);
+    }
+    pthread_mutex_unlock(&icache_lock);
+    free(cache);
+    disk->icache = NULL;
+}
+
+void icache_stats(Disk *disk, ICacheStats *stats) {
+    memset(stats, 0, sizeof(ICacheStats));
+    pthread_mutex_lock(&icache_lock);
+    if (disk->icache) {
+        stats->hits = disk->icache->hits;
+        stats->misses = disk->icache->misses;
+        stats->evictions = disk->icache->evictions;
+        stats->cached = disk->icache->cached;
+    }
+    stats->in_use = objects_in_use;
+    stats->slabs = slab_count;
+    stats->slab_free = slab_free_count;
+    pthread_mutex_unlock(&icache_lock);
+}
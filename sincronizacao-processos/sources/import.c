@@ -0,0 +1,576 @@
+#include "import.h"
+#include "superblock.h"
+#include "inode.h"
+#include "bitmap.h"
+#include "dir.h"
+#include "alloc.h"
+#include "icache.h"
+#include "snapshot.h"
+#include <pthread.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+
+#define IMPORT_TOP ((uint32_t)-1) // "Pai" das entradas do primeiro nível: o diretório de destino
+#define IMPORT_INODE_BATCH 1024   // I-nodes consecutivos gravados por escrita
+
+// Entrada do host a importar. A lista é montada em largura, então os filhos
+// de um diretório ocupam posições consecutivas
+typedef struct {
+    char *host_path;
+    char name[MAX_NAME_LEN];
+    int is_dir;
+    uint32_t size;         // Bytes do arquivo no host
+    uint32_t parent;       // Índice do diretório pai (IMPORT_TOP = destino)
+    uint32_t first_child;  // Diretórios: índice do primeiro filho
+    uint32_t child_count;
+    uint32_t inode_num;
+    Inode inode;
+} ImportNode;
+
+typedef struct {
+    ImportNode *nodes;
+    uint32_t count;
+    uint32_t capacity;
+} NodeList;
+
+// Trechos reservados de uma vez para a importação, consumidos em ordem
+typedef struct {
+    uint32_t *start;
+    uint32_t *len;
+    uint32_t count;
+    uint32_t capacity;
+    uint32_t current;  // Trecho em uso
+    uint32_t used;     // Blocos já consumidos do trecho atual
+} BlockPool;
+
+// Blocos consecutivos acumulados para uma única escrita na imagem
+typedef struct {
+    Disk *disk;
+    uint8_t *buffer;
+    uint32_t start;
+    uint32_t count;
+    uint32_t writes;
+    int error;
+} WriteBatch;
+
+// Arquivo lido por uma thread leitora, aguardando o gravador
+typedef struct {
+    uint8_t *data;
+    uint32_t len;
+    uint32_t seq;      // Posição do arquivo na fila
+    int ready;
+    int error;
+} ImportSlot;
+
+// Fila ordenada entre as threads leitoras e o gravador
+typedef struct {
+    ImportNode *nodes;
+    uint32_t *files;        // Índices dos nós que são arquivos, na ordem de gravação
+    uint32_t file_count;
+    uint32_t next_file;     // Próximo arquivo a ser lido (atômico)
+    uint32_t consumed;      // Arquivos já gravados
+    uint32_t block_size;
+    int readers;            // Threads leitoras (0 = o gravador lê sozinho)
+    ImportSlot slots[IMPORT_QUEUE_DEPTH];
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+} ImportQueue;
+
+static double elapsed_ms(struct timespec *start) {
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    return (end.tv_sec - start->tv_sec) * 1000.0 + (end.tv_nsec - start->tv_nsec) / 1e6;
+}
+
+static int block_is_zero(const uint8_t *p, uint32_t len) {
+    return len == 0 || (p[0] == 0 && memcmp(p, p + 1, len - 1) == 0);
+}
+
+static int cmp_name(const void *a, const void *b) {
+    return strcmp(*(char *const *)a, *(char *const *)b);
+}
+
+/* ====================== */
+/* Varredura do host      */
+/* ====================== */
+
+static uint32_t node_push(NodeList *list) {
+    if (list->count == list->capacity) {
+        list->capacity = list->capacity ? list->capacity * 2 : 256;
+        list->nodes = realloc(list->nodes, list->capacity * sizeof(ImportNode));
+    }
+    memset(&list->nodes[list->count], 0, sizeof(ImportNode));
+    return list->count++;
+}
+
+static void node_list_free(NodeList *list) {
+    for (uint32_t i = 0; i < list->count; i++) free(list->nodes[i].host_path);
+    free(list->nodes);
+}
+
+// Acrescenta à lista os filhos de um diretório do host, em ordem alfabética,
+// até o limite de entradas que cabem no diretório de destino
+static int walk_dir(NodeList *list, uint32_t dir_index, const char *host_path,
+                    uint32_t max_entries, uint32_t block_size, ImportReport *report) {
+    DIR *dir = opendir(host_path);
+    if (!dir) {
+        printf("[ERRO] Não foi possível abrir o diretório do host: %s\n", host_path);
+        return -1;
+    }
+
+    char **names = NULL;
+    uint32_t count = 0, capacity = 0;
+    struct dirent *de;
+    while ((de = readdir(dir)) != NULL) {
+        if (strcmp(de->d_name, ".") == 0 || strcmp(de->d_name, "..") == 0) continue;
+        if (count == capacity) {
+            capacity = capacity ? capacity * 2 : 64;
+            names = realloc(names, capacity * sizeof(char *));
+        }
+        names[count++] = strdup(de->d_name);
+    }
+    closedir(dir);
+    qsort(names, count, sizeof(char *), cmp_name);
+
+    uint32_t first_child = list->count, children = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        size_t path_len = strlen(host_path) + strlen(names[i]) + 2;
+        char *path = malloc(path_len);
+        snprintf(path, path_len, "%s/%s", host_path, names[i]);
+
+        struct stat st;
+        const char *reason = NULL;
+        if (lstat(path, &st) != 0) reason = "não foi possível ler os atributos";
+        else if (!S_ISDIR(st.st_mode) && !S_ISREG(st.st_mode)) reason = "tipo não suportado";
+        else if (strlen(names[i]) >= MAX_NAME_LEN) reason = "nome muito longo";
+        else if (S_ISREG(st.st_mode) && (uint64_t)st.st_size > (uint64_t)MAX_BLOCKS_PER_INODE * block_size)
+            reason = "arquivo muito grande";
+        else if (children >= max_entries) reason = "diretório de destino cheio";
+
+        if (reason) {
+            printf("[AVISO] Ignorando %s (%s)\n", path, reason);
+            report->skipped++;
+            free(path);
+            free(names[i]);
+            continue;
+        }
+
+        uint32_t n = node_push(list);
+        ImportNode *node = &list->nodes[n];
+        node->host_path = path;
+        strncpy(node->name, names[i], MAX_NAME_LEN - 1);
+        node->is_dir = S_ISDIR(st.st_mode);
+        node->size = node->is_dir ? 0 : (uint32_t)st.st_size;
+        node->parent = dir_index;
+        children++;
+        free(names[i]);
+    }
+    free(names);
+
+    if (dir_index != IMPORT_TOP) {
+        list->nodes[dir_index].first_child = first_child;
+        list->nodes[dir_index].child_count = children;
+    }
+    return 0;
+}
+
+/* ====================== */
+/* Reserva de blocos      */
+/* ====================== */
+
+// Reserva total blocos em trechos contíguos, cada um continuando o anterior
+static int pool_reserve(Disk *disk, BlockPool *pool, uint32_t total) {
+    uint32_t goal = 0;
+    while (total > 0) {
+        uint32_t got;
+        uint32_t start = alloc_extent(disk, 1, goal, total, &got);
+        if (start == (uint32_t)-1) return -1;
+        if (pool->count == pool->capacity) {
+            pool->capacity = pool->capacity ? pool->capacity * 2 : 16;
+            pool->start = realloc(pool->start, pool->capacity * sizeof(uint32_t));
+            pool->len = realloc(pool->len, pool->capacity * sizeof(uint32_t));
+        }
+        pool->start[pool->count] = start;
+        pool->len[pool->count++] = got;
+        total -= got;
+        goal = start + got;
+    }
+    return 0;
+}
+
+static uint32_t pool_next(BlockPool *pool) {
+    while (pool->current < pool->count && pool->used == pool->len[pool->current]) {
+        pool->current++;
+        pool->used = 0;
+    }
+    if (pool->current >= pool->count) return (uint32_t)-1;
+    return pool->start[pool->current] + pool->used++;
+}
+
+// Devolve ao bitmap a parte da reserva que não foi usada (buracos)
+static void pool_release_unused(Disk *disk, BlockPool *pool) {
+    for (uint32_t e = pool->current; e < pool->count; e++) {
+        uint32_t skip = (e == pool->current) ? pool->used : 0;
+        if (pool->len[e] > skip) alloc_release_extent(disk, pool->start[e] + skip, pool->len[e] - skip);
+    }
+    free(pool->start);
+    free(pool->len);
+}
+
+/* ====================== */
+/* Gravação em lote       */
+/* ====================== */
+
+static void batch_flush(WriteBatch *w) {
+    if (w->count == 0) return;
+    size_t bytes = (size_t)w->count * w->disk->block_size;
+    if (pwrite(w->disk->fd, w->buffer, bytes, disk_block_offset(w->disk, w->start)) != (ssize_t)bytes) {
+        w->error = 1;
+    }
+    w->writes++;
+    w->count = 0;
+}
+
+static void batch_add(WriteBatch *w, uint32_t block_num, const uint8_t *data) {
+    if (w->count > 0 && (block_num != w->start + w->count || w->count == IMPORT_BATCH_BLOCKS)) {
+        batch_flush(w);
+    }
+    if (w->count == 0) w->start = block_num;
+    memcpy(w->buffer + (size_t)w->count * w->disk->block_size, data, w->disk->block_size);
+    w->count++;
+}
+
+// Grava os i-nodes importados, uma escrita por faixa de números consecutivos
+static void write_inodes(Disk *disk, ImportNode *nodes, uint32_t count) {
+    uint8_t *buffer = malloc(IMPORT_INODE_BATCH * INODE_SIZE);
+    off_t table = disk_block_offset(disk, disk->sb->inode_start);
+    uint32_t i = 0;
+    while (i < count) {
+        uint32_t run = 1;
+        while (i + run < count && run < IMPORT_INODE_BATCH &&
+               nodes[i + run].inode_num == nodes[i].inode_num + run) {
+            run++;
+        }
+        memset(buffer, 0, run * INODE_SIZE);
+        for (uint32_t r = 0; r < run; r++) {
+            memcpy(buffer + r * INODE_SIZE, &nodes[i + r].inode, sizeof(Inode));
+            icache_update(disk, nodes[i + r].inode_num, &nodes[i + r].inode);
+        }
+        // Blocos da tabela congelados por um snapshot são copiados antes
+        uint64_t first = (uint64_t)nodes[i].inode_num * INODE_SIZE / disk->block_size;
+        uint64_t last = ((uint64_t)nodes[i].inode_num + run) * INODE_SIZE - 1;
+        snapshot_cow_meta(disk, disk->sb->inode_start + (uint32_t)first,
+                          (uint32_t)(last / disk->block_size - first + 1));
+        pwrite(disk->fd, buffer, run * INODE_SIZE, table + (off_t)nodes[i].inode_num * INODE_SIZE);
+        i += run;
+    }
+    free(buffer);
+}
+
+/* ====================== */
+/* Leitura em paralelo    */
+/* ====================== */
+
+static int read_host_file(const char *path, uint8_t *data, uint32_t capacity, uint32_t *len) {
+    *len = 0;
+    int fd = open(path, O_RDONLY);
+    if (fd == -1) return -1;
+    while (*len < capacity) {
+        ssize_t n = read(fd, data + *len, capacity - *len);
+        if (n < 0) {
+            close(fd);
+            return -1;
+        }
+        if (n == 0) break;
+        *len += n;
+    }
+    close(fd);
+    return 0;
+}
+
+// Lê o arquivo j da fila para a posição dada
+static void read_slot(ImportQueue *q, uint32_t j, ImportSlot *slot) {
+    slot->error = read_host_file(q->nodes[q->files[j]].host_path, slot->data,
+                                 MAX_BLOCKS_PER_INODE * q->block_size, &slot->len);
+    // Completa o último bloco com zeros
+    uint32_t padded = (slot->len + q->block_size - 1) / q->block_size * q->block_size;
+    memset(slot->data + slot->len, 0, padded - slot->len);
+}
+
+static void *import_reader(void *arg) {
+    ImportQueue *q = arg;
+    for (;;) {
+        uint32_t j = __atomic_fetch_add(&q->next_file, 1, __ATOMIC_RELAXED);
+        if (j >= q->file_count) break;
+        ImportSlot *slot = &q->slots[j % IMPORT_QUEUE_DEPTH];
+
+        // Espera o gravador liberar a posição (no máximo QUEUE_DEPTH arquivos à frente)
+        pthread_mutex_lock(&q->lock);
+        while (j >= q->consumed + IMPORT_QUEUE_DEPTH) pthread_cond_wait(&q->cond, &q->lock);
+        pthread_mutex_unlock(&q->lock);
+
+        read_slot(q, j, slot);
+
+        pthread_mutex_lock(&q->lock);
+        slot->seq = j;
+        slot->ready = 1;
+        pthread_cond_broadcast(&q->cond);
+        pthread_mutex_unlock(&q->lock);
+    }
+    return NULL;
+}
+
+// Recebe os arquivos em ordem e grava os blocos com dados; os zerados viram buracos
+static void import_writer(ImportQueue *q, BlockPool *pool, WriteBatch *batch, ImportReport *report) {
+    uint32_t bs = q->block_size;
+    for (uint32_t j = 0; j < q->file_count; j++) {
+        ImportSlot *slot = &q->slots[j % IMPORT_QUEUE_DEPTH];
+        if (q->readers == 0) {
+            read_slot(q, j, slot);
+        } else {
+            pthread_mutex_lock(&q->lock);
+            while (!slot->ready || slot->seq != j) pthread_cond_wait(&q->cond, &q->lock);
+            pthread_mutex_unlock(&q->lock);
+        }
+
+        ImportNode *node = &q->nodes[q->files[j]];
+        if (slot->error) {
+            printf("[AVISO] Falha ao ler %s; arquivo importado vazio\n", node->host_path);
+            slot->len = 0;
+        }
+        node->inode.size = slot->len;
+
+        uint32_t blocks = (slot->len + bs - 1) / bs;
+        for (uint32_t k = 0; k < blocks; k++) {
+            uint32_t bytes = (k == blocks - 1) ? slot->len - k * bs : bs;
+            const uint8_t *data = slot->data + (size_t)k * bs;
+            if (block_is_zero(data, bytes)) {
+                report->holes++;
+                continue;
+            }
+            uint32_t b = pool_next(pool);
+            node->inode.blocks[k] = b;
+            batch_add(batch, b, data);
+            report->blocks++;
+        }
+        report->bytes += slot->len;
+        report->files++;
+
+        pthread_mutex_lock(&q->lock);
+        slot->ready = 0;
+        q->consumed++;
+        pthread_cond_broadcast(&q->cond);
+        pthread_mutex_unlock(&q->lock);
+    }
+}
+
+/* ====================== */
+/* Importação             */
+/* ====================== */
+
+// Monta os blocos de cada diretório importado (".", ".." e os filhos)
+static void import_dirs(Disk *disk, ImportNode *nodes, uint32_t count, uint32_t dir_inode_num,
+                        BlockPool *pool, WriteBatch *batch, ImportReport *report) {
+    uint32_t per_block = disk->block_size / DIR_ENTRY_SIZE;
+    DirEntry *entries = malloc(MAX_BLOCKS_PER_INODE * disk->block_size);
+
+    for (uint32_t i = 0; i < count; i++) {
+        ImportNode *node = &nodes[i];
+        if (!node->is_dir) continue;
+
+        uint32_t num_entries = 2 + node->child_count;
+        uint32_t blocks = (num_entries + per_block - 1) / per_block;
+        memset(entries, 0, blocks * disk->block_size);
+        entries[0].inode_num = node->inode_num;
+        strcpy(entries[0].name, ".");
+        entries[1].inode_num = (node->parent == IMPORT_TOP) ? dir_inode_num : nodes[node->parent].inode_num;
+        strcpy(entries[1].name, "..");
+        for (uint32_t c = 0; c < node->child_count; c++) {
+            ImportNode *child = &nodes[node->first_child + c];
+            entries[2 + c].inode_num = child->inode_num;
+            memcpy(entries[2 + c].name, child->name, MAX_NAME_LEN);
+        }
+
+        node->inode.size = num_entries * DIR_ENTRY_SIZE;
+        for (uint32_t b = 0; b < blocks; b++) {
+            node->inode.blocks[b] = pool_next(pool);
+            batch_add(batch, node->inode.blocks[b], (uint8_t *)&entries[b * per_block]);
+            report->blocks++;
+        }
+        report->dirs++;
+    }
+    free(entries);
+}
+
+// Preenche o pai e o uso acumulado de cada diretório importado. Como a lista
+// está em largura, percorrê-la de trás para frente soma os filhos antes dos pais
+static void import_usage(ImportNode *nodes, uint32_t count, uint32_t dir_inode_num) {
+    for (uint32_t i = 0; i < count; i++) {
+        Inode *inode = &nodes[i].inode;
+        if (!nodes[i].is_dir) continue;
+        inode->parent = (nodes[i].parent == IMPORT_TOP) ? dir_inode_num : nodes[nodes[i].parent].inode_num;
+        inode->tree_bytes = inode->size;
+        inode->tree_blocks = 0;
+        for (uint32_t b = 0; b < MAX_BLOCKS_PER_INODE; b++) {
+            if (inode->blocks[b] != 0) inode->tree_blocks++;
+        }
+    }
+    for (uint32_t i = count; i-- > 0;) {
+        if (nodes[i].parent == IMPORT_TOP) continue;
+        DirUsage usage;
+        dir_usage_of(&nodes[i].inode, &usage);
+        Inode *parent = &nodes[nodes[i].parent].inode;
+        parent->tree_bytes += usage.bytes;
+        parent->tree_blocks += usage.blocks;
+        parent->tree_files += usage.files;
+    }
+}
+
+int import_tree(Disk *disk, const char *host_dir, uint32_t dir_inode_num, ImportReport *report) {
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    memset(report, 0, sizeof(ImportReport));
+
+    Inode *target = inode_load(disk, dir_inode_num);
+    if (!target || (target->mode & 040000) != 040000) {
+        printf("[ERRO] Inode %u não é um diretório\n", dir_inode_num);
+        inode_put(target);
+        return -1;
+    }
+    uint32_t max_entries = MAX_BLOCKS_PER_INODE * disk->block_size / DIR_ENTRY_SIZE;
+    uint32_t target_free = max_entries - target->size / DIR_ENTRY_SIZE;
+    inode_put(target);
+
+    // 1. Varre o host em largura e calcula o espaço total necessário
+    NodeList list = {NULL, 0, 0};
+    if (walk_dir(&list, IMPORT_TOP, host_dir, target_free, disk->block_size, report) != 0) {
+        node_list_free(&list);
+        return -1;
+    }
+    for (uint32_t i = 0; i < list.count; i++) {
+        if (list.nodes[i].is_dir) {
+            walk_dir(&list, i, list.nodes[i].host_path, max_entries - 2, disk->block_size, report);
+        }
+    }
+
+    uint32_t per_block = disk->block_size / DIR_ENTRY_SIZE;
+    uint32_t total_blocks = 0, file_count = 0;
+    for (uint32_t i = 0; i < list.count; i++) {
+        ImportNode *node = &list.nodes[i];
+        if (node->is_dir) total_blocks += (2 + node->child_count + per_block - 1) / per_block;
+        else {
+            total_blocks += (node->size + disk->block_size - 1) / disk->block_size;
+            file_count++;
+        }
+    }
+    if (list.count > disk->sb->free_inodes || total_blocks > disk->sb->free_blocks) {
+        printf("[ERRO] Espaço insuficiente: %u i-nodes e %u blocos necessários (%u e %u livres)\n",
+               list.count, total_blocks, disk->sb->free_inodes, disk->sb->free_blocks);
+        node_list_free(&list);
+        return -1;
+    }
+
+    // 2. Reserva os i-nodes e os blocos de uma vez
+    uint32_t *inode_nums = malloc((list.count ? list.count : 1) * sizeof(uint32_t));
+    BlockPool pool;
+    memset(&pool, 0, sizeof(pool));
+    if (inode_alloc_many(disk, list.count, inode_nums) != 0) {
+        printf("[ERRO] Falha ao reservar i-nodes para a importação\n");
+        free(inode_nums);
+        node_list_free(&list);
+        return -1;
+    }
+    if (pool_reserve(disk, &pool, total_blocks) != 0) {
+        printf("[ERRO] Falha ao reservar blocos para a importação\n");
+        for (uint32_t i = 0; i < list.count; i++) inode_bitmap_set(disk, inode_nums[i], 0);
+        free(inode_nums);
+        pool_release_unused(disk, &pool);
+        node_list_free(&list);
+        return -1;
+    }
+    time_t now = time(NULL);
+    uint32_t *files = malloc((file_count ? file_count : 1) * sizeof(uint32_t));
+    file_count = 0;
+    for (uint32_t i = 0; i < list.count; i++) {
+        ImportNode *node = &list.nodes[i];
+        node->inode_num = inode_nums[i];
+        node->inode.mode = node->is_dir ? 040755 : 0100644;
+        // Cada nó tem uma entrada; as do topo são contadas por dir_add_entry
+        node->inode.nlink = (node->parent == IMPORT_TOP) ? 0 : 1;
+        node->inode.created_at = now;
+        node->inode.modified_at = now;
+        if (!node->is_dir) files[file_count++] = i;
+    }
+    free(inode_nums);
+
+    WriteBatch batch = {disk, malloc((size_t)IMPORT_BATCH_BLOCKS * disk->block_size), 0, 0, 0, 0};
+
+    // 3. Diretórios primeiro (ficam juntos no início da reserva)
+    import_dirs(disk, list.nodes, list.count, dir_inode_num, &pool, &batch, report);
+
+    // 4. Arquivos: threads leem do host enquanto esta grava na imagem
+    ImportQueue *q = calloc(1, sizeof(ImportQueue));
+    q->nodes = list.nodes;
+    q->files = files;
+    q->file_count = file_count;
+    q->block_size = disk->block_size;
+    pthread_mutex_init(&q->lock, NULL);
+    pthread_cond_init(&q->cond, NULL);
+    for (int s = 0; s < IMPORT_QUEUE_DEPTH; s++) {
+        q->slots[s].data = malloc(MAX_BLOCKS_PER_INODE * disk->block_size);
+    }
+
+    pthread_t readers[IMPORT_READERS];
+    for (int t = 0; t < IMPORT_READERS && (uint32_t)t < file_count; t++) {
+        if (pthread_create(&readers[q->readers], NULL, import_reader, q) == 0) q->readers++;
+    }
+    import_writer(q, &pool, &batch, report);
+    for (int t = 0; t < q->readers; t++) pthread_join(readers[t], NULL);
+
+    batch_flush(&batch);
+    report->writes = batch.writes;
+    pool_release_unused(disk, &pool);
+
+    // 5. I-nodes em lote e, por último, as entradas no diretório de destino
+    // (que somam o uso de cada subárvore ao destino e aos seus ancestrais)
+    import_usage(list.nodes, list.count, dir_inode_num);
+    write_inodes(disk, list.nodes, list.count);
+    int result = batch.error ? -1 : 0;
+    if (batch.error) printf("[ERRO] Falha ao gravar dados na imagem\n");
+    for (uint32_t i = 0; i < list.count && list.nodes[i].parent == IMPORT_TOP; i++) {
+        if (dir_add_entry(disk, dir_inode_num, list.nodes[i].inode_num, list.nodes[i].name) != 0) {
+            result = -1;
+        }
+    }
+
+    for (int s = 0; s < IMPORT_QUEUE_DEPTH; s++) free(q->slots[s].data);
+    pthread_mutex_destroy(&q->lock);
+    pthread_cond_destroy(&q->cond);
+    free(q);
+    free(files);
+    free(batch.buffer);
+    node_list_free(&list);
+
+    report->elapsed_ms = elapsed_ms(&start);
+    return result;
+}
+
+void import_print_report(const ImportReport *report) {
+    double seconds = report->elapsed_ms / 1000.0;
+    printf("=== IMPORTAÇÃO ===\n");
+    printf("Arquivos importados: %u\n", report->files);
+    printf("Diretórios criados: %u\n", report->dirs);
+    printf("Entradas ignoradas: %u\n", report->skipped);
+    printf("Dados lidos: %.2f MB\n", report->bytes / (1024.0 * 1024.0));
+    printf("Blocos gravados: %u (%u buracos)\n", report->blocks, report->holes);
+    printf("Escritas de dados na imagem: %u\n", report->writes);
+    printf("Tempo: %.2f ms (%.0f arquivos/s, %.2f MB/s)\n", report->elapsed_ms,
+           seconds > 0 ? report->files / seconds : 0.0,
+           seconds > 0 ? report->bytes / (1024.0 * 1024.0) / seconds : 0.0);
+}
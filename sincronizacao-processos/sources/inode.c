@@ -1,6 +1,11 @@
 #include "inode.h"
 #include "superblock.h"
 #include "disk.h"
+#include "alloc.h"
+#include "diskio.h"
+#include "icache.h"
+#include "snapshot.h"
+#include "stats.h"
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
@@ -11,32 +16,151 @@ static uint32_t next_inode_num = 1;
 extern Disk *disk;
 
 Inode *inode_create(uint32_t mode) {
-    Inode *inode = malloc(sizeof(Inode));
-    memset(inode, 0, sizeof(Inode));
-    
+    Inode *inode = icache_alloc(); // Objeto do slab, já zerado
+    if (!inode) return NULL;
+
     inode->mode = mode;
     inode->created_at = time(NULL);
     inode->modified_at = inode->created_at;
     return inode;
 }
 
+// Posição do i-node dentro da tabela de i-nodes (num snapshot aberto só
+// para leitura, a da cópia congelada)
+static off_t inode_offset(Disk *disk, uint32_t inode_num) {
+    off_t offset = disk_block_offset(disk, disk->sb->inode_start) + (off_t)inode_num * INODE_SIZE;
+    return disk->snap ? snapshot_view_offset(disk, offset) : offset;
+}
+
+void inode_table_init(Disk *disk) {
+    icache_destroy(disk);
+    // Zera a tabela inteira: i-node com mode 0 é considerado livre
+    disk_zero(disk, inode_offset(disk, 0), (uint64_t)disk->sb->inode_count * INODE_SIZE);
+}
+
 void inode_save(Disk *disk, uint32_t inode_num, Inode *inode) {
-    uint32_t offset = sizeof(Superblock) + (inode_num * INODE_SIZE);
-    lseek(disk->fd, offset, SEEK_SET);
-    write(disk->fd, inode, sizeof(Inode));
+    STATS_SCOPE(STATS_INODE_SAVE);
+    // O bloco da tabela é preservado para os snapshots antes da primeira escrita
+    snapshot_cow_meta(disk, disk->sb->inode_start + (uint32_t)((uint64_t)inode_num * INODE_SIZE / disk->block_size), 1);
+    off_t offset = inode_offset(disk, inode_num);
+    stats_pwrite(disk->fd, inode, sizeof(Inode), offset);
+    icache_update(disk, inode_num, inode);
 }
 
 Inode *inode_load(Disk *disk, uint32_t inode_num) {
-    Inode *inode = malloc(sizeof(Inode));
-    uint32_t offset = sizeof(Superblock) + (inode_num * INODE_SIZE);
-    
-    lseek(disk->fd, offset, SEEK_SET);
-    read(disk->fd, inode, sizeof(Inode));
-    return inode;
+    STATS_SCOPE(STATS_INODE_LOAD);
+    // Já em memória: mesmo objeto, mais uma referência
+    Inode *inode = icache_lookup(disk, inode_num);
+    if (inode) return inode;
+
+    inode = icache_alloc();
+    if (!inode) return NULL;
+    stats_pread(disk->fd, inode, sizeof(Inode), inode_offset(disk, inode_num));
+    return icache_insert(disk, inode_num, inode);
+}
+
+void inode_put(Inode *inode) {
+    icache_put(inode);
 }
 
-uint32_t inode_alloc() {
-    return next_inode_num++;
+int inode_load_many(Disk *disk, const uint32_t *inode_nums, uint32_t count, Inode *out) {
+    STATS_SCOPE(STATS_INODE_LOAD_MANY);
+    DiskIoReq *reqs = malloc((count ? count : 1) * sizeof(DiskIoReq));
+    for (uint32_t i = 0; i < count; i++) {
+        // I-nodes já em memória não vão ao disco
+        Inode *cached = icache_lookup(disk, inode_nums[i]);
+        if (cached) {
+            out[i] = *cached;
+            icache_put(cached);
+            reqs[i] = (DiskIoReq){DISK_IO_READ, &out[i], sizeof(Inode), 0, sizeof(Inode), 0};
+            continue;
+        }
+        reqs[i] = (DiskIoReq){DISK_IO_READ, &out[i], sizeof(Inode), inode_offset(disk, inode_nums[i]), 0, 0};
+        disk_io_submit(disk, &reqs[i]);
+    }
+    int failed = disk_io_wait(disk);
+    // Sem motor os pedidos já rodaram em disk_io_submit
+    for (uint32_t i = 0; i < count; i++) {
+        if (reqs[i].result != (ssize_t)sizeof(Inode)) memset(&out[i], 0, sizeof(Inode));
+    }
+    free(reqs);
+    return failed ? -1 : 0;
+}
+
+uint32_t inode_alloc(Disk *disk) {
+    STATS_SCOPE(STATS_INODE_ALLOC);
+    Superblock *sb = disk->sb;
+    // Tabela cheia: falha imediatamente
+    if (sb->free_inodes == 0) return (uint32_t)-1;
+
+    // Lê o bitmap de i-nodes um bloco por vez, a partir do bloco do último
+    // alocado: o custo não cresce com o tamanho da tabela
+    uint32_t bits_per_chunk = disk->block_size * 8;
+    uint32_t chunks = (sb->inode_count + bits_per_chunk - 1) / bits_per_chunk;
+    uint32_t first_chunk = (next_inode_num % sb->inode_count) / bits_per_chunk;
+    uint8_t *bitmap = malloc(disk->block_size);
+
+    uint32_t found = (uint32_t)-1;
+    for (uint32_t c = 0; c <= chunks && found == (uint32_t)-1; c++) {
+        uint32_t chunk = (first_chunk + c) % chunks;
+        uint32_t base = chunk * bits_per_chunk;
+        uint32_t bits = sb->inode_count - base < bits_per_chunk ? sb->inode_count - base : bits_per_chunk;
+        // Na primeira passada começa no cursor; na volta completa, no início do bloco
+        uint32_t from = (c == 0) ? next_inode_num % sb->inode_count - base : 0;
+
+        stats_pread(disk->fd, bitmap, (bits + 7) / 8, disk_block_offset(disk, sb->inode_bitmap_start + chunk));
+        for (uint32_t i = from; i < bits; i++) {
+            if (bitmap[i / 8] == 0xFF) {
+                i |= 7; // Byte cheio: pula os 8 i-nodes
+                continue;
+            }
+            if (!(bitmap[i / 8] & (1 << (i % 8)))) {
+                found = base + i;
+                break;
+            }
+        }
+    }
+    free(bitmap);
+
+    if (found == (uint32_t)-1) return found;
+    inode_bitmap_set(disk, found, 1);
+    next_inode_num = found + 1;
+    return found;
+}
+
+int inode_alloc_many(Disk *disk, uint32_t count, uint32_t *inode_nums) {
+    STATS_SCOPE(STATS_INODE_ALLOC_MANY);
+    Superblock *sb = disk->sb;
+    if (count == 0) return 0;
+    if (sb->free_inodes < count) return -1;
+
+    uint32_t bitmap_size = (sb->inode_count + 7) / 8;
+    uint8_t *bitmap = malloc(bitmap_size);
+    stats_pread(disk->fd, bitmap, bitmap_size, disk_block_offset(disk, sb->inode_bitmap_start));
+
+    // Marca em memória a partir do último alocado, guardando a faixa de bytes alterada
+    uint32_t found = 0, first_byte = bitmap_size, last_byte = 0;
+    for (uint32_t n = 0; n < sb->inode_count && found < count; n++) {
+        uint32_t i = (next_inode_num + n) % sb->inode_count;
+        if (bitmap[i / 8] & (1 << (i % 8))) continue;
+        bitmap[i / 8] |= 1 << (i % 8);
+        inode_nums[found++] = i;
+        if (i / 8 < first_byte) first_byte = i / 8;
+        if (i / 8 > last_byte) last_byte = i / 8;
+    }
+    if (found < count) {
+        free(bitmap);
+        return -1;
+    }
+
+    stats_pwrite(disk->fd, &bitmap[first_byte], last_byte - first_byte + 1,
+                 disk_block_offset(disk, sb->inode_bitmap_start) + first_byte);
+    free(bitmap);
+
+    sb->free_inodes -= count;
+    superblock_mark_dirty(disk);
+    next_inode_num = inode_nums[count - 1] + 1;
+    return 0;
 }
 
 void inode_reset_counter() {
@@ -44,6 +168,130 @@ void inode_reset_counter() {
 }
 
 void inode_free(Disk *disk, uint32_t inode_num) {
-    bitmap_set(disk, inode_num, 0);
+    STATS_SCOPE(STATS_INODE_FREE);
+    // Zera o i-node na tabela (mode 0 = livre); os blocos de dados são
+    // liberados pelo chamador
+    Inode empty;
+    memset(&empty, 0, sizeof(Inode));
+    inode_save(disk, inode_num, &empty);
+    inode_bitmap_set(disk, inode_num, 0);
     printf("[INFO] inode %u liberado\n", inode_num);
-}
\ No newline at end of file
+}
+
+int inode_alloc_blocks(Disk *disk, Inode *inode, uint32_t first_index, uint32_t count) {
+    STATS_SCOPE(STATS_INODE_ALLOC_BLOCKS);
+    uint32_t index = first_index;
+    while (index < first_index + count) {
+        // Pede o restante inteiro, continuando logo após o último bloco
+        // alocado (pulando buracos)
+        uint32_t goal = 0;
+        for (uint32_t j = index; j > 0; j--) {
+            if (inode->blocks[j - 1] != 0) {
+                goal = inode->blocks[j - 1] + 1;
+                break;
+            }
+        }
+        uint32_t got;
+        uint32_t start = alloc_extent(disk, 1, goal, first_index + count - index, &got);
+        if (start == (uint32_t)-1) {
+            for (uint32_t i = first_index; i < index; i++) {
+                bitmap_set(disk, inode->blocks[i], 0);
+                inode->blocks[i] = 0;
+            }
+            return -1;
+        }
+        for (uint32_t i = 0; i < got; i++) inode->blocks[index++] = start + i;
+    }
+    return 0;
+}
+
+int inode_write_blocks(Disk *disk, Inode *inode, uint32_t first_index, uint32_t count, const uint8_t *data, uint32_t len) {
+    STATS_SCOPE(STATS_INODE_WRITE_BLOCKS);
+    DiskIoReq *reqs = malloc((count ? count : 1) * sizeof(DiskIoReq));
+    uint32_t num_reqs = 0;
+    uint32_t i = first_index;
+    // Blocos retidos por snapshots são trocados por blocos novos (o chamador
+    // grava o i-node); só os gravados em parte precisam do conteúdo antigo
+    for (uint32_t b = first_index; b < first_index + count && (uint64_t)(b - first_index) * disk->block_size < len; b++) {
+        int partial = len - (b - first_index) * disk->block_size < disk->block_size;
+        if (snapshot_cow_block(disk, inode, b, partial) < 0) {
+            free(reqs);
+            return -1;
+        }
+    }
+    while (i < first_index + count && len > 0) {
+        // Buraco: nada é gravado, só avança nos dados
+        if (inode->blocks[i] == 0) {
+            uint32_t skip = len < disk->block_size ? len : disk->block_size;
+            data += skip;
+            len -= skip;
+            i++;
+            continue;
+        }
+
+        // Blocos consecutivos no disco são gravados com uma única escrita
+        uint32_t run = 1;
+        while (i + run < first_index + count && inode->blocks[i + run] == inode->blocks[i] + run) run++;
+        uint32_t bytes = run * disk->block_size;
+        if (bytes > len) bytes = len;
+
+        reqs[num_reqs] = (DiskIoReq){DISK_IO_WRITE, (void *)data, bytes, disk_block_offset(disk, inode->blocks[i]), 0, 0};
+        disk_io_submit(disk, &reqs[num_reqs++]);
+        data += bytes;
+        len -= bytes;
+        i += run;
+    }
+    // Todos os trechos vão em um lote
+    disk_io_wait(disk);
+    int result = 0;
+    for (uint32_t r = 0; r < num_reqs; r++) {
+        if (reqs[r].result != (ssize_t)reqs[r].len) result = -1;
+    }
+    free(reqs);
+    return result;
+}
+
+static int block_is_zero(const uint8_t *p, uint32_t len) {
+    return len == 0 || (p[0] == 0 && memcmp(p, p + 1, len - 1) == 0);
+}
+
+static void release_blocks(Disk *disk, Inode *inode, uint32_t count) {
+    for (uint32_t i = 0; i < count; i++) {
+        if (inode->blocks[i] == 0) continue;
+        bitmap_set(disk, inode->blocks[i], 0);
+        inode->blocks[i] = 0;
+    }
+}
+
+int inode_write_sparse(Disk *disk, Inode *inode, const uint8_t *data, uint32_t len) {
+    STATS_SCOPE(STATS_INODE_WRITE_SPARSE);
+    uint32_t count = (len + disk->block_size - 1) / disk->block_size;
+    uint32_t i = 0;
+
+    // Reserva só os trechos de blocos com algum byte diferente de zero
+    while (i < count) {
+        uint32_t bytes = (i == count - 1) ? len - i * disk->block_size : disk->block_size;
+        if (block_is_zero(data + (size_t)i * disk->block_size, bytes)) {
+            inode->blocks[i++] = 0;
+            continue;
+        }
+        uint32_t run = 1;
+        while (i + run < count) {
+            uint32_t next = i + run;
+            bytes = (next == count - 1) ? len - next * disk->block_size : disk->block_size;
+            if (block_is_zero(data + (size_t)next * disk->block_size, bytes)) break;
+            run++;
+        }
+        if (inode_alloc_blocks(disk, inode, i, run) != 0) {
+            release_blocks(disk, inode, i);
+            return -1;
+        }
+        i += run;
+    }
+
+    if (inode_write_blocks(disk, inode, 0, count, data, len) != 0) {
+        release_blocks(disk, inode, count);
+        return -1;
+    }
+    return 0;
+}
@@ -8,6 +8,10 @@
 #include "inode.h"
 #include "bitmap.h"
 #include "dir.h"
+#include "alloc.h"
+#include "stats.h"
+#include "trace.h"
+#include "command.h"
 void print_header(const char *title) {
     printf("\n====================================\n");
     printf("  %s\n", title);
@@ -27,6 +31,9 @@ void print_menu() {
     printf("8 - Mover arquivo \n");
     printf("9 - Apagar arquivo\n");
     printf("10 - Listar conteúdo de um arquivo\n"); //ok
+    printf("11 - Iniciar/parar gravação de trace\n");
+    printf("12 - Reproduzir trace\n");
+    printf("13 - Digitar comandos (sintaxe do modo script)\n");
     printf("0 - Sair\n");
     printf("------------------------------------\n");
     printf("Escolha a opção: ");
@@ -56,6 +63,7 @@ int modointerativo() {
     
     Superblock sb;
     superblock_init(disk, &sb);
+    alloc_attach(disk, ALLOC_FIRST_FIT);
     inode_reset_counter();
 
     // Reserva blocos do superbloco e bitmap
@@ -65,7 +73,7 @@ int modointerativo() {
     /* ====================== */
     /* 2. CRIAÇÃO DO ROOT */
     /* ====================== */
-    uint32_t root_inode_num = inode_alloc();
+    uint32_t root_inode_num = inode_alloc(disk);
     if (root_inode_num != 0) {
         printf("[ERRO] Root precisa ser o inode 0!\n");
         return 1;
@@ -81,12 +89,14 @@ int modointerativo() {
     uint32_t root_block = bitmap_find_free_block(disk);
     if (root_block == (uint32_t)-1) {
         printf("[ERRO] Sem blocos livres para o root!\n");
-        free(root_inode);
+        inode_put(root_inode);
         return 1;
     }
     bitmap_set(disk, root_block, 1);
     root_inode->blocks[0] = root_block;
     root_inode->size = 2 * DIR_ENTRY_SIZE;
+    root_inode->tree_bytes = root_inode->size; // parent = 0: a raiz aponta para si
+    root_inode->tree_blocks = 1;
 
     // Cria entradas "." e ".."
     DirEntry root_entries[2] = {
@@ -95,8 +105,7 @@ int modointerativo() {
     };
 
     // Escreve as entradas no bloco do root
-    lseek(disk->fd, root_block * disk->block_size, SEEK_SET);
-    write(disk->fd, root_entries, sizeof(root_entries));
+    pwrite(disk->fd, root_entries, sizeof(root_entries), disk_block_offset(disk, root_block));
 
     // Salva o inode root
     inode_save(disk, root_inode_num, root_inode);
@@ -120,6 +129,10 @@ int modointerativo() {
 
 
 
+    // Sessão da opção 13: mantém o diretório atual e a configuração de workload
+    CmdSession sessao;
+    command_session_init(&sessao, disk, CMD_OUTPUT_QUIET);
+
     int opcao;
     while (1) {
         print_menu();
@@ -157,7 +170,7 @@ int modointerativo() {
                     printf("Modificado em: %s", ctime(&inode->modified_at));
                     // Pode adicionar outras infos relevantes
                 }
-                free(inode);
+                inode_put(inode);
                 break;
             }
 
@@ -178,7 +191,10 @@ int modointerativo() {
                 fgets(caminho_arquivo_real, sizeof(caminho_arquivo_real), stdin);
                 caminho_arquivo_real[strcspn(caminho_arquivo_real, "\n")] = 0;
 
-                if (file_create(disk, dir_inode, caminho_arquivo_real, nome_arquivo) == 0) {
+                uint64_t t = trace_begin();
+                int ok = file_create(disk, dir_inode, caminho_arquivo_real, nome_arquivo) == 0;
+                trace_end_create(disk, t, TRACE_CREATE, dir_inode, 0, nome_arquivo, ok);
+                if (ok) {
                     printf("Arquivo '%s' criado com sucesso no inode %u.\n", nome_arquivo,dir_inode);
                 } else {
                     printf("Falha ao criar arquivo '%s' \n", nome_arquivo);
@@ -203,7 +219,10 @@ int modointerativo() {
                 getchar();
 
                 print_header("CONTEÚDO DO DIRETÓRIO ESCOLHIDO");
-                if (dir_list(disk, chosen_inode) != 0) {
+                uint64_t t = trace_begin();
+                int ok = dir_list(disk, chosen_inode) == 0;
+                trace_end(t, TRACE_LIST, chosen_inode, 0, 0, NULL, 0, ok);
+                if (!ok) {
                     printf("[ERRO] Falha ao listar conteúdo do diretório %u\n", chosen_inode);
                 }
                 break;
@@ -216,7 +235,10 @@ int modointerativo() {
                 printf("Digite o nome do novo diretório: ");
                 fgets(nome, sizeof(nome), stdin);
                 nome[strcspn(nome, "\n")] = 0;
-                if (dir_create(disk, destino, nome) == 0)
+                uint64_t t = trace_begin();
+                int ok = dir_create(disk, destino, nome) == 0;
+                trace_end_create(disk, t, TRACE_MKDIR, destino, 0, nome, ok);
+                if (ok)
                     printf("Diretório '%s' criado com sucesso no inode %u!\n", nome, destino);
                 else
                     printf("[ERRO] Falha ao criar o diretório '%s'\n", nome);
@@ -254,10 +276,10 @@ int modointerativo() {
                 }
                 if ((check_inode->mode & 040000) != 040000) {
                     printf("[ERRO] Esse inode não é um diretório e não pode ser renomeado.\n");
-                    free(check_inode);
+                    inode_put(check_inode);
                     break;
                 }
-                free(check_inode);
+                inode_put(check_inode);
 
                 // Pedir novo nome
                 char novo_nome[256];
@@ -266,7 +288,10 @@ int modointerativo() {
                 novo_nome[strcspn(novo_nome, "\n")] = 0;
 
                 // Renomear
-                if (dir_rename_entry(disk, parent_inode, inode_dir, novo_nome) == 0) {
+                uint64_t t = trace_begin();
+                int ok = dir_rename_entry(disk, parent_inode, inode_dir, novo_nome) == 0;
+                trace_end(t, TRACE_RENAME, parent_inode, inode_dir, 0, novo_nome, 0, ok);
+                if (ok) {
                     printf("Diretório renomeado com sucesso!\n");
                 } else {
                     printf("[ERRO] Falha ao renomear diretório.\n");
@@ -309,7 +334,9 @@ int modointerativo() {
                             }
 
                             // Remove entrada no diretório pai
+                            uint64_t t = trace_begin();
                             if (dir_remove_entry(disk, pai, current_inode) != 0) {
+                                trace_end(t, TRACE_RMDIR, pai, current_inode, 0, NULL, 0, 0);
                                 printf("[ERRO] Falha ao remover entrada no diretório pai.\n");
                                 break;
                             }
@@ -325,10 +352,11 @@ int modointerativo() {
                                     bitmap_set(disk, inode_apagar->blocks[i], 0);
                                 }
                             }
-                            free(inode_apagar);
+                            inode_put(inode_apagar);
 
                             // Libera o inode
                             inode_free(disk, current_inode);
+                            trace_end(t, TRACE_RMDIR, pai, current_inode, 0, NULL, 0, 1);
 
 
                             printf("Diretório apagado com sucesso.\n");
@@ -352,10 +380,10 @@ int modointerativo() {
                     Inode *inode_verif = inode_load(disk, proximo_inode);
                     if (!inode_verif || (inode_verif->mode & 040000) != 040000) {
                         printf("[ERRO] Inode %u não é um diretório válido.\n", proximo_inode);
-                        if (inode_verif) free(inode_verif);
+                        if (inode_verif) inode_put(inode_verif);
                         continue;
                     }
-                    free(inode_verif);
+                    inode_put(inode_verif);
 
                     parent_inode = current_inode;
                     current_inode = proximo_inode;
@@ -385,17 +413,20 @@ int modointerativo() {
 
                 if ((inode->mode & 0100000) != 0100000) {
                     printf("[ERRO] O inode %u não é um arquivo. Apenas arquivos podem ser renomeados aqui.\n", alvo_inode);
-                    free(inode);
+                    inode_put(inode);
                     break;
                 }
-                free(inode);
+                inode_put(inode);
 
                 printf("Digite o novo nome: ");
                 char novo_nome[MAX_NAME_LEN];
                 fgets(novo_nome, sizeof(novo_nome), stdin);
                 novo_nome[strcspn(novo_nome, "\n")] = '\0';  // remove newline
 
-                if (dir_rename_entry(disk, dir_inode, alvo_inode, novo_nome) == 0) {
+                uint64_t t = trace_begin();
+                int ok = dir_rename_entry(disk, dir_inode, alvo_inode, novo_nome) == 0;
+                trace_end(t, TRACE_RENAME, dir_inode, alvo_inode, 0, novo_nome, 0, ok);
+                if (ok) {
                     printf("[INFO] Arquivo renomeado com sucesso.\n");
                 } else {
                     printf("[ERRO] Falha ao renomear o arquivo.\n");
@@ -409,35 +440,18 @@ int modointerativo() {
                 uint32_t origem_inode = navegar_diretorios(disk, 0);
 
                 // Listar arquivos no diretório de origem
-                Inode *origem_dir = inode_load(disk, origem_inode);
-                if (!origem_dir) break;
+                DirIter it;
+                if (dir_iter_open(disk, origem_inode, DIR_ITER_PLUS, &it) != 0) break;
 
                 printf("\nArquivos disponíveis no diretório [%u]:\n", origem_inode);
-                uint32_t num_entries = origem_dir->size / DIR_ENTRY_SIZE;
-
-                for (uint32_t i = 0; i < num_entries; i++) {
-                    uint32_t block_idx = (i * DIR_ENTRY_SIZE) / disk->block_size;
-                    uint32_t offset = (i * DIR_ENTRY_SIZE) % disk->block_size;
-
-                    if (block_idx >= 10 || origem_dir->blocks[block_idx] == 0)
-                        continue;
-
-                    DirEntry entry;
-                    lseek(disk->fd, origem_dir->blocks[block_idx] * disk->block_size + offset, SEEK_SET);
-                    if (read(disk->fd, &entry, sizeof(DirEntry)) != sizeof(DirEntry))
-                        continue;
-
-                    Inode *entry_inode = inode_load(disk, entry.inode_num);
-                    if (!entry_inode) continue;
-
+                DirEntry *entry;
+                Inode *entry_inode;
+                while ((entry = dir_iter_next(&it, &entry_inode))) {
                     if ((entry_inode->mode & 0100000) == 0100000) {
-                        printf("  [%u] %s\n", entry.inode_num, entry.name);
+                        printf("  [%u] %s\n", entry->inode_num, entry->name);
                     }
-
-                    free(entry_inode);
                 }
-
-                free(origem_dir);
+                dir_iter_close(&it);
 
                 printf("Digite o inode do arquivo a mover: ");
                 uint32_t inode_arquivo;
@@ -450,44 +464,31 @@ int modointerativo() {
                 Inode *inode = inode_load(disk, inode_arquivo);
                 if (!inode || (inode->mode & 0100000) != 0100000) {
                     printf("[ERRO] O inode %u não é um arquivo.\n", inode_arquivo);
-                    if (inode) free(inode);
+                    if (inode) inode_put(inode);
                     break;
                 }
-                free(inode);
+                inode_put(inode);
 
                 // Obter o nome do arquivo
                 char nome_arquivo[MAX_NAME_LEN] = {0};
-                origem_dir = inode_load(disk, origem_inode);
-                for (uint32_t i = 0; i < num_entries; i++) {
-                    uint32_t block_idx = (i * DIR_ENTRY_SIZE) / disk->block_size;
-                    uint32_t offset = (i * DIR_ENTRY_SIZE) % disk->block_size;
-
-                    if (block_idx >= 10 || origem_dir->blocks[block_idx] == 0)
-                        continue;
-
-                    DirEntry entry;
-                    lseek(disk->fd, origem_dir->blocks[block_idx] * disk->block_size + offset, SEEK_SET);
-                    read(disk->fd, &entry, sizeof(DirEntry));
-
-                    if (entry.inode_num == inode_arquivo) {
-                        strncpy(nome_arquivo, entry.name, MAX_NAME_LEN);
-                        break;
-                    }
-                }
-                free(origem_dir);
+                dir_find_entry(disk, origem_inode, inode_arquivo, nome_arquivo);
 
                 // Navegar até diretório de destino
                 printf("Agora selecione o diretório destino:\n");
                 uint32_t destino_inode = navegar_diretorios(disk, 0);
 
                 // Remover do diretório de origem
+                uint64_t t = trace_begin();
                 if (dir_remove_entry(disk, origem_inode, inode_arquivo) != 0) {
+                    trace_end(t, TRACE_MOVE, origem_inode, inode_arquivo, destino_inode, NULL, 0, 0);
                     printf("[ERRO] Falha ao remover do diretório de origem.\n");
                     break;
                 }
 
                 // Adicionar no diretório de destino
-                if (dir_add_entry(disk, destino_inode, inode_arquivo, nome_arquivo) != 0) {
+                int ok = dir_add_entry(disk, destino_inode, inode_arquivo, nome_arquivo) == 0;
+                trace_end(t, TRACE_MOVE, origem_inode, inode_arquivo, destino_inode, NULL, 0, ok);
+                if (!ok) {
                     printf("[ERRO] Falha ao adicionar no diretório destino.\n");
                     break;
                 }
@@ -512,12 +513,15 @@ int modointerativo() {
                 Inode *inode = inode_load(disk, file_inode);
                 if (!inode || (inode->mode & 0100000) != 0100000) {
                     printf("[ERRO] O inode %u não é um arquivo válido.\n", file_inode);
-                    if (inode) free(inode);
+                    if (inode) inode_put(inode);
                     break;
                 }
-                free(inode);
+                inode_put(inode);
 
-                if (file_delete(disk, parent_inode, file_inode) == 0) {
+                uint64_t t = trace_begin();
+                int ok = file_delete(disk, parent_inode, file_inode) == 0;
+                trace_end(t, TRACE_DELETE, parent_inode, file_inode, 0, NULL, 0, ok);
+                if (ok) {
                     printf("[OK] Arquivo apagado com sucesso.\n");
                 } else {
                     printf("[ERRO] Falha ao apagar arquivo.\n");
@@ -541,15 +545,73 @@ int modointerativo() {
                 getchar();
 
                 printf("\n[EXECUTANDO] Lendo conteúdo do arquivo (inode %u):\n", file_inode);
-                if (file_read(disk, file_inode) != 0) {
+                uint64_t t = trace_begin();
+                int ok = file_read(disk, file_inode) == 0;
+                trace_end(t, TRACE_READ, 0, file_inode, 0, NULL, 0, ok);
+                if (!ok) {
                     printf("[ERRO] Falha ao ler o arquivo de inode %u.\n", file_inode);
                 }
                 break;
             }
 
+            case 11: {
+                print_header("GRAVAÇÃO DE TRACE");
+                if (trace_active()) {
+                    trace_stop();
+                    printf("[INFO] Gravação do trace encerrada.\n");
+                    break;
+                }
+                if (trace_start(TRACE_DEFAULT_FILE, disk->block_size) != 0) {
+                    printf("[ERRO] Não foi possível criar o trace %s.\n", TRACE_DEFAULT_FILE);
+                    break;
+                }
+                printf("[INFO] Gravando as operações em %s (escolha 11 de novo para parar).\n", TRACE_DEFAULT_FILE);
+                break;
+            }
+
+            case 12: {
+                print_header("REPRODUZIR TRACE");
+                char caminho[512];
+                printf("Digite o caminho do trace: ");
+                fgets(caminho, sizeof(caminho), stdin);
+                caminho[strcspn(caminho, "\n")] = 0;
+
+                printf("Selecione o diretório que fará o papel do root gravado:\n");
+                uint32_t destino = navegar_diretorios(disk, 0);
+
+                char resposta[10];
+                printf("Respeitar os intervalos gravados? (s/n): ");
+                fgets(resposta, sizeof(resposta), stdin);
+
+                TraceReport report;
+                if (trace_replay(disk, caminho, destino, resposta[0] == 's' || resposta[0] == 'S', &report) != 0 &&
+                    report.records == 0) {
+                    break;
+                }
+                trace_print_report(&report);
+                break;
+            }
+
+            case 13: {
+                print_header("COMANDOS");
+                printf("Digite \"help\" para ver os comandos e uma linha vazia para voltar ao menu.\n");
+                char linha[CMD_MAX_LINE];
+                while (1) {
+                    printf("[%u]> ", sessao.cwd);
+                    fflush(stdout);
+                    if (!fgets(linha, sizeof(linha), stdin) || linha[0] == '\n') break;
+                    command_exec_line(&sessao, linha);
+                }
+                break;
+            }
+
             case 0:
                 printf("\n[INFO] Sistema finalizado com sucesso.\n");
-                free(root_inode);
+                command_session_end(&sessao);
+                if (stats_write_json(disk, STATS_JSON_FILE) == 0) {
+                    printf("[INFO] Estatísticas gravadas em %s\n", STATS_JSON_FILE);
+                }
+                inode_put(root_inode);
                 disk_free(disk);
                 return 0;
 
@@ -10,8 +10,11 @@
 #include "dir.h"
 #include "interativo.h"
 #include "script.h"
+#include "cli.h"
 
-int main() {
+int main(int argc, char **argv) {
+    // Com argumentos: linha de comando não interativa (mkfs, mount, run, fsck, bench)
+    if (argc > 1) return cli_main(argc, argv);
 
     int opcao;
     printf("1- Modo Interativo  2- Modo Script\n");
@@ -0,0 +1,100 @@
+#include "rpc.h"
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+static const char *op_names[RPC_OP_COUNT] = {
+    [RPC_LOOKUP] = "lookup",
+    [RPC_CREATE] = "create",
+    [RPC_READ] = "read",
+    [RPC_WRITE] = "write",
+    [RPC_READDIR] = "readdir",
+    [RPC_STAT] = "stat",
+};
+
+static const char *status_names[RPC_STATUS_COUNT] = {
+    [RPC_OK] = "ok",
+    [RPC_ENOENT] = "não encontrado",
+    [RPC_EEXIST] = "já existe",
+    [RPC_ENOTDIR] = "não é diretório",
+    [RPC_EISDIR] = "é diretório",
+    [RPC_EINVAL] = "argumento inválido",
+    [RPC_ENOSPC] = "sem espaço",
+    [RPC_EIO] = "erro de E/S",
+    [RPC_EBADOP] = "operação desconhecida",
+};
+
+const char *rpc_op_name(RpcOp op) {
+    return (op > 0 && op < RPC_OP_COUNT) ? op_names[op] : "?";
+}
+
+const char *rpc_status_name(RpcStatus status) {
+    return (status < RPC_STATUS_COUNT) ? status_names[status] : "?";
+}
+
+int rpc_connect(const char *path) {
+    struct sockaddr_un addr;
+    if (strlen(path) >= sizeof(addr.sun_path)) return -1;
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path);
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static int write_all(int fd, const void *buf, size_t len) {
+    const uint8_t *p = buf;
+    while (len > 0) {
+        ssize_t n = write(fd, p, len);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return -1;
+        p += n;
+        len -= n;
+    }
+    return 0;
+}
+
+static int read_all(int fd, void *buf, size_t len) {
+    uint8_t *p = buf;
+    while (len > 0) {
+        ssize_t n = read(fd, p, len);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return -1;
+        p += n;
+        len -= n;
+    }
+    return 0;
+}
+
+int rpc_send(int fd, const RpcRequest *req, const void *payload) {
+    if (req->len > RPC_MAX_PAYLOAD) return -1;
+    if (write_all(fd, req, sizeof(RpcRequest)) != 0) return -1;
+    return req->len ? write_all(fd, payload, req->len) : 0;
+}
+
+int rpc_recv(int fd, RpcResponse *resp, void *payload, uint32_t cap) {
+    if (read_all(fd, resp, sizeof(RpcResponse)) != 0) return -1;
+    uint32_t keep = resp->len < cap ? resp->len : cap;
+    if (keep && read_all(fd, payload, keep) != 0) return -1;
+    // Descarta o que não coube
+    uint8_t skip[512];
+    for (uint32_t left = resp->len - keep; left > 0;) {
+        uint32_t n = left < sizeof(skip) ? left : sizeof(skip);
+        if (read_all(fd, skip, n) != 0) return -1;
+        left -= n;
+    }
+    return 0;
+}
+
+int rpc_call(int fd, const RpcRequest *req, const void *payload, RpcResponse *resp, void *out, uint32_t cap) {
+    if (rpc_send(fd, req, payload) != 0) return -1;
+    return rpc_recv(fd, resp, out, cap);
+}
@@ -0,0 +1,414 @@
+#define _GNU_SOURCE
+#include "server.h"
+#include "inode.h"
+#include "dir.h"
+#include "superblock.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#define SERVER_IN_SIZE (sizeof(RpcRequest) + RPC_MAX_PAYLOAD)
+
+// Estado de um cliente conectado
+typedef struct ServerConn {
+    int fd;
+    uint8_t *in;            // Pedidos recebidos e ainda não tratados
+    uint32_t in_len;
+    uint8_t *out;           // Respostas ainda não enviadas
+    uint32_t out_len;
+    uint32_t out_sent;
+    uint32_t out_cap;
+    int closing;            // O cliente fechou a escrita: termina de responder e fecha
+    uint32_t events;        // Eventos registrados no epoll
+    struct ServerConn *prev, *next;   // Conexões abertas, fechadas ao encerrar
+} ServerConn;
+
+static volatile sig_atomic_t server_stop = 0;
+static ServerConn *conns = NULL;
+
+static void on_signal(int sig) {
+    (void)sig;
+    server_stop = 1;
+}
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/* ====================== */
+/* Operações              */
+/* ====================== */
+
+// Reserva espaço para uma resposta com len bytes de corpo e preenche o cabeçalho.
+// Retorna onde o corpo deve ser escrito
+static uint8_t *reply_begin(ServerConn *c, const RpcRequest *req, uint32_t len) {
+    uint32_t need = c->out_len + sizeof(RpcResponse) + len;
+    if (need > c->out_cap) {
+        uint32_t cap = c->out_cap ? c->out_cap : 4096;
+        while (cap < need) cap *= 2;
+        c->out = realloc(c->out, cap);
+        c->out_cap = cap;
+    }
+    RpcResponse *resp = (RpcResponse *)(c->out + c->out_len);
+    memset(resp, 0, sizeof(RpcResponse));
+    resp->len = len;
+    resp->id = req->id;
+    resp->op = req->op;
+    c->out_len = need;
+    return (uint8_t *)(resp + 1);
+}
+
+static RpcResponse *reply_header(ServerConn *c, uint32_t len) {
+    return (RpcResponse *)(c->out + c->out_len - len - sizeof(RpcResponse));
+}
+
+static int reply_status(ServerConn *c, const RpcRequest *req, RpcStatus status, uint32_t inode) {
+    reply_begin(c, req, 0);
+    RpcResponse *resp = reply_header(c, 0);
+    resp->status = status;
+    resp->inode = inode;
+    return status;
+}
+
+// Copia o nome do corpo do pedido (sem \0). Retorna 0 ou -1 se for vazio ou longo demais
+static int request_name(const RpcRequest *req, const uint8_t *payload, char name[MAX_NAME_LEN]) {
+    if (req->len == 0 || req->len >= MAX_NAME_LEN || memchr(payload, '\0', req->len)) return -1;
+    memcpy(name, payload, req->len);
+    name[req->len] = '\0';
+    return 0;
+}
+
+// Tipo do i-node: 1 diretório, 0 arquivo, -1 inexistente
+static int inode_kind(Disk *disk, uint32_t inode_num) {
+    if (inode_num >= disk->sb->inode_count) return -1;
+    Inode *inode = inode_load(disk, inode_num);
+    if (!inode) return -1;
+    int kind = inode->mode == 0 ? -1 : (inode->mode & 040000) == 040000;
+    inode_put(inode);
+    return kind;
+}
+
+static int op_lookup(Disk *disk, ServerConn *c, const RpcRequest *req, const uint8_t *payload) {
+    char name[MAX_NAME_LEN];
+    if (request_name(req, payload, name) != 0) return reply_status(c, req, RPC_EINVAL, 0);
+    int kind = inode_kind(disk, req->dir);
+    if (kind != 1) return reply_status(c, req, kind < 0 ? RPC_ENOENT : RPC_ENOTDIR, 0);
+    uint32_t found = dir_lookup(disk, req->dir, name);
+    if (found == (uint32_t)-1) return reply_status(c, req, RPC_ENOENT, 0);
+    return reply_status(c, req, RPC_OK, found);
+}
+
+static int op_create(Disk *disk, ServerConn *c, const RpcRequest *req, const uint8_t *payload) {
+    char name[MAX_NAME_LEN];
+    uint32_t name_len = req->count;     // CREATE: o corpo é nome (count bytes) + conteúdo
+    if (name_len > req->len) return reply_status(c, req, RPC_EINVAL, 0);
+    RpcRequest named = *req;
+    named.len = name_len;
+    if (request_name(&named, payload, name) != 0) return reply_status(c, req, RPC_EINVAL, 0);
+    int kind = inode_kind(disk, req->dir);
+    if (kind != 1) return reply_status(c, req, kind < 0 ? RPC_ENOENT : RPC_ENOTDIR, 0);
+    if (dir_lookup(disk, req->dir, name) != (uint32_t)-1) return reply_status(c, req, RPC_EEXIST, 0);
+
+    uint32_t created;
+    if (req->flags & RPC_CREATE_DIR) {
+        created = dir_create(disk, req->dir, name) == 0 ? dir_lookup(disk, req->dir, name) : (uint32_t)-1;
+    } else {
+        uint32_t len = req->len - name_len;
+        if (len > MAX_BLOCKS_PER_INODE * disk->block_size) return reply_status(c, req, RPC_EINVAL, 0);
+        created = file_create_data(disk, req->dir, name, payload + name_len, len);
+    }
+    if (created == (uint32_t)-1) return reply_status(c, req, RPC_ENOSPC, 0);
+    return reply_status(c, req, RPC_OK, created);
+}
+
+static int op_read(Disk *disk, ServerConn *c, const RpcRequest *req) {
+    int kind = inode_kind(disk, req->inode);
+    if (kind != 0) return reply_status(c, req, kind < 0 ? RPC_ENOENT : RPC_EISDIR, 0);
+    uint8_t *buffer = disk_buf_get(disk);
+    int size = file_read_data(disk, req->inode, buffer);
+    if (size < 0) {
+        disk_buf_put(disk, buffer);
+        return reply_status(c, req, RPC_EIO, 0);
+    }
+    uint32_t start = req->offset < (uint32_t)size ? req->offset : (uint32_t)size;
+    uint32_t len = (uint32_t)size - start;
+    if (req->count && req->count < len) len = req->count;
+    if (len > RPC_MAX_PAYLOAD) len = RPC_MAX_PAYLOAD;
+    memcpy(reply_begin(c, req, len), buffer + start, len);
+    disk_buf_put(disk, buffer);
+    reply_header(c, len)->inode = req->inode;
+    return RPC_OK;
+}
+
+static int op_write(Disk *disk, ServerConn *c, const RpcRequest *req, const uint8_t *payload) {
+    int kind = inode_kind(disk, req->inode);
+    if (kind != 0) return reply_status(c, req, kind < 0 ? RPC_ENOENT : RPC_EISDIR, 0);
+    if (inode_kind(disk, req->dir) != 1) return reply_status(c, req, RPC_ENOTDIR, 0);
+    uint32_t max = MAX_BLOCKS_PER_INODE * disk->block_size;
+    if (req->offset > max || req->len > max - req->offset) return reply_status(c, req, RPC_EINVAL, 0);
+    if (file_write_data(disk, req->dir, req->inode, req->offset, payload, req->len) != 0) {
+        return reply_status(c, req, RPC_ENOSPC, 0);
+    }
+    return reply_status(c, req, RPC_OK, req->inode);
+}
+
+static int op_readdir(Disk *disk, ServerConn *c, const RpcRequest *req) {
+    DirIter it;
+    if (dir_iter_open(disk, req->dir, 0, &it) != 0) {
+        return reply_status(c, req, inode_kind(disk, req->dir) < 0 ? RPC_ENOENT : RPC_ENOTDIR, 0);
+    }
+    // O corpo é montado direto no buffer de saída e o tamanho é ajustado no fim
+    uint8_t *body = reply_begin(c, req, RPC_MAX_PAYLOAD);
+    uint32_t used = 0, index = 0, returned = 0, next = 0;
+    DirEntry *e;
+    while ((e = dir_iter_next(&it, NULL)) != NULL) {
+        if (index++ < req->offset) continue;
+        uint32_t name_len = strlen(e->name);
+        if ((req->count && returned == req->count) || used + RPC_DIRENT_HEADER + name_len > RPC_MAX_PAYLOAD) {
+            next = index - 1;
+            break;
+        }
+        memcpy(body + used, &e->inode_num, sizeof(uint32_t));
+        body[used + 4] = (uint8_t)name_len;
+        memcpy(body + used + RPC_DIRENT_HEADER, e->name, name_len);
+        used += RPC_DIRENT_HEADER + name_len;
+        returned++;
+    }
+    dir_iter_close(&it);
+    c->out_len -= RPC_MAX_PAYLOAD - used;
+    RpcResponse *resp = reply_header(c, used);
+    resp->len = used;
+    resp->inode = next;
+    return RPC_OK;
+}
+
+static int op_stat(Disk *disk, ServerConn *c, const RpcRequest *req) {
+    if (inode_kind(disk, req->inode) < 0) return reply_status(c, req, RPC_ENOENT, 0);
+    Inode *inode = inode_load(disk, req->inode);
+    RpcStat st = {req->inode, inode->mode, inode->size, 0, inode->created_at, inode->modified_at};
+    for (uint32_t i = 0; i < MAX_BLOCKS_PER_INODE; i++) {
+        if (inode->blocks[i] != 0) st.blocks++;
+    }
+    inode_put(inode);
+    memcpy(reply_begin(c, req, sizeof(RpcStat)), &st, sizeof(RpcStat));
+    reply_header(c, sizeof(RpcStat))->inode = req->inode;
+    return RPC_OK;
+}
+
+// Executa um pedido e acrescenta a resposta à fila de saída da conexão
+static void server_dispatch(Disk *disk, ServerConn *c, const RpcRequest *req, const uint8_t *payload,
+                            ServerReport *report) {
+    int status;
+    switch (req->op) {
+        case RPC_LOOKUP: status = op_lookup(disk, c, req, payload); break;
+        case RPC_CREATE: status = op_create(disk, c, req, payload); break;
+        case RPC_READ: status = op_read(disk, c, req); break;
+        case RPC_WRITE: status = op_write(disk, c, req, payload); break;
+        case RPC_READDIR: status = op_readdir(disk, c, req); break;
+        case RPC_STAT: status = op_stat(disk, c, req); break;
+        default:
+            reply_status(c, req, RPC_EBADOP, 0);
+            return;
+    }
+    superblock_flush(disk);
+    report->requests[req->op]++;
+    if (status != RPC_OK) report->errors[req->op]++;
+}
+
+/* ====================== */
+/* Laço de eventos        */
+/* ====================== */
+
+static void conn_close(int epfd, ServerConn *c) {
+    if (c->prev) c->prev->next = c->next;
+    else conns = c->next;
+    if (c->next) c->next->prev = c->prev;
+    epoll_ctl(epfd, EPOLL_CTL_DEL, c->fd, NULL);
+    close(c->fd);
+    free(c->in);
+    free(c->out);
+    free(c);
+}
+
+static void conn_watch(int epfd, ServerConn *c, uint32_t events) {
+    if (events == c->events) return;
+    struct epoll_event ev = {.events = events, .data.ptr = c};
+    epoll_ctl(epfd, EPOLL_CTL_MOD, c->fd, &ev);
+    c->events = events;
+}
+
+// Trata os pedidos completos do buffer de entrada (vários por leitura quando o
+// cliente os envia em sequência), até a fila de saída passar de SERVER_OUT_HIGH.
+// Retorna -1 se o cabeçalho for inválido
+static int conn_process(Disk *disk, ServerConn *c, ServerReport *report) {
+    uint32_t pos = 0, handled = 0;
+    while (c->in_len - pos >= sizeof(RpcRequest) && c->out_len - c->out_sent < SERVER_OUT_HIGH) {
+        RpcRequest req;
+        memcpy(&req, c->in + pos, sizeof(RpcRequest));
+        if (req.len > RPC_MAX_PAYLOAD) return -1;
+        if (c->in_len - pos < sizeof(RpcRequest) + req.len) break;
+        server_dispatch(disk, c, &req, c->in + pos + sizeof(RpcRequest), report);
+        pos += sizeof(RpcRequest) + req.len;
+        handled++;
+    }
+    if (handled > report->max_pipeline) report->max_pipeline = handled;
+    memmove(c->in, c->in + pos, c->in_len - pos);
+    c->in_len -= pos;
+    return 0;
+}
+
+// Envia o que der da fila de saída. Retorna -1 se a conexão caiu
+static int conn_flush(ServerConn *c, ServerReport *report) {
+    while (c->out_sent < c->out_len) {
+        ssize_t n = send(c->fd, c->out + c->out_sent, c->out_len - c->out_sent, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return 0;
+        if (n <= 0) return -1;
+        c->out_sent += n;
+        report->bytes_out += n;
+    }
+    c->out_len = c->out_sent = 0;
+    return 0;
+}
+
+// Lê, trata e responde. Retorna -1 quando a conexão deve ser fechada
+static int conn_service(Disk *disk, int epfd, ServerConn *c, ServerReport *report) {
+    for (;;) {
+        // Com a fila de saída cheia o cliente espera: nada é lido até ela esvaziar
+        if (!c->closing && c->in_len < SERVER_IN_SIZE && c->out_len - c->out_sent < SERVER_OUT_HIGH) {
+            ssize_t n = read(c->fd, c->in + c->in_len, SERVER_IN_SIZE - c->in_len);
+            if (n == 0) {
+                c->closing = 1;
+            } else if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                return -1;
+            } else if (n > 0) {
+                c->in_len += n;
+                report->bytes_in += n;
+            }
+        }
+        if (conn_process(disk, c, report) != 0) {
+            report->protocol_errors++;
+            return -1;
+        }
+        if (conn_flush(c, report) != 0) return -1;
+
+        int pending = c->out_len > c->out_sent;
+        if (pending) {
+            conn_watch(epfd, c, EPOLLOUT);
+            return 0;
+        }
+        // Fila vazia: continua se ainda há pedidos completos no buffer
+        if (c->in_len >= sizeof(RpcRequest)) {
+            RpcRequest req;
+            memcpy(&req, c->in, sizeof(RpcRequest));
+            if (c->in_len >= sizeof(RpcRequest) + req.len) continue;
+        }
+        if (c->closing) return -1;
+        conn_watch(epfd, c, EPOLLIN);
+        return 0;
+    }
+}
+
+static int server_listen(const char *path) {
+    struct sockaddr_un addr;
+    if (strlen(path) >= sizeof(addr.sun_path)) return -1;
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path);
+    unlink(path);
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 || listen(fd, SOMAXCONN) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+int server_run(Disk *disk, const char *path, ServerReport *report) {
+    memset(report, 0, sizeof(ServerReport));
+    int lfd = server_listen(path);
+    if (lfd < 0) {
+        printf("[ERRO] Não foi possível escutar em %s\n", path);
+        return -1;
+    }
+    int epfd = epoll_create1(EPOLL_CLOEXEC);
+    struct epoll_event ev = {.events = EPOLLIN, .data.ptr = NULL};
+    epoll_ctl(epfd, EPOLL_CTL_ADD, lfd, &ev);
+
+    // Sem SA_RESTART: o sinal interrompe o epoll_wait
+    struct sigaction sa, old_int, old_term;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = on_signal;
+    sigaction(SIGINT, &sa, &old_int);
+    sigaction(SIGTERM, &sa, &old_term);
+    server_stop = 0;
+
+    printf("[INFO] Servidor escutando em %s (Ctrl+C para encerrar)\n", path);
+    fflush(stdout);
+    uint64_t t0 = now_ns();
+    struct epoll_event events[SERVER_MAX_EVENTS];
+    while (!server_stop) {
+        int n = epoll_wait(epfd, events, SERVER_MAX_EVENTS, -1);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        for (int i = 0; i < n; i++) {
+            ServerConn *c = events[i].data.ptr;
+            if (!c) {
+                // Novas conexões
+                int cfd;
+                while ((cfd = accept4(lfd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0) {
+                    c = calloc(1, sizeof(ServerConn));
+                    c->fd = cfd;
+                    c->in = malloc(SERVER_IN_SIZE);
+                    c->events = EPOLLIN;
+                    c->next = conns;
+                    if (conns) conns->prev = c;
+                    conns = c;
+                    struct epoll_event cev = {.events = EPOLLIN, .data.ptr = c};
+                    epoll_ctl(epfd, EPOLL_CTL_ADD, cfd, &cev);
+                    report->connections++;
+                }
+                continue;
+            }
+            if ((events[i].events & EPOLLERR) || conn_service(disk, epfd, c, report) != 0) {
+                conn_close(epfd, c);
+            }
+        }
+    }
+    report->elapsed_ms = (now_ns() - t0) / 1e6;
+    while (conns) conn_close(epfd, conns);
+
+    sigaction(SIGINT, &old_int, NULL);
+    sigaction(SIGTERM, &old_term, NULL);
+    close(epfd);
+    close(lfd);
+    unlink(path);
+    return 0;
+}
+
+void server_print_report(const ServerReport *report) {
+    printf("=== SERVIDOR ===\n");
+    printf("Operação | Pedidos | Falhas\n");
+    for (int op = 1; op < RPC_OP_COUNT; op++) {
+        if (report->requests[op] == 0) continue;
+        printf("%-8s | %7llu | %6llu\n", rpc_op_name(op), (unsigned long long)report->requests[op],
+               (unsigned long long)report->errors[op]);
+    }
+    printf("Conexões: %u (%u fechadas por erro de protocolo)\n", report->connections, report->protocol_errors);
+    printf("Bytes: %llu recebidos, %llu enviados\n", (unsigned long long)report->bytes_in,
+           (unsigned long long)report->bytes_out);
+    printf("Maior lote de pedidos em sequência: %u\n", report->max_pipeline);
+    printf("Tempo: %.2f ms\n", report->elapsed_ms);
+}
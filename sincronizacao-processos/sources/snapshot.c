@@ -0,0 +1,518 @@
+#include "snapshot.h"
+#include "superblock.h"
+#include "bitmap.h"
+#include "alloc.h"
+#include "dir.h"
+#include "stats.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+#define MAP_PENDING ((uint32_t)-1) // Cópia em andamento: a reserva do bloco não copia de novo
+
+// Os dois mapas de cada snapshot
+typedef enum {
+    MAP_ITABLE = 0,     // Tabela de i-nodes
+    MAP_BITMAP,         // Bitmap de blocos
+    MAP_KINDS
+} MapKind;
+
+struct Snapshots {
+    SnapshotRecord table[SNAPSHOT_MAX];   // Cópia da tabela do disco
+    int newest;                 // Posição do mais novo (-1 = nenhum)
+    uint32_t entries[MAP_KINDS]; // Blocos cobertos por cada mapa
+    uint32_t *map[MAP_KINDS];   // Mapas do mais novo (ou do snapshot aberto só para leitura)
+    uint8_t *held;              // União dos bitmaps congelados, um bit por bloco
+    uint8_t *held_loaded;       // Blocos do bitmap já somados em held
+    uint32_t view;              // Snapshot aberto por snapshot_open (0 = imagem viva)
+};
+
+typedef struct Snapshots Snapshots;
+
+static uint32_t map_blocks(Disk *disk, uint32_t entries) {
+    return (uint32_t)(((uint64_t)entries * sizeof(uint32_t) + disk->block_size - 1) / disk->block_size);
+}
+
+static uint32_t map_start(const SnapshotRecord *r, MapKind kind) {
+    return kind == MAP_ITABLE ? r->itable_map : r->bitmap_map;
+}
+
+static off_t map_offset(Disk *disk, const SnapshotRecord *r, MapKind kind, uint32_t k) {
+    return disk_block_offset(disk, map_start(r, kind)) + (off_t)k * sizeof(uint32_t);
+}
+
+// Lê o mapa inteiro (entries entradas)
+static uint32_t *map_read(Disk *disk, const SnapshotRecord *r, MapKind kind, uint32_t entries) {
+    uint32_t *map = calloc(entries ? entries : 1, sizeof(uint32_t));
+    size_t len = (size_t)entries * sizeof(uint32_t);
+    if (stats_pread(disk->fd, map, len, map_offset(disk, r, kind, 0)) != (ssize_t)len) {
+        memset(map, 0, len);
+    }
+    return map;
+}
+
+static uint32_t map_get(Disk *disk, const SnapshotRecord *r, MapKind kind, uint32_t k) {
+    uint32_t entry = 0;
+    stats_pread(disk->fd, &entry, sizeof(entry), map_offset(disk, r, kind, k));
+    return entry;
+}
+
+static void map_set(Disk *disk, const SnapshotRecord *r, MapKind kind, uint32_t k, uint32_t entry) {
+    stats_pwrite(disk->fd, &entry, sizeof(entry), map_offset(disk, r, kind, k));
+}
+
+static void table_write(Disk *disk, Snapshots *s) {
+    stats_pwrite(disk->fd, s->table, sizeof(s->table), disk_block_offset(disk, disk->sb->snapshot_table));
+}
+
+static int table_find(Snapshots *s, uint32_t id) {
+    for (int i = 0; i < SNAPSHOT_MAX; i++) {
+        if (id != 0 && s->table[i].id == id) return i;
+    }
+    return -1;
+}
+
+// Recarrega os mapas do snapshot mais novo e esquece a união dos bitmaps
+static void select_newest(Disk *disk, Snapshots *s) {
+    s->newest = -1;
+    for (int i = 0; i < SNAPSHOT_MAX; i++) {
+        if (s->table[i].id == 0) continue;
+        if (s->newest < 0 || s->table[i].id > s->table[s->newest].id) s->newest = i;
+    }
+    for (int kind = 0; kind < MAP_KINDS; kind++) {
+        free(s->map[kind]);
+        s->map[kind] = s->newest < 0 ? NULL : map_read(disk, &s->table[s->newest], kind, s->entries[kind]);
+    }
+    memset(s->held_loaded, 0, s->entries[MAP_BITMAP]);
+}
+
+// Estado em memória, lido do disco no primeiro uso
+static Snapshots *snap_load(Disk *disk) {
+    if (disk->snap) return disk->snap;
+    Superblock *sb = disk->sb;
+    Snapshots *s = calloc(1, sizeof(Snapshots));
+    s->entries[MAP_ITABLE] = sb->data_start_block - sb->inode_start;
+    s->entries[MAP_BITMAP] = sb->inode_bitmap_start - sb->bitmap_start_block;
+    s->held = calloc(s->entries[MAP_BITMAP], disk->block_size);
+    s->held_loaded = calloc(s->entries[MAP_BITMAP] ? s->entries[MAP_BITMAP] : 1, 1);
+    if (sb->snapshot_table != 0 &&
+        stats_pread(disk->fd, s->table, sizeof(s->table), disk_block_offset(disk, sb->snapshot_table)) !=
+            (ssize_t)sizeof(s->table)) {
+        memset(s->table, 0, sizeof(s->table));
+    }
+    select_newest(disk, s);
+    disk->snap = s;
+    return s;
+}
+
+// Estado da imagem viva com snapshots (NULL se não houver nenhum ou se o
+// disco for um snapshot aberto só para leitura): caminho rápido dos ganchos
+static Snapshots *snap_active(Disk *disk) {
+    if (disk->snap && disk->snap->view) return NULL;
+    if (disk->sb->snapshot_count == 0) return NULL;
+    Snapshots *s = snap_load(disk);
+    return s->newest < 0 ? NULL : s;
+}
+
+/* ====================== */
+/* Cópia na escrita       */
+/* ====================== */
+
+// Copia o bloco de metadados (posição k do mapa kind) antes da primeira
+// escrita após o snapshot mais novo
+static int cow_copy(Disk *disk, Snapshots *s, MapKind kind, uint32_t k, uint32_t block) {
+    STATS_SCOPE(STATS_SNAPSHOT_COW);
+    uint8_t *buffer = disk_buf_get(disk);
+    if (stats_pread(disk->fd, buffer, disk->block_size, disk_block_offset(disk, block)) != (ssize_t)disk->block_size) {
+        disk_buf_put(disk, buffer);
+        return -1;
+    }
+
+    // A reserva da cópia altera o bitmap, talvez este mesmo bloco: o conteúdo
+    // antigo já está em buffer
+    s->map[kind][k] = MAP_PENDING;
+    uint32_t copy = bitmap_find_free_block(disk);
+    if (copy != (uint32_t)-1) bitmap_set(disk, copy, 1);
+    if (copy == (uint32_t)-1 ||
+        stats_pwrite(disk->fd, buffer, disk->block_size, disk_block_offset(disk, copy)) != (ssize_t)disk->block_size) {
+        s->map[kind][k] = 0;
+        disk_buf_put(disk, buffer);
+        printf("[ERRO] Sem espaço para preservar o bloco %u no snapshot\n", block);
+        return -1;
+    }
+    disk_buf_put(disk, buffer);
+
+    // Os snapshots mais antigos sem cópia deste bloco viam o mesmo conteúdo
+    s->map[kind][k] = copy;
+    for (int i = 0; i < SNAPSHOT_MAX; i++) {
+        SnapshotRecord *r = &s->table[i];
+        if (r->id == 0) continue;
+        if (i != s->newest && map_get(disk, r, kind, k) != 0) continue;
+        map_set(disk, r, kind, k, copy);
+    }
+    return 0;
+}
+
+int snapshot_cow_meta(Disk *disk, uint32_t block, uint32_t count) {
+    Snapshots *s = snap_active(disk);
+    if (!s) return 0;
+    Superblock *sb = disk->sb;
+    int result = 0;
+    for (uint32_t b = block; b < block + count; b++) {
+        MapKind kind;
+        uint32_t k;
+        if (b >= sb->inode_start && b < sb->data_start_block) {
+            kind = MAP_ITABLE;
+            k = b - sb->inode_start;
+        } else if (b >= sb->bitmap_start_block && b < sb->inode_bitmap_start) {
+            kind = MAP_BITMAP;
+            k = b - sb->bitmap_start_block;
+        } else {
+            continue; // Bitmap de i-nodes e dados não são copiados aqui
+        }
+        if (s->map[kind][k] != 0) continue; // Já copiado (vale para todos os snapshots)
+        if (cow_copy(disk, s, kind, k, b) != 0) result = -1;
+    }
+    return result;
+}
+
+// Soma em held o bloco j do bitmap congelado de cada snapshot
+static void held_load(Disk *disk, Snapshots *s, uint32_t j) {
+    uint8_t *dst = s->held + (size_t)j * disk->block_size;
+    uint8_t *buffer = disk_buf_get(disk);
+    memset(dst, 0, disk->block_size);
+    for (int i = 0; i < SNAPSHOT_MAX; i++) {
+        SnapshotRecord *r = &s->table[i];
+        if (r->id == 0) continue;
+        uint32_t entry = (i == s->newest) ? s->map[MAP_BITMAP][j] : map_get(disk, r, MAP_BITMAP, j);
+        // Sem cópia: o bloco do bitmap não mudou desde o snapshot
+        uint32_t src = (entry != 0 && entry != MAP_PENDING) ? entry : disk->sb->bitmap_start_block + j;
+        if (stats_pread(disk->fd, buffer, disk->block_size, disk_block_offset(disk, src)) != (ssize_t)disk->block_size) {
+            continue;
+        }
+        for (uint32_t b = 0; b < disk->block_size; b++) dst[b] |= buffer[b];
+    }
+    disk_buf_put(disk, buffer);
+    s->held_loaded[j] = 1;
+}
+
+int snapshot_holds(Disk *disk, uint32_t block_num) {
+    Snapshots *s = snap_active(disk);
+    if (!s || block_num < disk->sb->data_start_block) return 0;
+    uint32_t j = block_num / (disk->block_size * 8);
+    if (j >= s->entries[MAP_BITMAP]) return 0;
+    if (!s->held_loaded[j]) held_load(disk, s, j);
+    return (s->held[block_num / 8] >> (block_num % 8)) & 1;
+}
+
+int snapshot_cow_block(Disk *disk, Inode *inode, uint32_t index, int keep) {
+    uint32_t old = inode->blocks[index];
+    if (old == 0 || old == (uint32_t)-1 || !snapshot_holds(disk, old)) return 0;
+    STATS_SCOPE(STATS_SNAPSHOT_COW);
+
+    // O bloco novo fica logo após o anterior do arquivo, se possível
+    uint32_t goal = (index > 0 && inode->blocks[index - 1] != 0) ? inode->blocks[index - 1] + 1 : 0;
+    uint32_t got;
+    uint32_t block = alloc_extent(disk, 1, goal, 1, &got);
+    if (block == (uint32_t)-1) {
+        printf("[ERRO] Sem espaço para copiar o bloco %u (retido por um snapshot)\n", old);
+        return -1;
+    }
+    if (keep) {
+        uint8_t *buffer = disk_buf_get(disk);
+        int ok = stats_pread(disk->fd, buffer, disk->block_size, disk_block_offset(disk, old)) == (ssize_t)disk->block_size &&
+                 stats_pwrite(disk->fd, buffer, disk->block_size, disk_block_offset(disk, block)) == (ssize_t)disk->block_size;
+        disk_buf_put(disk, buffer);
+        if (!ok) {
+            bitmap_set(disk, block, 0);
+            return -1;
+        }
+    }
+    inode->blocks[index] = block;
+    bitmap_set(disk, old, 0); // Continua marcado enquanto algum snapshot o retiver
+    return 1;
+}
+
+/* ====================== */
+/* Criação e remoção      */
+/* ====================== */
+
+uint32_t snapshot_create(Disk *disk) {
+    STATS_SCOPE(STATS_SNAPSHOT_CREATE);
+    if (snapshot_read_only(disk)) return (uint32_t)-1;
+    // As cópias são reservadas no meio de uma alteração do bitmap: só o
+    // bitmap em memória do alocador já enxerga o bloco sendo alocado
+    if (!disk->alloc) {
+        printf("[ERRO] Snapshots exigem o alocador em memória\n");
+        return (uint32_t)-1;
+    }
+    Snapshots *s = snap_load(disk);
+    Superblock *sb = disk->sb;
+
+    int slot = -1;
+    for (int i = 0; i < SNAPSHOT_MAX && slot < 0; i++) {
+        if (s->table[i].id == 0) slot = i;
+    }
+    if (slot < 0) {
+        printf("[ERRO] Limite de %d snapshots atingido (remova algum com snapshot_delete)\n", SNAPSHOT_MAX);
+        return (uint32_t)-1;
+    }
+
+    // Tabela criada no primeiro snapshot
+    uint32_t got;
+    if (sb->snapshot_table == 0) {
+        uint32_t block = alloc_extent(disk, 1, 0, 1, &got);
+        if (block == (uint32_t)-1) {
+            printf("[ERRO] Sem espaço para a tabela de snapshots\n");
+            return (uint32_t)-1;
+        }
+        sb->snapshot_table = block;
+        disk_zero(disk, disk_block_offset(disk, block), disk->block_size);
+        superblock_sync(disk);
+    }
+
+    // Mapas zerados (nenhum bloco copiado ainda), cada um num trecho contíguo
+    uint32_t start[MAP_KINDS], count[MAP_KINDS];
+    for (int kind = 0; kind < MAP_KINDS; kind++) {
+        count[kind] = map_blocks(disk, s->entries[kind]);
+        start[kind] = alloc_extent(disk, count[kind], 0, count[kind], &got);
+        if (start[kind] == (uint32_t)-1) {
+            if (kind > 0) alloc_release_extent(disk, start[0], count[0]);
+            printf("[ERRO] Sem %u blocos seguidos para os mapas do snapshot\n", count[kind]);
+            return (uint32_t)-1;
+        }
+        disk_zero(disk, disk_block_offset(disk, start[kind]), (uint64_t)count[kind] * disk->block_size);
+    }
+
+    // A partir do registro, o estado atual da imagem é o estado congelado
+    SnapshotRecord *r = &s->table[slot];
+    memset(r, 0, sizeof(SnapshotRecord));
+    r->id = sb->snapshot_next_id ? sb->snapshot_next_id : 1;
+    r->itable_map = start[MAP_ITABLE];
+    r->bitmap_map = start[MAP_BITMAP];
+    r->free_blocks = sb->free_blocks;
+    r->free_inodes = sb->free_inodes;
+    r->created_at = time(NULL);
+    table_write(disk, s);
+    sb->snapshot_next_id = r->id + 1;
+    sb->snapshot_count++;
+    superblock_sync(disk);
+
+    // O novo snapshot é o mais novo e ainda não tem cópias
+    s->newest = slot;
+    for (int kind = 0; kind < MAP_KINDS; kind++) {
+        free(s->map[kind]);
+        s->map[kind] = calloc(s->entries[kind] ? s->entries[kind] : 1, sizeof(uint32_t));
+    }
+    memset(s->held_loaded, 0, s->entries[MAP_BITMAP]);
+    return r->id;
+}
+
+// Marca em owned (um byte por bloco) os blocos do snapshot da posição slot:
+// os do bitmap congelado, as cópias de metadados e os mapas.
+// Retorna quantas cópias o snapshot tem
+static uint32_t mark_snapshot(Disk *disk, Snapshots *s, int slot, uint8_t *owned) {
+    SnapshotRecord *r = &s->table[slot];
+    uint32_t total_blocks = (uint32_t)(disk->size / disk->block_size);
+    uint32_t bits_per_block = disk->block_size * 8;
+    uint32_t *maps[MAP_KINDS];
+    for (int kind = 0; kind < MAP_KINDS; kind++) maps[kind] = map_read(disk, r, kind, s->entries[kind]);
+
+    uint8_t *buffer = disk_buf_get(disk);
+    for (uint32_t j = 0; j < s->entries[MAP_BITMAP]; j++) {
+        uint32_t src = maps[MAP_BITMAP][j] ? maps[MAP_BITMAP][j] : disk->sb->bitmap_start_block + j;
+        if (stats_pread(disk->fd, buffer, disk->block_size, disk_block_offset(disk, src)) != (ssize_t)disk->block_size) {
+            continue;
+        }
+        for (uint32_t bit = 0; bit < bits_per_block; bit++) {
+            uint32_t b = j * bits_per_block + bit;
+            if (b >= total_blocks) break;
+            if ((buffer[bit / 8] >> (bit % 8)) & 1) owned[b] = 1;
+        }
+    }
+    disk_buf_put(disk, buffer);
+
+    uint32_t copies = 0;
+    for (int kind = 0; kind < MAP_KINDS; kind++) {
+        for (uint32_t k = 0; k < s->entries[kind]; k++) {
+            uint32_t copy = maps[kind][k];
+            if (copy == 0 || copy >= total_blocks) continue;
+            owned[copy] = 1;
+            copies++;
+        }
+        uint32_t n = map_blocks(disk, s->entries[kind]);
+        for (uint32_t m = 0; m < n; m++) owned[map_start(r, kind) + m] = 1;
+        free(maps[kind]);
+    }
+    return copies;
+}
+
+// Marca em refs os blocos apontados pelos i-nodes em uso da imagem viva
+static void mark_live(Disk *disk, uint8_t *refs) {
+    Superblock *sb = disk->sb;
+    uint32_t total_blocks = (uint32_t)(disk->size / disk->block_size);
+    uint32_t per_chunk = DISK_BUF_BLOCKS * disk->block_size / INODE_SIZE;
+    uint8_t *buffer = disk_buf_get(disk);
+    for (uint32_t first = 0; first < sb->inode_count; first += per_chunk) {
+        uint32_t n = sb->inode_count - first < per_chunk ? sb->inode_count - first : per_chunk;
+        off_t offset = disk_block_offset(disk, sb->inode_start) + (off_t)first * INODE_SIZE;
+        if (stats_pread(disk->fd, buffer, (size_t)n * INODE_SIZE, offset) != (ssize_t)((size_t)n * INODE_SIZE)) break;
+        for (uint32_t i = 0; i < n; i++) {
+            Inode *inode = (Inode *)(buffer + (size_t)i * INODE_SIZE);
+            if (inode->mode == 0) continue;
+            for (int k = 0; k < MAX_BLOCKS_PER_INODE; k++) {
+                if (inode->blocks[k] != 0 && inode->blocks[k] < total_blocks) refs[inode->blocks[k]] = 1;
+            }
+            if (inode->indirect_block != 0 && inode->indirect_block < total_blocks) refs[inode->indirect_block] = 1;
+        }
+    }
+    disk_buf_put(disk, buffer);
+}
+
+int snapshot_delete(Disk *disk, uint32_t id) {
+    STATS_SCOPE(STATS_SNAPSHOT_DELETE);
+    if (snapshot_read_only(disk)) return -1;
+    Snapshots *s = snap_load(disk);
+    Superblock *sb = disk->sb;
+    int slot = table_find(s, id);
+    if (slot < 0) {
+        printf("[ERRO] Snapshot %u não existe\n", id);
+        return -1;
+    }
+
+    // Candidatos: tudo o que o snapshot retinha. Ficam os blocos da imagem
+    // viva, dos outros snapshots e a própria tabela
+    uint32_t total_blocks = (uint32_t)(disk->size / disk->block_size);
+    uint8_t *drop = calloc(total_blocks, 1);
+    uint8_t *keep = calloc(total_blocks, 1);
+    mark_snapshot(disk, s, slot, drop);
+    for (int i = 0; i < SNAPSHOT_MAX; i++) {
+        if (i != slot && s->table[i].id != 0) mark_snapshot(disk, s, i, keep);
+    }
+    mark_live(disk, keep);
+    keep[sb->snapshot_table] = 1;
+
+    // Sai da tabela antes de liberar: bitmap_set deixa de considerar os blocos retidos por ele
+    memset(&s->table[slot], 0, sizeof(SnapshotRecord));
+    table_write(disk, s);
+    sb->snapshot_count--;
+    superblock_sync(disk);
+    select_newest(disk, s);
+
+    uint32_t freed = 0;
+    for (uint32_t b = sb->data_start_block; b < total_blocks; b++) {
+        if (!drop[b] || keep[b] || !bitmap_get(disk, b)) continue;
+        bitmap_set(disk, b, 0);
+        if (!bitmap_get(disk, b)) freed++; // Retido por um snapshot mais novo: fica até ele sair
+    }
+    free(keep);
+    free(drop);
+    printf("[INFO] Snapshot %u removido: %u blocos liberados\n", id, freed);
+    return 0;
+}
+
+int snapshot_list(Disk *disk, SnapshotInfo *out, uint32_t max, uint32_t *retained) {
+    *retained = 0;
+    if (disk->sb->snapshot_table == 0) return 0;
+    Snapshots *s = snap_load(disk);
+    uint32_t total_blocks = (uint32_t)(disk->size / disk->block_size);
+    uint8_t *owned = calloc(total_blocks, 1);
+    uint8_t *refs = calloc(total_blocks, 1);
+
+    // Do mais antigo ao mais novo
+    uint32_t n = 0, last_id = 0;
+    while (n < max) {
+        int next = -1;
+        for (int i = 0; i < SNAPSHOT_MAX; i++) {
+            if (s->table[i].id > last_id && (next < 0 || s->table[i].id < s->table[next].id)) next = i;
+        }
+        if (next < 0) break;
+        SnapshotRecord *r = &s->table[next];
+        out[n].id = r->id;
+        out[n].created_at = (time_t)r->created_at;
+        out[n].copies = mark_snapshot(disk, s, next, owned);
+        out[n].map_blocks = map_blocks(disk, s->entries[MAP_ITABLE]) + map_blocks(disk, s->entries[MAP_BITMAP]);
+        last_id = r->id;
+        n++;
+    }
+
+    // Marcados no bitmap vivo, mas sem nenhum i-node vivo apontando para eles
+    if (!snapshot_read_only(disk)) {
+        mark_live(disk, refs);
+        for (uint32_t b = disk->sb->data_start_block; b < total_blocks; b++) {
+            if (owned[b] && !refs[b] && bitmap_get(disk, b)) (*retained)++;
+        }
+    }
+    free(refs);
+    free(owned);
+    return (int)n;
+}
+
+void snapshot_mark_blocks(Disk *disk, uint8_t *owned) {
+    if (disk->sb->snapshot_table == 0) return;
+    Snapshots *s = snap_load(disk);
+    owned[disk->sb->snapshot_table] = 1;
+    for (int i = 0; i < SNAPSHOT_MAX; i++) {
+        if (s->table[i].id != 0) mark_snapshot(disk, s, i, owned);
+    }
+}
+
+/* ====================== */
+/* Leitura de um snapshot */
+/* ====================== */
+
+Disk *snapshot_open(const char *filename, uint32_t id) {
+    Disk *disk = superblock_open(filename);
+    if (!disk) return NULL;
+    Snapshots *s = snap_load(disk);
+    int slot = table_find(s, id);
+    // Descritor só de leitura: nenhuma gravação chega à imagem
+    int fd = slot < 0 ? -1 : open(filename, O_RDONLY);
+    if (fd < 0) {
+        Superblock *sb = disk->sb;
+        disk_free(disk);
+        free(sb);
+        return NULL;
+    }
+    close(disk->fd);
+    disk->fd = fd;
+
+    // Só o mapa da tabela de i-nodes é usado: os blocos de dados e de
+    // diretórios do snapshot nunca são regravados
+    SnapshotRecord *r = &s->table[slot];
+    free(s->map[MAP_BITMAP]);
+    free(s->map[MAP_ITABLE]);
+    s->map[MAP_BITMAP] = NULL;
+    s->map[MAP_ITABLE] = map_read(disk, r, MAP_ITABLE, s->entries[MAP_ITABLE]);
+    s->view = id;
+    disk->sb->free_blocks = r->free_blocks;
+    disk->sb->free_blocks_count = r->free_blocks;
+    disk->sb->free_inodes = r->free_inodes;
+    return disk;
+}
+
+uint32_t snapshot_read_only(Disk *disk) {
+    return disk->snap ? disk->snap->view : 0;
+}
+
+off_t snapshot_view_offset(Disk *disk, off_t offset) {
+    Snapshots *s = disk->snap;
+    if (!s || !s->view) return offset;
+    off_t table = disk_block_offset(disk, disk->sb->inode_start);
+    if (offset < table) return offset;
+    uint64_t k = (uint64_t)(offset - table) / disk->block_size;
+    if (k >= s->entries[MAP_ITABLE] || s->map[MAP_ITABLE][k] == 0) return offset;
+    return disk_block_offset(disk, s->map[MAP_ITABLE][k]) + (offset - table) % disk->block_size;
+}
+
+void snapshot_detach(Disk *disk) {
+    Snapshots *s = disk->snap;
+    if (!s) return;
+    for (int kind = 0; kind < MAP_KINDS; kind++) free(s->map[kind]);
+    free(s->held);
+    free(s->held_loaded);
+    free(s);
+    disk->snap = NULL;
+}
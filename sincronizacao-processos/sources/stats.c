@@ -0,0 +1,283 @@
+#include "stats.h"
+#include "icache.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define STATS_SUB (1 << STATS_SUB_BITS)
+
+static const char *op_names[STATS_OP_COUNT] = {
+    [STATS_OP_NONE] = "(nenhuma)",
+    [STATS_BITMAP_SET] = "bitmap_set",
+    [STATS_BITMAP_SET_RANGE] = "bitmap_set_range",
+    [STATS_BITMAP_GET] = "bitmap_get",
+    [STATS_BITMAP_FIND_FREE_BLOCK] = "bitmap_find_free_block",
+    [STATS_BITMAP_FIND_FREE_RUN] = "bitmap_find_free_run",
+    [STATS_INODE_BITMAP_SET] = "inode_bitmap_set",
+    [STATS_INODE_BITMAP_GET] = "inode_bitmap_get",
+    [STATS_INODE_SAVE] = "inode_save",
+    [STATS_INODE_LOAD] = "inode_load",
+    [STATS_INODE_LOAD_MANY] = "inode_load_many",
+    [STATS_INODE_ALLOC] = "inode_alloc",
+    [STATS_INODE_ALLOC_MANY] = "inode_alloc_many",
+    [STATS_INODE_FREE] = "inode_free",
+    [STATS_INODE_ALLOC_BLOCKS] = "inode_alloc_blocks",
+    [STATS_INODE_WRITE_BLOCKS] = "inode_write_blocks",
+    [STATS_INODE_WRITE_SPARSE] = "inode_write_sparse",
+    [STATS_DIR_CREATE] = "dir_create",
+    [STATS_DIR_ADD_ENTRY] = "dir_add_entry",
+    [STATS_DIR_USAGE_ADD] = "dir_usage_add",
+    [STATS_DIR_ITER_OPEN] = "dir_iter_open",
+    [STATS_DIR_ITER_NEXT] = "dir_iter_next",
+    [STATS_DIR_ITER_UPDATE] = "dir_iter_update",
+    [STATS_DIR_FIND_ENTRY] = "dir_find_entry",
+    [STATS_DIR_LOOKUP] = "dir_lookup",
+    [STATS_DIR_LIST] = "dir_list",
+    [STATS_DIR_LIST_DETAILED] = "dir_list_detailed",
+    [STATS_DIR_LIST_DIRS] = "dir_list_dirs",
+    [STATS_DIR_RENAME_ENTRY] = "dir_rename_entry",
+    [STATS_DIR_REMOVE_ENTRY] = "dir_remove_entry",
+    [STATS_DIR_FIND_PARENT] = "dir_find_parent",
+    [STATS_FILE_CREATE] = "file_create",
+    [STATS_FILE_CREATE_DATA] = "file_create_data",
+    [STATS_FILE_READ] = "file_read",
+    [STATS_FILE_READ_DATA] = "file_read_data",
+    [STATS_FILE_WRITE_DATA] = "file_write_data",
+    [STATS_FILE_TRUNCATE] = "file_truncate",
+    [STATS_FILE_SEEK] = "file_seek",
+    [STATS_FILE_DELETE] = "file_delete",
+    [STATS_FILE_LINK] = "file_link",
+    [STATS_SNAPSHOT_CREATE] = "snapshot_create",
+    [STATS_SNAPSHOT_DELETE] = "snapshot_delete",
+    [STATS_SNAPSHOT_COW] = "snapshot_cow",
+};
+
+static const char *syscall_names[STATS_SYS_COUNT] = {
+    [STATS_SYS_READ] = "read",
+    [STATS_SYS_WRITE] = "write",
+    [STATS_SYS_SEEK] = "lseek",
+    [STATS_SYS_URING] = "io_uring_enter",
+    [STATS_SYS_OTHER] = "outras",
+};
+
+// Contadores globais (várias threads atualizam com operações atômicas)
+static StatsOpCounters counters[STATS_OP_COUNT];
+static uint64_t syscalls[STATS_SYS_COUNT];
+static int enabled = 1;
+
+// Operação mais interna em andamento nesta thread
+static __thread StatsOp current_op = STATS_OP_NONE;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/* ====================== */
+/* Histograma             */
+/* ====================== */
+
+// Valores até STATS_SUB são exatos; acima, cada potência de 2 é dividida em
+// STATS_SUB faixas iguais
+static uint32_t bucket_of(uint64_t v) {
+    if (v < STATS_SUB) return (uint32_t)v;
+    int e = 63 - __builtin_clzll(v);
+    return ((uint32_t)(e - STATS_SUB_BITS + 1) << STATS_SUB_BITS) |
+           (uint32_t)((v >> (e - STATS_SUB_BITS)) & (STATS_SUB - 1));
+}
+
+// Maior valor que cai na faixa
+static uint64_t bucket_upper(uint32_t b) {
+    if (b < STATS_SUB) return b;
+    int shift = (int)(b >> STATS_SUB_BITS) - 1;
+    uint64_t lower = (uint64_t)(STATS_SUB | (b & (STATS_SUB - 1))) << shift;
+    return lower + ((1ULL << shift) - 1);
+}
+
+uint64_t stats_percentile(const StatsOpCounters *c, double p) {
+    if (c->count == 0) return 0;
+    uint64_t rank = (uint64_t)(p * c->count + 0.999999);
+    if (rank == 0) rank = 1;
+    uint64_t seen = 0;
+    for (uint32_t b = 0; b < STATS_BUCKETS; b++) {
+        seen += c->hist[b];
+        if (seen >= rank) {
+            uint64_t v = bucket_upper(b);
+            return v > c->max_ns ? c->max_ns : v;
+        }
+    }
+    return c->max_ns;
+}
+
+/* ====================== */
+/* Medição                */
+/* ====================== */
+
+StatsScope stats_scope_begin(StatsOp op) {
+    StatsScope scope = {op, current_op, 0};
+    current_op = op;
+    if (__atomic_load_n(&enabled, __ATOMIC_RELAXED)) scope.start = now_ns();
+    return scope;
+}
+
+void stats_scope_end(StatsScope *scope) {
+    current_op = scope->prev;
+    if (scope->start == 0) return;
+    uint64_t ns = now_ns() - scope->start;
+    StatsOpCounters *c = &counters[scope->op];
+
+    __atomic_fetch_add(&c->count, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&c->total_ns, ns, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&c->hist[bucket_of(ns)], 1, __ATOMIC_RELAXED);
+    uint64_t old = __atomic_load_n(&c->max_ns, __ATOMIC_RELAXED);
+    while (ns > old && !__atomic_compare_exchange_n(&c->max_ns, &old, ns, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {}
+    old = __atomic_load_n(&c->min_ns, __ATOMIC_RELAXED);
+    while ((old == 0 || ns < old) &&
+           !__atomic_compare_exchange_n(&c->min_ns, &old, ns, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {}
+}
+
+void stats_syscall(StatsSyscall kind) {
+    __atomic_fetch_add(&syscalls[kind], 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&counters[current_op].syscalls, 1, __ATOMIC_RELAXED);
+}
+
+void stats_bytes(int write, uint64_t bytes) {
+    StatsOpCounters *c = &counters[current_op];
+    __atomic_fetch_add(write ? &c->bytes_written : &c->bytes_read, bytes, __ATOMIC_RELAXED);
+}
+
+ssize_t stats_read(int fd, void *buf, size_t len) {
+    ssize_t n = read(fd, buf, len);
+    stats_syscall(STATS_SYS_READ);
+    if (n > 0) stats_bytes(0, n);
+    return n;
+}
+
+ssize_t stats_write(int fd, const void *buf, size_t len) {
+    ssize_t n = write(fd, buf, len);
+    stats_syscall(STATS_SYS_WRITE);
+    if (n > 0) stats_bytes(1, n);
+    return n;
+}
+
+ssize_t stats_pread(int fd, void *buf, size_t len, off_t offset) {
+    ssize_t n = pread(fd, buf, len, offset);
+    stats_syscall(STATS_SYS_READ);
+    if (n > 0) stats_bytes(0, n);
+    return n;
+}
+
+ssize_t stats_pwrite(int fd, const void *buf, size_t len, off_t offset) {
+    ssize_t n = pwrite(fd, buf, len, offset);
+    stats_syscall(STATS_SYS_WRITE);
+    if (n > 0) stats_bytes(1, n);
+    return n;
+}
+
+off_t stats_lseek(int fd, off_t offset, int whence) {
+    stats_syscall(STATS_SYS_SEEK);
+    return lseek(fd, offset, whence);
+}
+
+void stats_enable(int enable) {
+    __atomic_store_n(&enabled, enable ? 1 : 0, __ATOMIC_RELAXED);
+}
+
+void stats_reset(void) {
+    memset(counters, 0, sizeof(counters));
+    memset(syscalls, 0, sizeof(syscalls));
+}
+
+void stats_get(StatsOp op, StatsOpCounters *out) {
+    memcpy(out, &counters[op], sizeof(StatsOpCounters));
+}
+
+const char *stats_op_name(StatsOp op) {
+    return (op < STATS_OP_COUNT) ? op_names[op] : "?";
+}
+
+/* ====================== */
+/* Relatórios             */
+/* ====================== */
+
+static double hit_rate(const ICacheStats *ic) {
+    uint64_t total = ic->hits + ic->misses;
+    return total ? 100.0 * ic->hits / total : 0.0;
+}
+
+void stats_print(Disk *disk) {
+    uint64_t bytes_read = 0, bytes_written = 0;
+    printf("=== ESTATÍSTICAS ===\n");
+    printf("%-24s | %9s | %10s | %9s | %9s | %10s | %8s | %10s | %10s\n", "Operação", "Chamadas", "Média(us)",
+           "p50(us)", "p99(us)", "Máx(us)", "Syscalls", "Lidos(KB)", "Gravados(KB)");
+    for (int op = 0; op < STATS_OP_COUNT; op++) {
+        StatsOpCounters *c = &counters[op];
+        bytes_read += c->bytes_read;
+        bytes_written += c->bytes_written;
+        if (c->count == 0 && c->syscalls == 0) continue;
+        printf("%-22s | %9llu | %9.2f | %9.2f | %9.2f | %9.2f | %8llu | %10.1f | %10.1f\n", op_names[op],
+               (unsigned long long)c->count, c->count ? c->total_ns / 1000.0 / c->count : 0.0,
+               stats_percentile(c, 0.50) / 1000.0, stats_percentile(c, 0.99) / 1000.0, c->max_ns / 1000.0,
+               (unsigned long long)c->syscalls, c->bytes_read / 1024.0, c->bytes_written / 1024.0);
+    }
+
+    printf("Syscalls:");
+    for (int s = 0; s < STATS_SYS_COUNT; s++) printf(" %s %llu", syscall_names[s], (unsigned long long)syscalls[s]);
+    printf("\nBytes lidos: %llu, gravados: %llu\n", (unsigned long long)bytes_read, (unsigned long long)bytes_written);
+
+    ICacheStats ic;
+    icache_stats(disk, &ic);
+    printf("Cache de i-nodes: %llu acertos, %llu faltas (%.1f%% de acertos), %llu descartes\n",
+           (unsigned long long)ic.hits, (unsigned long long)ic.misses, hit_rate(&ic),
+           (unsigned long long)ic.evictions);
+}
+
+int stats_write_json(Disk *disk, const char *path) {
+    FILE *f = fopen(path, "w");
+    if (!f) return -1;
+
+    uint64_t bytes_read = 0, bytes_written = 0;
+    int first = 1;
+    fprintf(f, "{\n  \"operations\": {");
+    for (int op = 0; op < STATS_OP_COUNT; op++) {
+        StatsOpCounters *c = &counters[op];
+        bytes_read += c->bytes_read;
+        bytes_written += c->bytes_written;
+        if (c->count == 0 && c->syscalls == 0) continue;
+        fprintf(f, "%s\n    \"%s\": {\"count\": %llu, \"total_ns\": %llu, \"min_ns\": %llu, "
+                   "\"p50_ns\": %llu, \"p90_ns\": %llu, \"p99_ns\": %llu, \"p999_ns\": %llu, \"max_ns\": %llu, "
+                   "\"syscalls\": %llu, \"bytes_read\": %llu, \"bytes_written\": %llu, \"histogram\": [",
+                first ? "" : ",", op == STATS_OP_NONE ? "none" : op_names[op],
+                (unsigned long long)c->count, (unsigned long long)c->total_ns, (unsigned long long)c->min_ns,
+                (unsigned long long)stats_percentile(c, 0.50), (unsigned long long)stats_percentile(c, 0.90),
+                (unsigned long long)stats_percentile(c, 0.99), (unsigned long long)stats_percentile(c, 0.999),
+                (unsigned long long)c->max_ns, (unsigned long long)c->syscalls,
+                (unsigned long long)c->bytes_read, (unsigned long long)c->bytes_written);
+        // Só as faixas ocupadas: [maior valor da faixa em ns, chamadas]
+        int first_bucket = 1;
+        for (uint32_t b = 0; b < STATS_BUCKETS; b++) {
+            if (c->hist[b] == 0) continue;
+            fprintf(f, "%s[%llu, %llu]", first_bucket ? "" : ", ", (unsigned long long)bucket_upper(b),
+                    (unsigned long long)c->hist[b]);
+            first_bucket = 0;
+        }
+        fprintf(f, "]}");
+        first = 0;
+    }
+    fprintf(f, "\n  },\n  \"syscalls\": {");
+    for (int s = 0; s < STATS_SYS_COUNT; s++) {
+        fprintf(f, "%s\"%s\": %llu", s ? ", " : "", s == STATS_SYS_OTHER ? "other" : syscall_names[s],
+                (unsigned long long)syscalls[s]);
+    }
+    fprintf(f, "},\n  \"bytes\": {\"read\": %llu, \"written\": %llu},\n",
+            (unsigned long long)bytes_read, (unsigned long long)bytes_written);
+
+    ICacheStats ic;
+    icache_stats(disk, &ic);
+    fprintf(f, "  \"icache\": {\"hits\": %llu, \"misses\": %llu, \"evictions\": %llu, \"hit_rate\": %.4f}\n}\n",
+            (unsigned long long)ic.hits, (unsigned long long)ic.misses, (unsigned long long)ic.evictions,
+            hit_rate(&ic) / 100.0);
+    return fclose(f) == 0 ? 0 : -1;
+}
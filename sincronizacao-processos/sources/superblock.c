@@ -1,22 +1,95 @@
 #include "superblock.h"
 #include "bitmap.h"
+#include "inode.h"
+#include "stats.h"
 #include <unistd.h>
 #include <stdlib.h>  
+#include <fcntl.h>
 #define FS_MAGIC 0x46535F53 // "FS_S"
 
 void superblock_init(Disk *disk, Superblock *sb) {
+    uint32_t total_blocks = (uint32_t)(disk->size / disk->block_size);
+    uint32_t bitmap_bytes = (uint32_t)(((uint64_t)total_blocks + 7) / 8);
+    uint32_t bitmap_blocks = (bitmap_bytes + disk->block_size - 1) / disk->block_size;
+    uint64_t inodes_by_size = disk->size / BYTES_PER_INODE;
+    uint32_t inode_count = inodes_by_size > INODE_COUNT_MAX ? INODE_COUNT_MAX : (uint32_t)inodes_by_size;
+    uint32_t inode_bitmap_blocks = ((inode_count + 7) / 8 + disk->block_size - 1) / disk->block_size;
+
     sb->magic = FS_MAGIC;
     sb->disk_size = disk->size;
     sb->block_size = disk->block_size;
-    sb->bitmap_start_block = 1; 
+
+    // Layout: [superbloco][bitmap de blocos][bitmap de i-nodes][tabela de i-nodes][dados]
+    sb->bitmap_start_block = 1;
+    sb->free_blocks_bitmap_start = sb->bitmap_start_block;
+    sb->inode_count = inode_count;
+    sb->inode_bitmap_start = sb->bitmap_start_block + bitmap_blocks;
+    sb->inode_start = sb->inode_bitmap_start + inode_bitmap_blocks;
+    sb->data_start_block = sb->inode_start +
+        (uint32_t)(((uint64_t)sb->inode_count * INODE_SIZE + disk->block_size - 1) / disk->block_size);
+
+    sb->free_blocks = total_blocks - sb->data_start_block;
+    sb->free_blocks_count = sb->free_blocks;
+    sb->free_inodes = sb->inode_count;
+    sb->alloc_policy = 0; // first-fit
+    sb->snapshot_table = 0;
+    sb->snapshot_count = 0;
+    sb->snapshot_next_id = 1;
+
+    disk->sb = sb;
     bitmap_init(disk,sb); 
-    lseek(disk->fd, 0, SEEK_SET);
-    write(disk->fd, sb, sizeof(Superblock)); // Escreve no início do disco
+    inode_table_init(disk);
+    stats_pwrite(disk->fd, sb, sizeof(Superblock), 0); // Escreve no início do disco
 }
 
 Superblock *superblock_load(Disk *disk) {
     Superblock *sb = malloc(sizeof(Superblock));
-    lseek(disk->fd, 0, SEEK_SET);
-    read(disk->fd, sb, sizeof(Superblock));
-    return (sb->magic == FS_MAGIC) ? sb : NULL;
-}
\ No newline at end of file
+    stats_pread(disk->fd, sb, sizeof(Superblock), 0);
+    if (sb->magic != FS_MAGIC) {
+        free(sb);
+        return NULL;
+    }
+    disk->sb = sb;
+    return sb;
+}
+
+Disk *superblock_open(const char *filename) {
+    // Lê o superbloco direto do arquivo: tamanho e bloco ainda não são conhecidos
+    Superblock sb;
+    int fd = open(filename, O_RDONLY);
+    if (fd == -1) return NULL;
+    ssize_t n = pread(fd, &sb, sizeof(sb), 0);
+    close(fd);
+    if (n != (ssize_t)sizeof(sb) || sb.magic != FS_MAGIC) return NULL;
+
+    Disk *disk = disk_create(filename, sb.disk_size, sb.block_size);
+    if (!disk) return NULL;
+    if (!superblock_load(disk)) {
+        disk_free(disk);
+        return NULL;
+    }
+    return disk;
+}
+
+void superblock_sync(Disk *disk) {
+    stats_pwrite(disk->fd, disk->sb, sizeof(Superblock), 0);
+    disk->sb_dirty = 0;
+}
+
+void superblock_mark_dirty(Disk *disk) {
+    disk->sb_dirty = 1;
+}
+
+void superblock_flush(Disk *disk) {
+    if (disk->sb_dirty && disk->sb) superblock_sync(disk);
+}
+
+void superblock_statfs(Disk *disk, FsStat *st) {
+    Superblock *sb = disk->sb;
+    st->block_size = sb->block_size;
+    st->total_blocks = (uint32_t)(sb->disk_size / sb->block_size);
+    st->data_blocks = st->total_blocks - sb->data_start_block;
+    st->free_blocks = sb->free_blocks;
+    st->total_inodes = sb->inode_count;
+    st->free_inodes = sb->free_inodes;
+}
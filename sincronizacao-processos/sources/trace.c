@@ -0,0 +1,308 @@
+#include "trace.h"
+#include "inode.h"
+#include "bitmap.h"
+#include "dir.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+
+static const char *op_names[TRACE_OP_COUNT] = {
+    [TRACE_MKDIR] = "mkdir",
+    [TRACE_CREATE] = "create",
+    [TRACE_COPY] = "copy",
+    [TRACE_READ] = "read",
+    [TRACE_LIST] = "list",
+    [TRACE_DELETE] = "delete",
+    [TRACE_RMDIR] = "rmdir",
+    [TRACE_RENAME] = "rename",
+    [TRACE_MOVE] = "move",
+    [TRACE_LINK] = "link",
+    [TRACE_WRITE] = "write",
+    [TRACE_TRUNCATE] = "truncate",
+};
+
+// Gravação em andamento (só a thread principal grava)
+static FILE *trace_file = NULL;
+static uint64_t trace_t0;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+const char *trace_op_name(TraceOp op) {
+    return (op < TRACE_OP_COUNT) ? op_names[op] : "?";
+}
+
+/* ====================== */
+/* Gravação               */
+/* ====================== */
+
+int trace_start(const char *path, uint32_t block_size) {
+    trace_stop();
+    FILE *f = fopen(path, "wb");
+    if (!f) return -1;
+    TraceHeader h = {TRACE_MAGIC, TRACE_VERSION, 0, block_size, 0};
+    if (fwrite(&h, sizeof(h), 1, f) != 1) {
+        fclose(f);
+        return -1;
+    }
+    trace_file = f;
+    trace_t0 = now_ns();
+    return 0;
+}
+
+void trace_stop(void) {
+    if (!trace_file) return;
+    fclose(trace_file);
+    trace_file = NULL;
+}
+
+int trace_active(void) {
+    return trace_file != NULL;
+}
+
+uint64_t trace_begin(void) {
+    return trace_file ? now_ns() : 0;
+}
+
+static void trace_write(uint64_t start, uint64_t end, TraceOp op, uint32_t a, uint32_t b, uint32_t c,
+                        const char *name, uint32_t result, int ok) {
+    TraceRecord r;
+    memset(&r, 0, sizeof(r));
+    size_t len = name ? strnlen(name, MAX_NAME_LEN - 1) : 0;
+    uint64_t latency = end - start;
+    r.op = op;
+    r.ok = ok ? 1 : 0;
+    r.name_len = (uint8_t)len;
+    r.a = a;
+    r.b = b;
+    r.c = c;
+    r.result = result;
+    r.latency_ns = latency > UINT32_MAX ? UINT32_MAX : (uint32_t)latency;
+    r.timestamp_ns = start - trace_t0;
+    fwrite(&r, sizeof(r), 1, trace_file);
+    if (len) fwrite(name, 1, len, trace_file);
+}
+
+void trace_end(uint64_t start, TraceOp op, uint32_t a, uint32_t b, uint32_t c,
+               const char *name, uint32_t result, int ok) {
+    if (!trace_file || start == 0) return;
+    trace_write(start, now_ns(), op, a, b, c, name, result, ok);
+}
+
+void trace_end_create(Disk *disk, uint64_t start, TraceOp op, uint32_t dir, uint32_t source,
+                      const char *name, int ok) {
+    if (!trace_file || start == 0) return;
+    uint64_t end = now_ns();
+    uint32_t result = ok ? dir_lookup(disk, dir, name) : (uint32_t)-1;
+    uint32_t b = source, size = 0;
+    if (op == TRACE_CREATE && result != (uint32_t)-1) {
+        Inode *inode = inode_load(disk, result);
+        if (inode) {
+            size = inode->size;
+            uint32_t num_blocks = (size + disk->block_size - 1) / disk->block_size;
+            for (uint32_t i = 0; i < num_blocks && i < MAX_BLOCKS_PER_INODE; i++) {
+                if (inode->blocks[i] == 0) b |= 1u << i;
+            }
+            inode_put(inode);
+        }
+    }
+    trace_write(start, end, op, dir, b, size, name, result, ok && result != (uint32_t)-1);
+}
+
+/* ====================== */
+/* Reprodução             */
+/* ====================== */
+
+// I-nodes gravados -> i-nodes da reprodução (0 = não mapeado)
+typedef struct {
+    uint32_t *to;
+    uint32_t capacity;
+} TraceMap;
+
+static uint32_t map_get(const TraceMap *m, uint32_t inode_num) {
+    if (inode_num < m->capacity && m->to[inode_num]) return m->to[inode_num] - 1;
+    return inode_num;
+}
+
+static void map_set(TraceMap *m, uint32_t from, uint32_t to) {
+    if (from >= m->capacity) {
+        uint32_t cap = m->capacity ? m->capacity : 1024;
+        while (cap <= from) cap *= 2;
+        m->to = realloc(m->to, cap * sizeof(uint32_t));
+        memset(m->to + m->capacity, 0, (cap - m->capacity) * sizeof(uint32_t));
+        m->capacity = cap;
+    }
+    m->to[from] = to + 1;
+}
+
+// Executa um registro com a mesma API dos comandos. Retorna 0 ou -1
+static int replay_one(Disk *disk, const TraceRecord *r, const char *name, TraceMap *map, uint8_t *buffer) {
+    uint32_t a = map_get(map, r->a), b = map_get(map, r->b), c = map_get(map, r->c);
+    uint32_t created = (uint32_t)-1;
+    switch (r->op) {
+        case TRACE_MKDIR:
+            if (dir_create(disk, a, name) != 0) return -1;
+            created = dir_lookup(disk, a, name);
+            break;
+        case TRACE_CREATE: {
+            // Conteúdo sintético: mesmo tamanho e mesmos buracos
+            uint32_t size = r->c;
+            uint32_t max = MAX_BLOCKS_PER_INODE * disk->block_size;
+            if (size > max) size = max;
+            memset(buffer, 'x', size);
+            for (uint32_t i = 0; i < MAX_BLOCKS_PER_INODE; i++) {
+                if (!(r->b & (1u << i)) || i * disk->block_size >= size) continue;
+                uint32_t len = size - i * disk->block_size;
+                memset(buffer + i * disk->block_size, 0, len < disk->block_size ? len : disk->block_size);
+            }
+            created = file_create_data(disk, a, name, buffer, size);
+            break;
+        }
+        case TRACE_COPY: {
+            // A cópia relê a origem e grava com buracos (como copy_file)
+            int len = file_read_data(disk, b, buffer);
+            if (len < 0) return -1;
+            created = file_create_data(disk, a, name, buffer, (uint32_t)len);
+            break;
+        }
+        case TRACE_READ:
+            return file_read_data(disk, b, buffer) < 0 ? -1 : 0;
+        case TRACE_LIST: {
+            DirIter it;
+            if (dir_iter_open(disk, a, 0, &it) != 0) return -1;
+            while (dir_iter_next(&it, NULL)) {}
+            dir_iter_close(&it);
+            return 0;
+        }
+        case TRACE_DELETE:
+            return file_delete(disk, a, b);
+        case TRACE_RMDIR: {
+            if (dir_remove_entry(disk, a, b) != 0) return -1;
+            Inode *dir = inode_load(disk, b);
+            if (!dir) return -1;
+            for (int i = 0; i < MAX_BLOCKS_PER_INODE; i++) {
+                if (dir->blocks[i] != 0 && dir->blocks[i] != (uint32_t)-1) bitmap_set(disk, dir->blocks[i], 0);
+            }
+            inode_put(dir);
+            inode_free(disk, b);
+            return 0;
+        }
+        case TRACE_RENAME:
+            return dir_rename_entry(disk, a, b, name);
+        case TRACE_MOVE: {
+            char entry_name[MAX_NAME_LEN] = {0};
+            if (dir_find_entry(disk, a, b, entry_name) != 0) return -1;
+            if (dir_remove_entry(disk, a, b) != 0) return -1;
+            return dir_add_entry(disk, c, b, entry_name);
+        }
+        case TRACE_LINK:
+            return file_link(disk, a, b, name);
+        case TRACE_WRITE: {
+            // Conteúdo sintético do mesmo tamanho, no mesmo offset
+            uint32_t max = MAX_BLOCKS_PER_INODE * disk->block_size;
+            if (r->c > max || r->result > max - r->c) return -1;
+            memset(buffer, 'x', r->result);
+            return file_write_data(disk, a, b, r->c, buffer, r->result);
+        }
+        case TRACE_TRUNCATE:
+            return file_truncate(disk, a, b, r->c);
+        default:
+            return -1;
+    }
+    if (created == (uint32_t)-1) return -1;
+    if (r->result != (uint32_t)-1) map_set(map, r->result, created);
+    return 0;
+}
+
+int trace_replay(Disk *disk, const char *path, uint32_t root_inode, int paced, TraceReport *report) {
+    memset(report, 0, sizeof(TraceReport));
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        printf("[ERRO] Não foi possível abrir o trace %s\n", path);
+        return -1;
+    }
+    TraceHeader h;
+    if (fread(&h, sizeof(h), 1, f) != 1 || h.magic != TRACE_MAGIC || h.version != TRACE_VERSION) {
+        printf("[ERRO] %s não é um trace válido\n", path);
+        fclose(f);
+        return -1;
+    }
+    if (h.block_size != disk->block_size) {
+        printf("[AVISO] Trace gravado com blocos de %u bytes (disco atual: %u)\n", h.block_size, disk->block_size);
+    }
+
+    TraceMap map = {NULL, 0};
+    map_set(&map, 0, root_inode);
+    uint8_t *buffer = disk_buf_get(disk);
+
+    // As mensagens de cada operação são descartadas durante a reprodução:
+    // as falhas aparecem nos contadores do relatório
+    fflush(stdout);
+    int saved_stdout = dup(STDOUT_FILENO);
+    int devnull = open("/dev/null", O_WRONLY);
+    if (saved_stdout >= 0 && devnull >= 0) dup2(devnull, STDOUT_FILENO);
+
+    TraceRecord r;
+    char name[MAX_NAME_LEN];
+    int result = 0;
+    uint64_t t0 = now_ns();
+    while (fread(&r, sizeof(r), 1, f) == 1) {
+        if (r.op >= TRACE_OP_COUNT || r.name_len >= MAX_NAME_LEN ||
+            (r.name_len && fread(name, 1, r.name_len, f) != r.name_len)) {
+            result = -1;
+            break;
+        }
+        name[r.name_len] = '\0';
+
+        // Ritmo original: espera até o instante gravado
+        if (paced) {
+            uint64_t target = t0 + r.timestamp_ns;
+            uint64_t now = now_ns();
+            if (target > now) {
+                struct timespec ts = {(time_t)((target - now) / 1000000000ULL), (long)((target - now) % 1000000000ULL)};
+                nanosleep(&ts, NULL);
+            }
+        }
+
+        uint64_t start = now_ns();
+        int ok = replay_one(disk, &r, name, &map, buffer) == 0;
+        report->replay_ns[r.op] += now_ns() - start;
+        report->recorded_ns[r.op] += r.latency_ns;
+        report->ops[r.op]++;
+        report->records++;
+        if (!ok) report->errors[r.op]++;
+        if (ok != r.ok) report->divergent++;
+        report->trace_ms = (r.timestamp_ns + r.latency_ns) / 1e6;
+    }
+    report->elapsed_ms = (now_ns() - t0) / 1e6;
+
+    fflush(stdout);
+    if (saved_stdout >= 0 && devnull >= 0) dup2(saved_stdout, STDOUT_FILENO);
+    if (saved_stdout >= 0) close(saved_stdout);
+    if (devnull >= 0) close(devnull);
+
+    if (result != 0) printf("[ERRO] Registro corrompido no trace %s (após %u registros)\n", path, report->records);
+    disk_buf_put(disk, buffer);
+    free(map.to);
+    fclose(f);
+    return result;
+}
+
+void trace_print_report(const TraceReport *report) {
+    printf("=== REPRODUÇÃO ===\n");
+    printf("Operação | Execuções | Falhas | Gravado(us) | Reproduzido(us)\n");
+    for (int op = 0; op < TRACE_OP_COUNT; op++) {
+        uint32_t n = report->ops[op];
+        if (n == 0) continue;
+        printf("%-8s | %9u | %6u | %11.2f | %15.2f\n", op_names[op], n, report->errors[op],
+               report->recorded_ns[op] / 1000.0 / n, report->replay_ns[op] / 1000.0 / n);
+    }
+    printf("Registros: %u (%u com resultado diferente do gravado)\n", report->records, report->divergent);
+    printf("Tempo: %.2f ms (gravação: %.2f ms)\n", report->elapsed_ms, report->trace_ms);
+}
@@ -0,0 +1,357 @@
+#include "walk.h"
+#include "superblock.h"
+#include "dir.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+
+// Nó da árvore montada em memória pela fase paralela
+typedef struct WalkNode {
+    uint32_t inode_num;
+    char name[MAX_NAME_LEN];
+    Inode inode;
+    int is_dir;
+    struct WalkNode *children; // Na ordem das entradas do diretório
+    uint32_t num_children;
+    uint64_t total_bytes;
+    uint64_t total_blocks;
+    uint32_t files;
+    uint32_t dirs;
+} WalkNode;
+
+// Fila de diretórios de uma thread: o dono usa o fim, os ladrões o começo
+typedef struct {
+    pthread_mutex_t lock;
+    WalkNode **items;
+    uint32_t head;
+    uint32_t tail;
+    uint32_t capacity;
+} WalkDeque;
+
+typedef struct {
+    Disk *disk;
+    WalkDeque *deques;
+    int num_threads;
+    uint32_t pending;        // Diretórios enfileirados ou em leitura (atômico)
+    uint8_t *visited;        // Diretórios já enfileirados (bitmap atômico)
+    uint32_t dirs;
+    uint32_t files;
+    uint32_t steals;
+} WalkPool;
+
+typedef struct {
+    WalkPool *pool;
+    int id;
+} WalkWorker;
+
+static double elapsed_ms(struct timespec *start) {
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    return (end.tv_sec - start->tv_sec) * 1000.0 + (end.tv_nsec - start->tv_nsec) / 1e6;
+}
+
+static uint32_t used_blocks(const Inode *inode) {
+    uint32_t n = 0;
+    for (uint32_t i = 0; i < MAX_BLOCKS_PER_INODE; i++) {
+        if (inode->blocks[i] != 0) n++;
+    }
+    return n;
+}
+
+static void deque_push(WalkDeque *d, WalkNode *node) {
+    pthread_mutex_lock(&d->lock);
+    if (d->tail == d->capacity) {
+        // Reaproveita o espaço já consumido no começo antes de crescer
+        uint32_t count = d->tail - d->head;
+        if (d->head > 0) memmove(d->items, d->items + d->head, count * sizeof(WalkNode *));
+        d->head = 0;
+        d->tail = count;
+        if (d->tail == d->capacity) {
+            d->capacity = d->capacity ? d->capacity * 2 : 64;
+            d->items = realloc(d->items, d->capacity * sizeof(WalkNode *));
+        }
+    }
+    d->items[d->tail++] = node;
+    pthread_mutex_unlock(&d->lock);
+}
+
+static WalkNode *deque_pop(WalkDeque *d) {
+    WalkNode *node = NULL;
+    pthread_mutex_lock(&d->lock);
+    if (d->tail > d->head) node = d->items[--d->tail];
+    pthread_mutex_unlock(&d->lock);
+    return node;
+}
+
+static WalkNode *deque_steal(WalkDeque *d) {
+    WalkNode *node = NULL;
+    pthread_mutex_lock(&d->lock);
+    if (d->tail > d->head) node = d->items[d->head++];
+    pthread_mutex_unlock(&d->lock);
+    return node;
+}
+
+// Marca o diretório como visitado; retorna 1 se já estava (ciclo ou ligação repetida)
+static int mark_visited(WalkPool *pool, uint32_t inode_num) {
+    uint8_t bit = 1 << (inode_num % 8);
+    return (__atomic_fetch_or(&pool->visited[inode_num / 8], bit, __ATOMIC_RELAXED) & bit) != 0;
+}
+
+// Lê as entradas do diretório e enfileira os subdiretórios na fila da thread
+static void walk_expand(WalkPool *pool, WalkDeque *own, WalkNode *node) {
+    DirIter it;
+    if (dir_iter_open(pool->disk, node->inode_num, DIR_ITER_PLUS, &it) != 0) return;
+
+    uint32_t capacity = 0;
+    DirEntry *entry;
+    Inode *child;
+    while ((entry = dir_iter_next(&it, &child))) {
+        if (strcmp(entry->name, ".") == 0 || strcmp(entry->name, "..") == 0) continue;
+        if (node->num_children == capacity) {
+            capacity = capacity ? capacity * 2 : 16;
+            node->children = realloc(node->children, capacity * sizeof(WalkNode));
+        }
+        WalkNode *c = &node->children[node->num_children++];
+        memset(c, 0, sizeof(WalkNode));
+        c->inode_num = entry->inode_num;
+        memcpy(c->name, entry->name, MAX_NAME_LEN);
+        c->inode = *child;
+        c->is_dir = (child->mode & 040000) == 040000;
+    }
+    dir_iter_close(&it);
+
+    // Só enfileira depois de montar o vetor: realloc moveria os filhos
+    uint32_t files = 0;
+    for (uint32_t i = 0; i < node->num_children; i++) {
+        WalkNode *c = &node->children[i];
+        if (!c->is_dir) {
+            files++;
+        } else if (c->inode_num < pool->disk->sb->inode_count && !mark_visited(pool, c->inode_num)) {
+            __atomic_fetch_add(&pool->pending, 1, __ATOMIC_SEQ_CST);
+            deque_push(own, c);
+        }
+    }
+    __atomic_fetch_add(&pool->files, files, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&pool->dirs, 1, __ATOMIC_RELAXED);
+}
+
+static void *walk_worker(void *arg) {
+    WalkWorker *w = arg;
+    WalkPool *pool = w->pool;
+    WalkDeque *own = &pool->deques[w->id];
+    struct timespec idle = {0, 50000};
+
+    for (;;) {
+        WalkNode *node = deque_pop(own);
+        for (int i = 1; !node && i < pool->num_threads; i++) {
+            node = deque_steal(&pool->deques[(w->id + i) % pool->num_threads]);
+            if (node) __atomic_fetch_add(&pool->steals, 1, __ATOMIC_RELAXED);
+        }
+        if (!node) {
+            if (__atomic_load_n(&pool->pending, __ATOMIC_SEQ_CST) == 0) break;
+            nanosleep(&idle, NULL);
+            continue;
+        }
+        walk_expand(pool, own, node);
+        __atomic_fetch_sub(&pool->pending, 1, __ATOMIC_SEQ_CST);
+    }
+    return NULL;
+}
+
+// Quadro da pilha das fases em profundidade (sem recursão: não há limite de altura)
+typedef struct {
+    WalkNode *node;
+    uint32_t next;     // Próximo filho a visitar
+    size_t path_len;   // Tamanho do caminho até este nó
+} WalkFrame;
+
+static void frame_push(WalkFrame **stack, uint32_t *count, uint32_t *capacity, WalkNode *node, size_t path_len) {
+    if (*count == *capacity) {
+        *capacity = *capacity ? *capacity * 2 : 64;
+        *stack = realloc(*stack, *capacity * sizeof(WalkFrame));
+    }
+    (*stack)[*count].node = node;
+    (*stack)[*count].next = 0;
+    (*stack)[*count].path_len = path_len;
+    (*count)++;
+}
+
+// Soma os totais de cada subárvore (pós-ordem)
+static void walk_totals(WalkNode *root) {
+    WalkFrame *stack = NULL;
+    uint32_t count = 0, capacity = 0;
+    frame_push(&stack, &count, &capacity, root, 0);
+
+    while (count > 0) {
+        WalkFrame *f = &stack[count - 1];
+        WalkNode *node = f->node;
+        if (f->next == 0) {
+            node->total_bytes = node->inode.size;
+            node->total_blocks = used_blocks(&node->inode);
+            node->files = node->is_dir ? 0 : 1;
+            node->dirs = 0;
+        }
+        if (f->next < node->num_children) {
+            frame_push(&stack, &count, &capacity, &node->children[f->next++], 0);
+            continue;
+        }
+        count--;
+        if (count > 0) {
+            WalkNode *parent = stack[count - 1].node;
+            parent->total_bytes += node->total_bytes;
+            parent->total_blocks += node->total_blocks;
+            parent->files += node->files;
+            parent->dirs += node->dirs + (node->is_dir ? 1 : 0);
+        }
+    }
+    free(stack);
+}
+
+static void fill_entry(WalkEntry *e, WalkNode *node, const char *path, uint32_t depth) {
+    e->inode_num = node->inode_num;
+    e->name = node->name;
+    e->path = path;
+    e->inode = &node->inode;
+    e->depth = depth;
+    e->is_dir = node->is_dir;
+    e->total_bytes = node->total_bytes;
+    e->total_blocks = node->total_blocks;
+    e->files = node->files;
+    e->dirs = node->dirs;
+}
+
+// Chama pre/post em profundidade, na ordem das entradas. Os filhos de cada nó
+// são liberados assim que ele termina
+static void walk_visit(WalkNode *root, WalkFn pre, WalkFn post, void *arg) {
+    WalkFrame *stack = NULL;
+    uint32_t count = 0, capacity = 0;
+    size_t path_cap = 256;
+    char *path = malloc(path_cap);
+    strcpy(path, "/");
+    frame_push(&stack, &count, &capacity, root, 0); // Na raiz o prefixo dos filhos é vazio
+
+    WalkEntry e;
+    while (count > 0) {
+        WalkFrame *f = &stack[count - 1];
+        WalkNode *node = f->node;
+        uint32_t depth = count - 1;
+
+        if (f->next == 0) {
+            if (depth > 0) {
+                size_t parent_len = stack[count - 2].path_len;
+                size_t name_len = strlen(node->name);
+                if (parent_len + name_len + 2 > path_cap) {
+                    while (parent_len + name_len + 2 > path_cap) path_cap *= 2;
+                    path = realloc(path, path_cap);
+                }
+                path[parent_len] = '/';
+                memcpy(path + parent_len + 1, node->name, name_len + 1);
+                f->path_len = parent_len + 1 + name_len;
+            }
+            if (pre) {
+                fill_entry(&e, node, path, depth);
+                pre(&e, arg);
+            }
+        }
+        if (f->next < node->num_children) {
+            frame_push(&stack, &count, &capacity, &node->children[f->next++], 0);
+            continue;
+        }
+
+        if (post) {
+            fill_entry(&e, node, path, depth);
+            post(&e, arg);
+        }
+        free(node->children);
+        node->children = NULL;
+        count--;
+        if (count > 0) {
+            // Volta ao caminho do pai ("/" na raiz)
+            size_t parent_len = stack[count - 1].path_len;
+            path[parent_len ? parent_len : 1] = '\0';
+        }
+    }
+    free(path);
+    free(stack);
+}
+
+int walk_tree(Disk *disk, uint32_t root_inode_num, int num_threads,
+              WalkFn pre, WalkFn post, void *arg, WalkReport *report) {
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    memset(report, 0, sizeof(WalkReport));
+
+    uint32_t inode_count = disk->sb->inode_count;
+    if (root_inode_num >= inode_count) {
+        printf("[ERRO] Inode %u inválido\n", root_inode_num);
+        return -1;
+    }
+    Inode *root_inode = inode_load(disk, root_inode_num);
+    if (!root_inode) return -1;
+    if ((root_inode->mode & 040000) != 040000) {
+        printf("[ERRO] Inode %u não é um diretório\n", root_inode_num);
+        inode_put(root_inode);
+        return -1;
+    }
+
+    WalkNode root;
+    memset(&root, 0, sizeof(WalkNode));
+    root.inode_num = root_inode_num;
+    strcpy(root.name, "/");
+    root.inode = *root_inode;
+    root.is_dir = 1;
+    inode_put(root_inode);
+
+    if (num_threads <= 0) num_threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (num_threads < 1) num_threads = 1;
+    if (num_threads > WALK_MAX_THREADS) num_threads = WALK_MAX_THREADS;
+
+    // 1. Leitura paralela dos diretórios: a raiz começa na fila da thread 0
+    WalkPool pool;
+    memset(&pool, 0, sizeof(WalkPool));
+    pool.disk = disk;
+    pool.num_threads = num_threads;
+    pool.deques = calloc(num_threads, sizeof(WalkDeque));
+    pool.visited = calloc((inode_count + 7) / 8, 1);
+    for (int t = 0; t < num_threads; t++) pthread_mutex_init(&pool.deques[t].lock, NULL);
+    mark_visited(&pool, root_inode_num);
+    pool.pending = 1;
+    deque_push(&pool.deques[0], &root);
+
+    pthread_t threads[WALK_MAX_THREADS];
+    WalkWorker workers[WALK_MAX_THREADS];
+    int started = 0;
+    for (int t = 0; t < num_threads; t++) {
+        workers[t].pool = &pool;
+        workers[t].id = t;
+        if (pthread_create(&threads[started], NULL, walk_worker, &workers[t]) == 0) started++;
+    }
+    if (started == 0) walk_worker(&workers[0]); // Sem threads: lê tudo aqui
+    for (int t = 0; t < started; t++) pthread_join(threads[t], NULL);
+
+    for (int t = 0; t < num_threads; t++) {
+        pthread_mutex_destroy(&pool.deques[t].lock);
+        free(pool.deques[t].items);
+    }
+    free(pool.deques);
+    free(pool.visited);
+
+    // 2. Totais e visita, na ordem das entradas (independe das threads)
+    walk_totals(&root);
+    walk_visit(&root, pre, post, arg);
+
+    report->dirs = pool.dirs;
+    report->files = pool.files;
+    report->steals = pool.steals;
+    report->threads = started ? started : 1;
+    report->elapsed_ms = elapsed_ms(&start);
+    return 0;
+}
+
+void walk_print_report(const WalkReport *report) {
+    printf("%u diretórios, %u arquivos (%.2f ms, %d threads, %u roubos)\n",
+           report->dirs, report->files, report->elapsed_ms, report->threads, report->steals);
+}
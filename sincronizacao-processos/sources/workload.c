@@ -0,0 +1,368 @@
+#include "workload.h"
+#include "inode.h"
+#include "dir.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+
+static const char *type_names[WORKLOAD_COUNT] = {"fileserver", "mailserver", "largeseq", "metastorm"};
+static const char *size_dist_names[WORKLOAD_SIZE_COUNT] = {"fixed", "uniform", "exp"};
+static const char *op_names[WORKLOAD_OP_COUNT] = {"create", "read", "delete", "stat",
+                                                  "rename", "lookup", "list", "mkdir"};
+
+// Arquivo vivo da carga; o nome é derivado de id ("f%06u" ou "r%06u" depois de renomeado)
+typedef struct {
+    uint32_t dir;
+    uint32_t inode_num;
+    uint32_t id;
+    int renamed;
+} WorkloadFile;
+
+typedef struct {
+    Disk *disk;
+    const WorkloadConfig *cfg;
+    WorkloadReport *report;
+    unsigned int seed;
+    uint32_t *dirs;          // Folhas da árvore (recebem arquivos)
+    uint32_t num_dirs;
+    uint32_t dirs_capacity;
+    WorkloadFile *files;
+    uint32_t num_files;
+    uint32_t files_capacity;
+    uint32_t next_id;
+    uint8_t *buffer;         // Conteúdo gravado e área de leitura
+} WorkloadState;
+
+static double elapsed_ms(struct timespec *start) {
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    return (end.tv_sec - start->tv_sec) * 1000.0 + (end.tv_nsec - start->tv_nsec) / 1e6;
+}
+
+const char *workload_type_name(WorkloadType type) {
+    return (type < WORKLOAD_COUNT) ? type_names[type] : "?";
+}
+
+int workload_type_from_name(const char *name) {
+    for (int t = 0; t < WORKLOAD_COUNT; t++) {
+        if (strcmp(name, type_names[t]) == 0) return t;
+    }
+    return -1;
+}
+
+void workload_defaults(WorkloadType type, WorkloadConfig *cfg) {
+    memset(cfg, 0, sizeof(WorkloadConfig));
+    cfg->type = type;
+    cfg->ops = 10000;
+    cfg->seed = 1;
+    switch (type) {
+        case WORKLOAD_FILESERVER:
+            cfg->fanout = 8;
+            cfg->depth = 2;
+            cfg->files = 500;
+            cfg->size_dist = WORKLOAD_SIZE_EXP;
+            cfg->size_mean = 16384;
+            cfg->mix[WORKLOAD_OP_CREATE] = 20;
+            cfg->mix[WORKLOAD_OP_READ] = 30;
+            cfg->mix[WORKLOAD_OP_DELETE] = 20;
+            cfg->mix[WORKLOAD_OP_STAT] = 20;
+            cfg->mix[WORKLOAD_OP_RENAME] = 10;
+            break;
+        case WORKLOAD_MAILSERVER:
+            cfg->fanout = 16;
+            cfg->depth = 1;
+            cfg->files = 1000;
+            cfg->size_dist = WORKLOAD_SIZE_EXP;
+            cfg->size_mean = 2048;
+            cfg->mix[WORKLOAD_OP_CREATE] = 30;
+            cfg->mix[WORKLOAD_OP_READ] = 40;
+            cfg->mix[WORKLOAD_OP_DELETE] = 30;
+            break;
+        case WORKLOAD_LARGESEQ:
+            cfg->fanout = 1;
+            cfg->depth = 1;
+            cfg->files = 20;
+            cfg->size_dist = WORKLOAD_SIZE_FIXED;
+            cfg->size_mean = 10 * 8192; // Limitado ao máximo do bloco em uso
+            cfg->mix[WORKLOAD_OP_READ] = 70;
+            cfg->mix[WORKLOAD_OP_CREATE] = 15;
+            cfg->mix[WORKLOAD_OP_DELETE] = 15;
+            break;
+        default:
+            cfg->type = WORKLOAD_METASTORM;
+            cfg->fanout = 8;
+            cfg->depth = 2;
+            cfg->files = 200;
+            cfg->size_dist = WORKLOAD_SIZE_FIXED;
+            cfg->size_mean = 0;
+            cfg->mix[WORKLOAD_OP_CREATE] = 25;
+            cfg->mix[WORKLOAD_OP_DELETE] = 20;
+            cfg->mix[WORKLOAD_OP_RENAME] = 15;
+            cfg->mix[WORKLOAD_OP_LOOKUP] = 20;
+            cfg->mix[WORKLOAD_OP_LIST] = 10;
+            cfg->mix[WORKLOAD_OP_MKDIR] = 5;
+            cfg->mix[WORKLOAD_OP_STAT] = 5;
+            break;
+    }
+}
+
+int workload_set(WorkloadConfig *cfg, const char *param, const char *value) {
+    if (strcmp(param, "size_dist") == 0) {
+        for (int d = 0; d < WORKLOAD_SIZE_COUNT; d++) {
+            if (strcmp(value, size_dist_names[d]) == 0) {
+                cfg->size_dist = d;
+                return 0;
+            }
+        }
+        return -1;
+    }
+
+    char *end;
+    unsigned long v = strtoul(value, &end, 10);
+    if (*value == '\0' || *end != '\0') return -1;
+    if (strcmp(param, "ops") == 0) cfg->ops = (uint32_t)v;
+    else if (strcmp(param, "seed") == 0) cfg->seed = (uint32_t)v;
+    else if (strcmp(param, "fanout") == 0 && v > 0) cfg->fanout = (uint32_t)v;
+    else if (strcmp(param, "depth") == 0) cfg->depth = (uint32_t)v;
+    else if (strcmp(param, "files") == 0) cfg->files = (uint32_t)v;
+    else if (strcmp(param, "size_mean") == 0) cfg->size_mean = (uint32_t)v;
+    else {
+        for (int op = 0; op < WORKLOAD_OP_COUNT; op++) {
+            if (strcmp(param, op_names[op]) == 0) {
+                cfg->mix[op] = (uint32_t)v;
+                return 0;
+            }
+        }
+        return -1;
+    }
+    return 0;
+}
+
+/* ====================== */
+/* Execução               */
+/* ====================== */
+
+// Tamanho sorteado pela distribuição, limitado a 10 blocos
+static uint32_t pick_size(WorkloadState *st) {
+    const WorkloadConfig *cfg = st->cfg;
+    uint32_t max = MAX_BLOCKS_PER_INODE * st->disk->block_size;
+    double size;
+    switch (cfg->size_dist) {
+        case WORKLOAD_SIZE_UNIFORM:
+            size = (double)rand_r(&st->seed) / RAND_MAX * 2.0 * cfg->size_mean;
+            break;
+        case WORKLOAD_SIZE_EXP:
+            size = -log(((double)rand_r(&st->seed) + 1.0) / ((double)RAND_MAX + 1.0)) * cfg->size_mean;
+            break;
+        default:
+            size = cfg->size_mean;
+            break;
+    }
+    return size > max ? max : (uint32_t)size;
+}
+
+static void file_name(const WorkloadFile *f, char name[MAX_NAME_LEN]) {
+    snprintf(name, MAX_NAME_LEN, "%c%06u", f->renamed ? 'r' : 'f', f->id);
+}
+
+static void add_dir(WorkloadState *st, uint32_t dir) {
+    if (st->num_dirs == st->dirs_capacity) {
+        st->dirs_capacity = st->dirs_capacity ? st->dirs_capacity * 2 : 64;
+        st->dirs = realloc(st->dirs, st->dirs_capacity * sizeof(uint32_t));
+    }
+    st->dirs[st->num_dirs++] = dir;
+}
+
+// Cria fanout subdiretórios por nível; só as folhas ficam em st->dirs
+static int build_tree(WorkloadState *st, uint32_t base) {
+    add_dir(st, base);
+    char name[MAX_NAME_LEN];
+    for (uint32_t level = 0; level < st->cfg->depth; level++) {
+        uint32_t *parents = st->dirs;
+        uint32_t num_parents = st->num_dirs;
+        st->dirs = NULL;
+        st->num_dirs = st->dirs_capacity = 0;
+        for (uint32_t p = 0; p < num_parents; p++) {
+            for (uint32_t i = 0; i < st->cfg->fanout; i++) {
+                snprintf(name, sizeof(name), "w%u_%02u", level, i);
+                if (dir_create(st->disk, parents[p], name) != 0) {
+                    free(parents);
+                    return -1;
+                }
+                add_dir(st, dir_lookup(st->disk, parents[p], name));
+                st->report->dirs++;
+            }
+        }
+        free(parents);
+    }
+    return 0;
+}
+
+static int op_create(WorkloadState *st) {
+    if (st->num_files == st->files_capacity) {
+        st->files_capacity = st->files_capacity ? st->files_capacity * 2 : 256;
+        st->files = realloc(st->files, st->files_capacity * sizeof(WorkloadFile));
+    }
+    WorkloadFile *f = &st->files[st->num_files];
+    f->dir = st->dirs[rand_r(&st->seed) % st->num_dirs];
+    f->id = st->next_id++;
+    f->renamed = 0;
+
+    // Conteúdo diferente por arquivo e sem zeros (não vira buraco)
+    uint32_t size = pick_size(st);
+    memset(st->buffer, 'a' + f->id % 26, size);
+    char name[MAX_NAME_LEN];
+    file_name(f, name);
+    f->inode_num = file_create_data(st->disk, f->dir, name, st->buffer, size);
+    if (f->inode_num == (uint32_t)-1) return -1;
+    st->num_files++;
+    st->report->bytes_written += size;
+    return 0;
+}
+
+static int run_op(WorkloadState *st, WorkloadOp op) {
+    Disk *disk = st->disk;
+    char name[MAX_NAME_LEN];
+    if (op == WORKLOAD_OP_CREATE) return op_create(st);
+    if (op == WORKLOAD_OP_MKDIR) {
+        uint32_t parent = st->dirs[rand_r(&st->seed) % st->num_dirs];
+        snprintf(name, sizeof(name), "m%06u", st->next_id++);
+        if (dir_create(disk, parent, name) != 0) return -1;
+        add_dir(st, dir_lookup(disk, parent, name));
+        return 0;
+    }
+    if (op == WORKLOAD_OP_LIST) {
+        DirIter it;
+        if (dir_iter_open(disk, st->dirs[rand_r(&st->seed) % st->num_dirs], 0, &it) != 0) return -1;
+        while (dir_iter_next(&it, NULL)) {}
+        dir_iter_close(&it);
+        return 0;
+    }
+
+    // As demais operações agem sobre um arquivo vivo
+    uint32_t index = rand_r(&st->seed) % st->num_files;
+    WorkloadFile *f = &st->files[index];
+    switch (op) {
+        case WORKLOAD_OP_READ: {
+            int n = file_read_data(disk, f->inode_num, st->buffer);
+            if (n < 0) return -1;
+            st->report->bytes_read += n;
+            return 0;
+        }
+        case WORKLOAD_OP_DELETE:
+            if (file_delete(disk, f->dir, f->inode_num) != 0) return -1;
+            st->files[index] = st->files[--st->num_files];
+            return 0;
+        case WORKLOAD_OP_STAT: {
+            Inode *inode = inode_load(disk, f->inode_num);
+            if (!inode) return -1;
+            inode_put(inode);
+            return 0;
+        }
+        case WORKLOAD_OP_RENAME:
+            f->renamed = !f->renamed;
+            file_name(f, name);
+            return dir_rename_entry(disk, f->dir, f->inode_num, name);
+        default: // WORKLOAD_OP_LOOKUP
+            file_name(f, name);
+            return dir_lookup(disk, f->dir, name) == f->inode_num ? 0 : -1;
+    }
+}
+
+int workload_run(Disk *disk, uint32_t dir_inode_num, const WorkloadConfig *cfg, WorkloadReport *report) {
+    memset(report, 0, sizeof(WorkloadReport));
+    uint32_t total_weight = 0;
+    for (int op = 0; op < WORKLOAD_OP_COUNT; op++) total_weight += cfg->mix[op];
+    if (total_weight == 0) {
+        printf("[ERRO] Nenhuma operação com peso maior que zero\n");
+        return -1;
+    }
+    Inode *base = inode_load(disk, dir_inode_num);
+    int is_dir = base && (base->mode & 040000) == 040000;
+    if (base) inode_put(base);
+    if (!is_dir) {
+        printf("[ERRO] Inode %u não é um diretório\n", dir_inode_num);
+        return -1;
+    }
+
+    WorkloadState st;
+    memset(&st, 0, sizeof(st));
+    st.disk = disk;
+    st.cfg = cfg;
+    st.report = report;
+    st.seed = cfg->seed;
+    st.buffer = disk_buf_get(disk);
+
+    // As mensagens de cada operação são descartadas durante a carga:
+    // as falhas aparecem nos contadores do relatório
+    fflush(stdout);
+    int saved_stdout = dup(STDOUT_FILENO);
+    int devnull = open("/dev/null", O_WRONLY);
+    if (saved_stdout >= 0 && devnull >= 0) dup2(devnull, STDOUT_FILENO);
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    int result = build_tree(&st, dir_inode_num);
+    for (uint32_t i = 0; result == 0 && i < cfg->files; i++) {
+        if (op_create(&st) != 0) report->errors[WORKLOAD_OP_CREATE]++;
+    }
+    report->setup_ms = elapsed_ms(&start);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (uint32_t i = 0; result == 0 && i < cfg->ops; i++) {
+        uint32_t r = rand_r(&st.seed) % total_weight;
+        WorkloadOp op = 0;
+        while (r >= cfg->mix[op]) r -= cfg->mix[op++];
+        // Sem arquivos vivos, operações sobre arquivos viram criações
+        if (st.num_files == 0 && op != WORKLOAD_OP_MKDIR && op != WORKLOAD_OP_LIST) op = WORKLOAD_OP_CREATE;
+
+        report->ops[op]++;
+        if (run_op(&st, op) != 0) report->errors[op]++;
+    }
+    report->elapsed_ms = elapsed_ms(&start);
+    report->files = st.num_files;
+
+    fflush(stdout);
+    if (saved_stdout >= 0 && devnull >= 0) dup2(saved_stdout, STDOUT_FILENO);
+    if (saved_stdout >= 0) close(saved_stdout);
+    if (devnull >= 0) close(devnull);
+
+    if (result != 0) printf("[ERRO] Falha ao criar a árvore de diretórios da carga\n");
+    disk_buf_put(disk, st.buffer);
+    free(st.files);
+    free(st.dirs);
+    return result;
+}
+
+void workload_print_config(const WorkloadConfig *cfg) {
+    printf("Personalidade: %s (%u operações, semente %u)\n", workload_type_name(cfg->type), cfg->ops, cfg->seed);
+    printf("Árvore: fanout %u, profundidade %u; %u arquivos iniciais\n", cfg->fanout, cfg->depth, cfg->files);
+    printf("Tamanhos: %s, média %u bytes\n", size_dist_names[cfg->size_dist], cfg->size_mean);
+    printf("Pesos:");
+    for (int op = 0; op < WORKLOAD_OP_COUNT; op++) {
+        if (cfg->mix[op]) printf(" %s=%u", op_names[op], cfg->mix[op]);
+    }
+    printf("\n");
+}
+
+void workload_print_report(const WorkloadReport *report) {
+    uint32_t total = 0, errors = 0;
+    printf("=== CARGA ===\n");
+    printf("Preparação: %u diretórios (%.2f ms)\n", report->dirs, report->setup_ms);
+    printf("Operação | Execuções | Falhas\n");
+    for (int op = 0; op < WORKLOAD_OP_COUNT; op++) {
+        total += report->ops[op];
+        errors += report->errors[op];
+        if (report->ops[op] == 0 && report->errors[op] == 0) continue;
+        printf("%-8s | %9u | %6u\n", op_names[op], report->ops[op], report->errors[op]);
+    }
+    printf("Dados gravados: %.2f MB, lidos: %.2f MB\n",
+           report->bytes_written / (1024.0 * 1024.0), report->bytes_read / (1024.0 * 1024.0));
+    printf("Arquivos no fim: %u\n", report->files);
+    printf("Tempo: %.2f ms (%.0f ops/s, %u falhas)\n", report->elapsed_ms,
+           report->elapsed_ms > 0 ? total / (report->elapsed_ms / 1000.0) : 0.0, errors);
+}
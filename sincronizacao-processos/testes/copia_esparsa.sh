@@ -0,0 +1,40 @@
+#!/bin/sh
+# copy_file de um arquivo esparso: os buracos continuam buracos na cópia, o
+# conteúdo é o mesmo e o fsck fica limpo (i-node e blocos sem vazamento).
+# Rodar da raiz do projeto, depois do make: sh testes/copia_esparsa.sh
+FS=./fs_simulator
+TMP=$(mktemp -d)
+IMG=$TMP/copia.bin
+trap 'rm -rf "$TMP"' EXIT
+
+falha() {
+    echo "[ERRO] $*"
+    exit 1
+}
+
+# Arquivo esparso de entrada: 512 bytes de dados, dois blocos de zeros e 100 bytes de dados
+{
+    head -c 512 /dev/zero | tr '\0' A
+    head -c 1024 /dev/zero
+    head -c 100 /dev/zero | tr '\0' B
+} >"$TMP/esparso.bin"
+
+$FS mkfs -i "$IMG" -b 512 -s 4 >/dev/null || falha "mkfs"
+
+# I-nodes: 1 = origem, 2 = destino, 3 = esparso.bin, 4 = a cópia
+$FS mount -q -i "$IMG" >"$TMP/copia.log" <<EOF || falha "mount"
+create_dir 0 origem
+create_dir 0 destino
+create_file 1 $TMP/esparso.bin esparso.bin
+copy_file 1 3 2 copia.bin
+copy_file 0 1 2 diretorio
+file_size 4
+export_tree 0 $TMP/export
+EOF
+grep -q "copiado com sucesso como 'copia.bin'" "$TMP/copia.log" || falha "copy_file do arquivo esparso falhou"
+grep -q "Buracos: 2" "$TMP/copia.log" || falha "os buracos não foram mantidos na cópia"
+grep -q "Só arquivos regulares" "$TMP/copia.log" || falha "copy_file aceitou um diretório"
+cmp -s "$TMP/esparso.bin" "$TMP/export/destino/copia.bin" || falha "a cópia difere do original"
+$FS fsck -i "$IMG" >"$TMP/fsck.log" || falha "fsck depois da cópia" "$(cat "$TMP/fsck.log")"
+
+echo "[INFO] copia_esparsa: ok"
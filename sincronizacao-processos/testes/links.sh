@@ -0,0 +1,79 @@
+#!/bin/sh
+# Hard links: o arquivo continua no disco enquanto tiver um nome, o uso do
+# diretório passa para outro que tenha link quando o dono perde o seu, e o
+# fsck fica limpo em cada passo.
+# Rodar da raiz do projeto, depois do make: sh testes/links.sh
+FS=./fs_simulator
+TMP=$(mktemp -d)
+IMG=$TMP/links.bin
+trap 'rm -rf "$TMP"' EXIT
+
+falha() {
+    echo "[ERRO] $*"
+    exit 1
+}
+
+# Arquivo esparso de entrada: 512 bytes de dados, dois blocos de zeros e 100 bytes de dados
+{
+    head -c 512 /dev/zero | tr '\0' A
+    head -c 1024 /dev/zero
+    head -c 100 /dev/zero | tr '\0' B
+} >"$TMP/esparso.bin"
+
+# Roda os comandos do stdin na imagem (saída em $TMP/$1.log) e confere o fsck
+passo() {
+    $FS mount -q -i "$IMG" >"$TMP/$1.log" || falha "mount ($1)"
+    grep "\[ERRO\]" "$TMP/$1.log" && falha "comando falhou ($1)"
+    $FS fsck -i "$IMG" >"$TMP/$1.fsck" || falha "fsck depois de $1" "$(cat "$TMP/$1.fsck")"
+}
+
+# Linha do du -s do diretório: "bytes blocos arquivos"
+uso() {
+    grep -a "(inode $2)" "$TMP/$1.log" | awk '{print $1, $3, $5}'
+}
+
+$FS mkfs -i "$IMG" -b 512 -s 4 >/dev/null || falha "mkfs"
+
+# I-nodes: 1 = a, 2 = b, 3 = f.bin (1636 bytes com buracos, 2 blocos de dados)
+passo base <<EOF
+create_dir 0 a
+create_dir 0 b
+disk_usage
+EOF
+passo link <<EOF
+create_file 1 $TMP/esparso.bin f.bin
+link 2 3 g.bin
+file_size 3
+du -s 1
+du -s 2
+EOF
+grep -q "Links: 2" "$TMP/link.log" || falha "link não contou 2 links"
+[ "$(uso link 1)" = "1732 3 1" ] || falha "uso de /a após o link: $(uso link 1)"
+[ "$(uso link 2)" = "96 1 0" ] || falha "o arquivo foi contado também em /b: $(uso link 2)"
+
+# Apaga o nome do diretório dono: os dados ficam e o uso passa para /b
+passo delete1 <<EOF
+delete_file 1 3
+file_size 3
+read_file 3
+du -s 1
+du -s 2
+EOF
+grep -q "Links: 1" "$TMP/delete1.log" || falha "delete_file não decrementou os links"
+grep -q "BBBB" "$TMP/delete1.log" || falha "os dados sumiram com um link restante"
+[ "$(uso delete1 1)" = "96 1 0" ] || falha "uso de /a após apagar: $(uso delete1 1)"
+[ "$(uso delete1 2)" = "1732 3 1" ] || falha "uso não passou para /b: $(uso delete1 2)"
+
+# Apaga o último nome: i-node e blocos voltam a ficar livres
+passo delete2 <<EOF
+delete_file 2 3
+du -s 2
+disk_usage
+EOF
+[ "$(uso delete2 2)" = "96 1 0" ] || falha "uso de /b após apagar: $(uso delete2 2)"
+for campo in "Blocos usados" "I-nodes livres"; do
+    [ "$(grep -a "$campo" "$TMP/base.log")" = "$(grep -a "$campo" "$TMP/delete2.log")" ] ||
+        falha "$campo não voltou ao valor de antes do arquivo"
+done
+
+echo "[INFO] links: ok"
@@ -0,0 +1,64 @@
+#!/bin/sh
+# Snapshots: tira um snapshot, altera a imagem (sobrescreve, corta, apaga),
+# confere que o snapshot aberto com "mount -n" exporta o conteúdo de antes e
+# que o fsck fica limpo antes e depois do snapshot_delete.
+# Rodar da raiz do projeto, depois do make: sh testes/snapshot.sh
+FS=./fs_simulator
+TMP=$(mktemp -d)
+IMG=$TMP/snapshot.bin
+trap 'rm -rf "$TMP"' EXIT
+
+falha() {
+    echo "[ERRO] $*"
+    exit 1
+}
+
+# Arquivo esparso de entrada: 512 bytes de dados, dois blocos de zeros e 100 bytes de dados
+{
+    head -c 512 /dev/zero | tr '\0' A
+    head -c 1024 /dev/zero
+    head -c 100 /dev/zero | tr '\0' B
+} >"$TMP/esparso.bin"
+
+$FS mkfs -i "$IMG" -b 512 -s 4 >/dev/null || falha "mkfs"
+
+# I-nodes: 1 = docs, 2 = teste1.txt, 3 = esparso.bin, 4 = comandos.txt
+$FS mount -q -i "$IMG" >"$TMP/antes.log" <<EOF || falha "mount (antes do snapshot)"
+create_dir 0 docs
+create_file 1 testes/teste1.txt teste1.txt
+create_file 1 $TMP/esparso.bin esparso.bin
+create_file 0 testes/comandos.txt comandos.txt
+export_tree 0 $TMP/antes
+snapshot
+write_file 1 2 0 SOBRESCRITO
+write_file 1 3 600 buraco_preenchido
+truncate_file 1 3 100
+truncate_file 0 4 1000
+delete_file 1 2
+create_file 1 testes/teste1.txt novo.txt
+snapshot_list
+EOF
+grep -q "Snapshot 1 criado" "$TMP/antes.log" || falha "snapshot não foi criado"
+grep "\[ERRO\]" "$TMP/antes.log" && falha "comando falhou na imagem viva"
+$FS fsck -i "$IMG" >"$TMP/fsck1.log" || falha "fsck com o snapshot ativo (veja abaixo)" "$(cat "$TMP/fsck1.log")"
+
+# A imagem viva mudou; o snapshot 1 continua igual ao que foi exportado antes
+$FS mount -q -i "$IMG" >/dev/null <<EOF
+export_tree 0 $TMP/depois
+EOF
+diff -r "$TMP/antes" "$TMP/depois" >/dev/null && falha "a imagem viva não mudou"
+$FS mount -q -n 1 -i "$IMG" >"$TMP/snap.log" <<EOF || falha "mount -n 1"
+export_tree 0 $TMP/snapshot
+delete_file 1 3
+EOF
+diff -r "$TMP/antes" "$TMP/snapshot" || falha "o snapshot difere do conteúdo de antes"
+grep -q "delete_file altera a imagem" "$TMP/snap.log" || falha "mount -n aceitou um comando que altera a imagem"
+
+$FS mount -q -i "$IMG" >"$TMP/delete.log" <<EOF || falha "mount (snapshot_delete)"
+snapshot_delete 1
+snapshot_list
+EOF
+grep -q "Nenhum snapshot" "$TMP/delete.log" || falha "snapshot_delete não removeu o snapshot"
+$FS fsck -i "$IMG" >"$TMP/fsck2.log" || falha "fsck depois do snapshot_delete" "$(cat "$TMP/fsck2.log")"
+
+echo "[INFO] snapshot: ok"